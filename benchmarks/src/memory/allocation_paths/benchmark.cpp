@@ -0,0 +1,209 @@
+// benchmark.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <mjxsdk/memory/allocator.hpp>
+#include <mjxsdk/memory/exception.hpp>
+#include <mjxsdk/memory/object.hpp>
+#include <mjxsdk/memory/object_allocator.hpp>
+#include <mjxsdk/memory/small_object_allocator.hpp>
+#include <mjxsdk/memory/system_allocator.hpp>
+#include <new>
+#include <vector>
+#ifdef _MJX_WINDOWS
+#include <malloc.h>
+#endif // _MJX_WINDOWS
+
+// Note: Every benchmark is a template of the allocator it measures. Baselines are wrapped in final allocators,
+//       so they run through exactly the same code paths. To measure another allocator, add it to the
+//       _MJX_REGISTER_ALLOCATION_BENCHMARKS() list at the bottom of this file. It must be default-constructible.
+namespace mjx {
+    class _Malloc_allocator final : public allocator { // baseline, forwards to malloc() and free()
+    public:
+        pointer allocate(size_type _Size, size_type _Align = 0) override {
+            void* _Ptr;
+            if (_Align <= __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+                _Ptr = ::malloc(_Size);
+            } else {
+#ifdef _MJX_WINDOWS
+                _Ptr = ::_aligned_malloc(_Size, _Align);
+#else // ^^^ _MJX_WINDOWS ^^^ / vvv _MJX_LINUX vvv
+                if (::posix_memalign(&_Ptr, _Align, _Size) != 0) {
+                    _Ptr = nullptr;
+                }
+#endif // _MJX_WINDOWS
+            }
+
+            if (!_Ptr) {
+                allocation_failure::raise();
+            }
+
+            return _Ptr;
+        }
+
+        void deallocate(pointer _Ptr, size_type, size_type _Align = 0) noexcept override {
+#ifdef _MJX_WINDOWS
+            if (_Align > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+                ::_aligned_free(_Ptr);
+                return;
+            }
+#else // ^^^ _MJX_WINDOWS ^^^ / vvv _MJX_LINUX vvv
+            static_cast<void>(_Align); // free() handles both kinds of blocks
+#endif // _MJX_WINDOWS
+            ::free(_Ptr);
+        }
+
+        allocator_tag tag() const noexcept override {
+            return allocator_tag::unknown;
+        }
+
+        size_type max_size() const noexcept override {
+            return static_cast<size_type>(-1);
+        }
+
+        bool is_equal(const allocator& _Other) const noexcept override {
+            return dynamic_cast<const _Malloc_allocator*>(&_Other) != nullptr;
+        }
+    };
+
+    class _Std_allocator final : public allocator { // baseline, forwards to std::allocator
+    public:
+        pointer allocate(size_type _Size, size_type _Align = 0) override {
+            if (_Align <= __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+                return ::std::allocator<::std::byte>{}.allocate(_Size);
+            } else { // std::allocator<T> of an over-aligned T does the same
+                return ::operator new(_Size, ::std::align_val_t{_Align});
+            }
+        }
+
+        void deallocate(pointer _Ptr, size_type _Size, size_type _Align = 0) noexcept override {
+            if (_Align <= __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+                ::std::allocator<::std::byte>{}.deallocate(static_cast<::std::byte*>(_Ptr), _Size);
+            } else {
+                ::operator delete(_Ptr, _Size, ::std::align_val_t{_Align});
+            }
+        }
+
+        allocator_tag tag() const noexcept override {
+            return allocator_tag::unknown;
+        }
+
+        size_type max_size() const noexcept override {
+            return ::std::allocator_traits<::std::allocator<::std::byte>>::max_size(::std::allocator<::std::byte>{});
+        }
+
+        bool is_equal(const allocator& _Other) const noexcept override {
+            return dynamic_cast<const _Std_allocator*>(&_Other) != nullptr;
+        }
+    };
+
+    struct _Bm_object { // small object with a non-trivial constructor
+        void* _Next     = nullptr;
+        size_t _Value   = 0;
+        uint32_t _Flags = 1;
+    };
+
+    template <class _Alloc>
+    _Alloc& _Get_benchmark_allocator() {
+        // returns an allocator that lives as long as the benchmark process
+        static _Alloc _Al;
+        return _Al;
+    }
+
+    template <class _Alloc>
+    void _Bm_allocate(::benchmark::State& _State) {
+        // allocates and deallocates a single block, calls the allocator directly
+        _Alloc& _Al         = _Get_benchmark_allocator<_Alloc>();
+        const size_t _Size  = static_cast<size_t>(_State.range(0));
+        const size_t _Align = static_cast<size_t>(_State.range(1));
+        for (auto _Ux : _State) {
+            void* const _Ptr = _Al.allocate(_Size, _Align);
+            ::benchmark::DoNotOptimize(_Ptr);
+            _Al.deallocate(_Ptr, _Size, _Align);
+        }
+
+        _State.SetItemsProcessed(_State.iterations());
+    }
+
+    template <class _Alloc>
+    void _Bm_create_object(::benchmark::State& _State) {
+        // creates and deletes a single object through the global allocator
+        scoped_allocator_override _Override(_Get_benchmark_allocator<_Alloc>());
+        for (auto _Ux : _State) {
+            _Bm_object* const _Obj = ::mjx::create_object<_Bm_object>();
+            ::benchmark::DoNotOptimize(_Obj);
+            ::mjx::delete_object(_Obj);
+        }
+
+        _State.SetItemsProcessed(_State.iterations());
+    }
+
+    template <class _Alloc>
+    void _Bm_create_object_array(::benchmark::State& _State) {
+        // creates and deletes an array of objects through the global allocator
+        scoped_allocator_override _Override(_Get_benchmark_allocator<_Alloc>());
+        const size_t _Count = static_cast<size_t>(_State.range(0));
+        for (auto _Ux : _State) {
+            _Bm_object* const _Array = ::mjx::create_object_array<_Bm_object>(_Count);
+            ::benchmark::DoNotOptimize(_Array);
+            ::mjx::delete_object_array(_Array, _Count);
+        }
+
+        _State.SetItemsProcessed(_State.iterations() * _State.range(0));
+    }
+
+    template <class _Alloc>
+    void _Bm_vector_push_back(::benchmark::State& _State) {
+        // fills a vector that allocates through object_allocator, so it grows a few times per iteration
+        scoped_allocator_override _Override(_Get_benchmark_allocator<_Alloc>());
+        const size_t _Count = static_cast<size_t>(_State.range(0));
+        for (auto _Ux : _State) {
+            ::std::vector<_Bm_object, object_allocator<_Bm_object>> _Vec;
+            for (size_t _Idx = 0; _Idx < _Count; ++_Idx) {
+                _Vec.emplace_back();
+            }
+
+            ::benchmark::DoNotOptimize(_Vec.data());
+        }
+
+        _State.SetItemsProcessed(_State.iterations() * _State.range(0));
+    }
+
+    void _Bm_std_vector_push_back(::benchmark::State& _State) {
+        // the same as _Bm_vector_push_back(), but with std::allocator and no global allocator in between
+        const size_t _Count = static_cast<size_t>(_State.range(0));
+        for (auto _Ux : _State) {
+            ::std::vector<_Bm_object> _Vec;
+            for (size_t _Idx = 0; _Idx < _Count; ++_Idx) {
+                _Vec.emplace_back();
+            }
+
+            ::benchmark::DoNotOptimize(_Vec.data());
+        }
+
+        _State.SetItemsProcessed(_State.iterations() * _State.range(0));
+    }
+
+#define _MJX_REGISTER_ALLOCATION_BENCHMARKS(_Alloc)                                 \
+    BENCHMARK(_Bm_allocate<_Alloc>)                                                 \
+        ->ArgsProduct({{16, 256, 4096}, {0, 64}})                                   \
+        ->ArgNames({"size", "align"});                                              \
+    BENCHMARK(_Bm_create_object<_Alloc>);                                           \
+    BENCHMARK(_Bm_create_object_array<_Alloc>)->Arg(64);                            \
+    BENCHMARK(_Bm_vector_push_back<_Alloc>)->Arg(1024)
+
+    _MJX_REGISTER_ALLOCATION_BENCHMARKS(_Malloc_allocator);
+    _MJX_REGISTER_ALLOCATION_BENCHMARKS(_Std_allocator);
+    _MJX_REGISTER_ALLOCATION_BENCHMARKS(system_allocator);
+    _MJX_REGISTER_ALLOCATION_BENCHMARKS(small_object_allocator);
+    BENCHMARK(_Bm_std_vector_push_back)->Arg(1024);
+#undef _MJX_REGISTER_ALLOCATION_BENCHMARKS
+} // namespace mjx
+
+BENCHMARK_MAIN();
\ No newline at end of file
@@ -0,0 +1,81 @@
+// benchmark.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <benchmark/benchmark.h>
+#include <mjxsdk/memory/concurrent_pool_allocator.hpp>
+#include <mjxsdk/memory/object.hpp>
+#include <mjxsdk/memory/pool_allocator.hpp>
+#include <mjxsdk/memory/small_object_allocator.hpp>
+#include <mjxsdk/memory/system_allocator.hpp>
+#include <mjxsdk/memory/thread_cache_allocator.hpp>
+#include <type_traits>
+#include <vector>
+
+namespace mjx {
+    struct _Bm_record { // small object, typical for a single record of an ingested message
+        uint64_t _Key;
+        uint64_t _Value;
+        uint32_t _Flags;
+    };
+
+    template <class _Alloc>
+    allocator& _Make_benchmark_allocator() {
+        // returns an allocator that lives as long as the benchmark process, seen through the base class
+        if constexpr (::std::is_constructible_v<_Alloc, size_t, allocator&, size_t>) { // pool-like allocator
+            static system_allocator _Upstream;
+            static _Alloc _Al(sizeof(_Bm_record), _Upstream, alignof(_Bm_record));
+            return _Al;
+        } else {
+            static _Alloc _Al;
+            return _Al;
+        }
+    }
+
+    template <class _Alloc>
+    void _Bm_single_allocation(::benchmark::State& _State) {
+        // creates and deletes each record with a separate virtual call
+        allocator& _Al = _Make_benchmark_allocator<_Alloc>();
+        ::std::vector<_Bm_record*> _Records(static_cast<size_t>(_State.range(0)));
+        for (auto _Ux : _State) {
+            for (_Bm_record*& _Record : _Records) {
+                _Record = ::mjx::create_object_using_allocator<_Bm_record>(_Al);
+            }
+
+            ::benchmark::DoNotOptimize(_Records.data());
+            for (_Bm_record* const _Record : _Records) {
+                ::mjx::delete_object_using_allocator(_Record, _Al);
+            }
+        }
+
+        _State.SetItemsProcessed(_State.iterations() * _State.range(0));
+    }
+
+    template <class _Alloc>
+    void _Bm_bulk_allocation(::benchmark::State& _State) {
+        // creates and deletes all records in batches
+        allocator& _Al = _Make_benchmark_allocator<_Alloc>();
+        ::std::vector<_Bm_record*> _Records(static_cast<size_t>(_State.range(0)));
+        for (auto _Ux : _State) {
+            ::mjx::create_objects_using_allocator(_Records.data(), _Records.size(), _Al);
+            ::benchmark::DoNotOptimize(_Records.data());
+            ::mjx::delete_objects_using_allocator(_Records.data(), _Records.size(), _Al);
+        }
+
+        _State.SetItemsProcessed(_State.iterations() * _State.range(0));
+    }
+
+    BENCHMARK(_Bm_single_allocation<system_allocator>)->Arg(10'000);
+    BENCHMARK(_Bm_bulk_allocation<system_allocator>)->Arg(10'000);
+    BENCHMARK(_Bm_single_allocation<pool_allocator>)->Arg(10'000);
+    BENCHMARK(_Bm_bulk_allocation<pool_allocator>)->Arg(10'000);
+    BENCHMARK(_Bm_single_allocation<concurrent_pool_allocator>)->Arg(10'000);
+    BENCHMARK(_Bm_bulk_allocation<concurrent_pool_allocator>)->Arg(10'000);
+    BENCHMARK(_Bm_single_allocation<small_object_allocator>)->Arg(10'000);
+    BENCHMARK(_Bm_bulk_allocation<small_object_allocator>)->Arg(10'000);
+    BENCHMARK(_Bm_single_allocation<thread_cache_allocator>)->Arg(10'000);
+    BENCHMARK(_Bm_bulk_allocation<thread_cache_allocator>)->Arg(10'000);
+} // namespace mjx
+
+BENCHMARK_MAIN();
\ No newline at end of file
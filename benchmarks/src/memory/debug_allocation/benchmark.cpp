@@ -0,0 +1,54 @@
+// benchmark.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <benchmark/benchmark.h>
+#include <cstdlib>
+#include <mjxsdk/memory/debug_allocation.hpp>
+#include <mjxsdk/memory/system_allocator.hpp>
+
+// Note: Benchmarks run in the order of registration. Checked mode leaves a sticky trace once enabled,
+//       so the benchmarks that measure the disabled fast path are registered first.
+namespace mjx {
+    void _Bm_heap_baseline(::benchmark::State& _State) {
+        // calls the C heap directly, the cost that system_allocator adds is measured against it
+        const size_t _Size = static_cast<size_t>(_State.range(0));
+        for (auto _Ux : _State) {
+            void* const _Ptr = ::malloc(_Size);
+            ::benchmark::DoNotOptimize(_Ptr);
+            ::free(_Ptr);
+        }
+    }
+
+    void _Bm_system_allocator(::benchmark::State& _State) {
+        // allocates through the base class, the same way containers do
+        static system_allocator _Sys;
+        allocator& _Al     = _Sys;
+        const size_t _Size = static_cast<size_t>(_State.range(0));
+        ::benchmark::DoNotOptimize(&_Al); // prevent the compiler from deducing the dynamic type
+        for (auto _Ux : _State) {
+            void* const _Ptr = _Al.allocate(_Size);
+            ::benchmark::DoNotOptimize(_Ptr);
+            _Al.deallocate(_Ptr, _Size);
+        }
+    }
+
+    void _Bm_checked_mode(::benchmark::State& _State) {
+        ::mjx::enable_debug_allocation();
+        _Bm_system_allocator(_State);
+        ::mjx::disable_debug_allocation();
+    }
+
+    void _Bm_after_checked_mode(::benchmark::State& _State) {
+        // checked mode was enabled before, deallocations still look up the checked blocks
+        _Bm_system_allocator(_State);
+    }
+
+    BENCHMARK(_Bm_heap_baseline)->RangeMultiplier(8)->Range(16, 4096);
+    BENCHMARK(_Bm_system_allocator)->RangeMultiplier(8)->Range(16, 4096);
+    BENCHMARK(_Bm_checked_mode)->RangeMultiplier(8)->Range(16, 4096);
+    BENCHMARK(_Bm_after_checked_mode)->RangeMultiplier(8)->Range(16, 4096);
+} // namespace mjx
+
+BENCHMARK_MAIN();
\ No newline at end of file
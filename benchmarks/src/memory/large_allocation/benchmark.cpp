@@ -0,0 +1,53 @@
+// benchmark.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <benchmark/benchmark.h>
+#include <cstdlib>
+#include <mjxsdk/memory/system_allocator.hpp>
+
+namespace mjx {
+    // the distance between the bytes touched in each block, one per page
+    inline constexpr size_t _Touch_stride = 4096;
+
+    void _Touch_pages(void* const _Ptr, const size_t _Size) noexcept {
+        // writes one byte per page, so that the cost of fresh pages is included
+        unsigned char* const _Bytes = static_cast<unsigned char*>(_Ptr);
+        for (size_t _Off = 0; _Off < _Size; _Off += _Touch_stride) {
+            _Bytes[_Off] = 1;
+        }
+
+        ::benchmark::ClobberMemory();
+    }
+
+    void _Bm_malloc_cycle(::benchmark::State& _State) {
+        // allocates, touches and frees a large block through the C heap
+        const size_t _Size = static_cast<size_t>(_State.range(0));
+        for (auto _Ux : _State) {
+            void* const _Ptr = ::malloc(_Size);
+            _Touch_pages(_Ptr, _Size);
+            ::free(_Ptr);
+        }
+
+        _State.SetItemsProcessed(_State.iterations());
+    }
+
+    void _Bm_system_allocator_cycle(::benchmark::State& _State) {
+        // allocates, touches and frees a large block through system_allocator
+        system_allocator _Al;
+        const size_t _Size = static_cast<size_t>(_State.range(0));
+        for (auto _Ux : _State) {
+            void* const _Ptr = _Al.allocate(_Size);
+            _Touch_pages(_Ptr, _Size);
+            _Al.deallocate(_Ptr, _Size);
+        }
+
+        _State.SetItemsProcessed(_State.iterations());
+    }
+
+    BENCHMARK(_Bm_malloc_cycle)->RangeMultiplier(4)->Range(256 * 1024, 64 * 1024 * 1024);
+    BENCHMARK(_Bm_system_allocator_cycle)->RangeMultiplier(4)->Range(256 * 1024, 64 * 1024 * 1024);
+} // namespace mjx
+
+BENCHMARK_MAIN();
\ No newline at end of file
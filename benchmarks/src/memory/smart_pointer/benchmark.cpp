@@ -0,0 +1,124 @@
+// benchmark.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <memory>
+#include <mjxsdk/memory/smart_pointer.hpp>
+#include <type_traits>
+
+// Note: Each case is a template of the smart pointer type, the mjx and std types run the same code.
+//       Both libraries allocate through the default heap, mjx through system_allocator and std through new.
+//       The differences are the control block (mjx allocates a reference_counter separately, std::make_shared()
+//       places it next to the object) and the bounds check of the mjx arrays' operator[].
+namespace mjx {
+    using _Bm_value = uint64_t;
+
+    template <class _Ptr>
+    _Ptr _Make_pointer() {
+        // creates a pointer that manages a single value
+        if constexpr (::std::is_same_v<_Ptr, unique_ptr<_Bm_value>>) {
+            return ::mjx::make_unique<_Bm_value>(_Bm_value{1});
+        } else if constexpr (::std::is_same_v<_Ptr, shared_ptr<_Bm_value>>) {
+            return ::mjx::make_shared<_Bm_value>(_Bm_value{1});
+        } else if constexpr (::std::is_same_v<_Ptr, ::std::unique_ptr<_Bm_value>>) {
+            return ::std::make_unique<_Bm_value>(_Bm_value{1});
+        } else {
+            return ::std::make_shared<_Bm_value>(_Bm_value{1});
+        }
+    }
+
+    template <class _Ptr>
+    _Ptr _Make_array(const size_t _Size) {
+        // creates a pointer that manages a value-initialized array
+        if constexpr (::std::is_same_v<_Ptr, unique_array<_Bm_value>>) {
+            return ::mjx::make_unique_array<_Bm_value>(_Size);
+        } else if constexpr (::std::is_same_v<_Ptr, shared_array<_Bm_value>>) {
+            return ::mjx::make_shared_array<_Bm_value>(_Size);
+        } else if constexpr (::std::is_same_v<_Ptr, ::std::unique_ptr<_Bm_value[]>>) {
+            return ::std::make_unique<_Bm_value[]>(_Size);
+        } else {
+            return ::std::make_shared<_Bm_value[]>(_Size);
+        }
+    }
+
+    template <class _Ptr>
+    void _Bm_create(::benchmark::State& _State) {
+        // creates and destroys a pointer to a single value
+        for (auto _Ux : _State) {
+            _Ptr _Val = _Make_pointer<_Ptr>();
+            ::benchmark::DoNotOptimize(_Val.get());
+        }
+    }
+
+    template <class _Ptr>
+    void _Bm_create_array(::benchmark::State& _State) {
+        // creates and destroys a pointer to an array
+        const size_t _Size = static_cast<size_t>(_State.range(0));
+        for (auto _Ux : _State) {
+            _Ptr _Array = _Make_array<_Ptr>(_Size);
+            ::benchmark::DoNotOptimize(_Array.get());
+        }
+    }
+
+    template <class _Ptr>
+    const _Ptr& _Get_shared_source() {
+        // returns the pointer that all benchmark threads copy, so they contend on the same reference counter
+        if constexpr (::std::is_same_v<_Ptr, shared_array<_Bm_value>>
+                      || ::std::is_same_v<_Ptr, ::std::shared_ptr<_Bm_value[]>>) {
+            static const _Ptr _Source = _Make_array<_Ptr>(16);
+            return _Source;
+        } else {
+            static const _Ptr _Source = _Make_pointer<_Ptr>();
+            return _Source;
+        }
+    }
+
+    template <class _Ptr>
+    void _Bm_copy(::benchmark::State& _State) {
+        // copies the shared pointer and destroys the copy, that is one increment and one decrement
+        const _Ptr& _Source = _Get_shared_source<_Ptr>();
+        for (auto _Ux : _State) {
+            _Ptr _Copy = _Source;
+            ::benchmark::DoNotOptimize(_Copy.get());
+        }
+    }
+
+    template <class _Ptr>
+    void _Bm_subscript(::benchmark::State& _State) {
+        // sums the array through operator[], the mjx arrays check every index
+        const size_t _Size = static_cast<size_t>(_State.range(0));
+        const _Ptr _Array  = _Make_array<_Ptr>(_Size);
+        for (auto _Ux : _State) {
+            _Bm_value _Sum = 0;
+            for (size_t _Idx = 0; _Idx < _Size; ++_Idx) {
+                _Sum += _Array[_Idx];
+            }
+
+            ::benchmark::DoNotOptimize(_Sum);
+        }
+
+        _State.SetItemsProcessed(_State.iterations() * _State.range(0));
+    }
+
+    BENCHMARK(_Bm_create<unique_ptr<_Bm_value>>);
+    BENCHMARK(_Bm_create<::std::unique_ptr<_Bm_value>>);
+    BENCHMARK(_Bm_create<shared_ptr<_Bm_value>>);
+    BENCHMARK(_Bm_create<::std::shared_ptr<_Bm_value>>);
+    BENCHMARK(_Bm_create_array<unique_array<_Bm_value>>)->Arg(64);
+    BENCHMARK(_Bm_create_array<::std::unique_ptr<_Bm_value[]>>)->Arg(64);
+    BENCHMARK(_Bm_create_array<shared_array<_Bm_value>>)->Arg(64);
+    BENCHMARK(_Bm_create_array<::std::shared_ptr<_Bm_value[]>>)->Arg(64);
+    BENCHMARK(_Bm_copy<shared_ptr<_Bm_value>>)->ThreadRange(1, 8);
+    BENCHMARK(_Bm_copy<::std::shared_ptr<_Bm_value>>)->ThreadRange(1, 8);
+    BENCHMARK(_Bm_copy<shared_array<_Bm_value>>)->ThreadRange(1, 8);
+    BENCHMARK(_Bm_copy<::std::shared_ptr<_Bm_value[]>>)->ThreadRange(1, 8);
+    BENCHMARK(_Bm_subscript<unique_array<_Bm_value>>)->Arg(4096);
+    BENCHMARK(_Bm_subscript<::std::unique_ptr<_Bm_value[]>>)->Arg(4096);
+    BENCHMARK(_Bm_subscript<shared_array<_Bm_value>>)->Arg(4096);
+    BENCHMARK(_Bm_subscript<::std::shared_ptr<_Bm_value[]>>)->Arg(4096);
+} // namespace mjx
+
+BENCHMARK_MAIN();
\ No newline at end of file
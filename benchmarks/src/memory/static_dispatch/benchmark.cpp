@@ -0,0 +1,60 @@
+// benchmark.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <benchmark/benchmark.h>
+#include <mjxsdk/memory/object.hpp>
+#include <mjxsdk/memory/pool_allocator.hpp>
+#include <mjxsdk/memory/system_allocator.hpp>
+#include <type_traits>
+
+namespace mjx {
+    struct _Bm_object { // small object, typical for node-based containers
+        void* _Next;
+        size_t _Value;
+    };
+
+    template <class _Alloc>
+    _Alloc& _Make_benchmark_allocator() {
+        // returns an allocator that lives as long as the benchmark process
+        if constexpr (::std::is_same_v<_Alloc, pool_allocator>) {
+            static system_allocator _Upstream;
+            static pool_allocator _Al(sizeof(_Bm_object), _Upstream, alignof(_Bm_object));
+            return _Al;
+        } else {
+            static _Alloc _Al;
+            return _Al;
+        }
+    }
+
+    template <class _Alloc>
+    void _Bm_virtual_dispatch(::benchmark::State& _State) {
+        // calls through the base class, the allocator's type is unknown at the call site
+        allocator& _Al = _Make_benchmark_allocator<_Alloc>();
+        ::benchmark::DoNotOptimize(&_Al); // prevent the compiler from deducing the dynamic type
+        for (auto _Ux : _State) {
+            _Bm_object* const _Obj = ::mjx::allocate_object_using_allocator<_Bm_object>(_Al);
+            ::benchmark::DoNotOptimize(_Obj);
+            ::mjx::deallocate_object_using_allocator(_Obj, _Al);
+        }
+    }
+
+    template <class _Alloc>
+    void _Bm_static_dispatch(::benchmark::State& _State) {
+        // calls the final allocator directly, the allocator's type is known at the call site
+        _Alloc& _Al = _Make_benchmark_allocator<_Alloc>();
+        for (auto _Ux : _State) {
+            _Bm_object* const _Obj = ::mjx::allocate_object_using_allocator<_Bm_object>(_Al);
+            ::benchmark::DoNotOptimize(_Obj);
+            ::mjx::deallocate_object_using_allocator(_Obj, _Al);
+        }
+    }
+
+    BENCHMARK(_Bm_virtual_dispatch<system_allocator>);
+    BENCHMARK(_Bm_static_dispatch<system_allocator>);
+    BENCHMARK(_Bm_virtual_dispatch<pool_allocator>);
+    BENCHMARK(_Bm_static_dispatch<pool_allocator>);
+} // namespace mjx
+
+BENCHMARK_MAIN();
\ No newline at end of file
@@ -0,0 +1,52 @@
+// benchmark.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <benchmark/benchmark.h>
+#include <mjxsdk/memory/small_object_allocator.hpp>
+#include <mjxsdk/memory/system_allocator.hpp>
+#include <mjxsdk/memory/thread_cache_allocator.hpp>
+
+namespace mjx {
+    // the number of blocks that each thread keeps alive during a single iteration
+    inline constexpr size_t _Blocks_per_iteration = 64;
+
+    template <class _Alloc>
+    _Alloc& _Get_shared_allocator() {
+        // returns the allocator that is shared by all benchmark threads
+        static _Alloc _Al;
+        return _Al;
+    }
+
+    template <class _Alloc>
+    void _Bm_allocate_and_free(::benchmark::State& _State) {
+        // each thread allocates a burst of mixed-size blocks and frees them in the same order
+        _Alloc& _Al = _Get_shared_allocator<_Alloc>();
+        void* _Blocks[_Blocks_per_iteration];
+        size_t _Sizes[_Blocks_per_iteration];
+        for (size_t _Idx = 0; _Idx < _Blocks_per_iteration; ++_Idx) {
+            _Sizes[_Idx] = 16 + ((_Idx * 37 + static_cast<size_t>(_State.thread_index()) * 11) % 496);
+        }
+
+        for (auto _Ux : _State) {
+            for (size_t _Idx = 0; _Idx < _Blocks_per_iteration; ++_Idx) {
+                _Blocks[_Idx] = _Al.allocate(_Sizes[_Idx]);
+                ::benchmark::DoNotOptimize(_Blocks[_Idx]);
+            }
+
+            for (size_t _Idx = 0; _Idx < _Blocks_per_iteration; ++_Idx) {
+                _Al.deallocate(_Blocks[_Idx], _Sizes[_Idx]);
+            }
+        }
+
+        // report allocations per second, summed over all threads
+        _State.SetItemsProcessed(_State.iterations() * static_cast<int64_t>(_Blocks_per_iteration));
+    }
+
+    BENCHMARK(_Bm_allocate_and_free<system_allocator>)->ThreadRange(1, 64)->UseRealTime();
+    BENCHMARK(_Bm_allocate_and_free<small_object_allocator>)->ThreadRange(1, 64)->UseRealTime();
+    BENCHMARK(_Bm_allocate_and_free<thread_cache_allocator>)->ThreadRange(1, 64)->UseRealTime();
+} // namespace mjx
+
+BENCHMARK_MAIN();
\ No newline at end of file
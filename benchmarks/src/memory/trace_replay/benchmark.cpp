@@ -0,0 +1,378 @@
+// benchmark.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <algorithm>
+#include <atomic>
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mjxsdk/memory/allocation_trace.hpp>
+#include <mjxsdk/memory/memory_resource.hpp>
+#include <mjxsdk/memory/small_object_allocator.hpp>
+#include <mjxsdk/memory/system_allocator.hpp>
+#include <mjxsdk/memory/thread_cache_allocator.hpp>
+#include <mjxsdk/memory/tlsf_allocator.hpp>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#ifdef _MJX_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#include <Psapi.h>
+#else // ^^^ _MJX_WINDOWS ^^^ / vvv _MJX_LINUX vvv
+#include <unistd.h>
+#endif // _MJX_WINDOWS
+
+// Note: Replays a trace written by start_allocation_trace() against several allocators.
+//       Usage: benchmark_memory_trace_replay [benchmark options] [trace file]. If no trace is given,
+//       a synthetic workload is recorded first and removed afterwards. The events are sorted by timestamp,
+//       and every recorded thread gets its own replay thread, which runs its operations in the recorded order.
+//       The threads run concurrently and only wait when they free a block that another thread allocated,
+//       until that block exists. Each benchmark reports:
+//       - items per second, the number of replayed operations per second spent inside the allocator,
+//         that is divided by the sum of all operation latencies, so that waiting is never counted
+//       - p50_ns, p99_ns and p999_ns, latency percentiles of single operations
+//       - peak_rss_mb, the largest growth of the resident set during the replay, sampled every 1024 operations
+//       - fragmentation, the peak resident set growth divided by the peak number of live requested bytes
+//       Memory that an allocator keeps from earlier benchmarks is not counted as growth, run one allocator
+//       per process (--benchmark_filter) to compare the resident set figures.
+namespace mjx {
+    struct _Replay_op { // a single allocation or deallocation with a resolved block
+        size_t _Size;
+        size_t _Align;
+        uint32_t _Slot; // the index of the block in the replay's block table
+        bool _Allocate;
+        bool _Cross_thread; // a deallocation of a block that another thread allocated
+    };
+
+    struct _Replay_trace {
+        ::std::vector<_Replay_op> _Ops; // in the recorded order
+        ::std::vector<::std::vector<size_t>> _Thread_ops; // the indices of each thread's operations
+        size_t _Slot_count = 0;
+    };
+
+    inline size_t _Get_resident_bytes() noexcept {
+        // returns the current resident set size of the process
+#ifdef _MJX_WINDOWS
+        ::PROCESS_MEMORY_COUNTERS _Counters;
+        return ::K32GetProcessMemoryInfo(::GetCurrentProcess(), &_Counters, sizeof(_Counters))
+                 ? _Counters.WorkingSetSize
+                 : 0;
+#else // ^^^ _MJX_WINDOWS ^^^ / vvv _MJX_LINUX vvv
+        FILE* const _File = ::fopen("/proc/self/statm", "r");
+        if (!_File) {
+            return 0;
+        }
+
+        unsigned long _Total    = 0;
+        unsigned long _Resident = 0;
+        const int _Read         = ::fscanf(_File, "%lu %lu", &_Total, &_Resident);
+        ::fclose(_File);
+        return _Read == 2 ? _Resident * static_cast<size_t>(::sysconf(_SC_PAGESIZE)) : 0;
+#endif // _MJX_WINDOWS
+    }
+
+    bool _Load_trace(const char* const _Path, _Replay_trace& _Trace) {
+        // reads the trace and resolves every deallocation to the block allocated at the same address
+        ::std::ifstream _File(_Path, ::std::ios::binary);
+        trace_file_header _Header;
+        if (!_File.read(reinterpret_cast<char*>(&_Header), sizeof(trace_file_header))
+            || ::memcmp(_Header.magic, "MJXTRACE", sizeof(_Header.magic)) != 0
+            || _Header.version != trace_format_version || _Header.event_size != sizeof(trace_event)) {
+            return false;
+        }
+
+        ::std::vector<trace_event> _Events(static_cast<size_t>(_Header.event_count));
+        if (!_File.read(reinterpret_cast<char*>(_Events.data()),
+                static_cast<::std::streamsize>(_Events.size() * sizeof(trace_event)))) {
+            return false;
+        }
+
+        ::std::stable_sort(_Events.begin(), _Events.end(),
+            [](const trace_event& _Left, const trace_event& _Right) { return _Left.timestamp < _Right.timestamp; });
+        struct _Live_block {
+            uint32_t _Slot;
+            size_t _Thread; // the replay thread that allocates the block
+        };
+
+        ::std::unordered_map<uint32_t, size_t> _Threads; // recorded thread number -> replay thread
+        ::std::unordered_map<uint64_t, _Live_block> _Live; // recorded address -> block
+        for (const trace_event& _Event : _Events) {
+            const size_t _Thread = _Threads.try_emplace(_Event.thread, _Threads.size()).first->second;
+            _Replay_op _Op;
+            _Op._Size         = static_cast<size_t>(_Event.size);
+            _Op._Align        = _Event.align_log2 != 0 ? size_t{1} << _Event.align_log2 : 0;
+            _Op._Allocate     = _Event.kind == trace_event_kind::allocation;
+            _Op._Cross_thread = false;
+            if (_Op._Allocate) { // assign a new slot
+                _Op._Slot             = static_cast<uint32_t>(_Trace._Slot_count++);
+                _Live[_Event.address] = _Live_block{_Op._Slot, _Thread};
+            } else {
+                const auto _Iter = _Live.find(_Event.address);
+                if (_Iter == _Live.end()) { // allocated before the recording started
+                    continue;
+                }
+
+                _Op._Slot         = _Iter->second._Slot;
+                _Op._Cross_thread = _Iter->second._Thread != _Thread && _Op._Size != 0; // empty blocks are null
+                _Live.erase(_Iter);
+            }
+
+            if (_Thread == _Trace._Thread_ops.size()) {
+                _Trace._Thread_ops.emplace_back();
+            }
+
+            _Trace._Thread_ops[_Thread].push_back(_Trace._Ops.size());
+            _Trace._Ops.push_back(_Op);
+        }
+
+        return true;
+    }
+
+    bool _Record_synthetic_trace(const char* const _Path) {
+        // records a mixed workload of small and medium blocks on several threads
+        constexpr size_t _Thread_count = 4;
+        constexpr size_t _Iterations   = 50'000;
+        constexpr size_t _Max_blocks   = 4096; // the number of blocks that each thread keeps alive at most
+        if (!::mjx::start_allocation_trace(_Path, 64 * 1024 * 1024)) {
+            return false;
+        }
+
+        system_allocator _Al;
+        ::std::vector<::std::thread> _Threads;
+        for (size_t _Thread = 0; _Thread < _Thread_count; ++_Thread) {
+            _Threads.emplace_back([&_Al, _Thread] {
+                ::std::vector<::std::pair<void*, size_t>> _Blocks;
+                uint64_t _Seed = 0x9E37'79B9'7F4A'7C15 * (_Thread + 1);
+                for (size_t _Idx = 0; _Idx < _Iterations; ++_Idx) {
+                    _Seed ^= _Seed << 13;
+                    _Seed ^= _Seed >> 7;
+                    _Seed ^= _Seed << 17;
+                    if (_Blocks.size() < _Max_blocks && (_Seed & 3) != 0) { // allocate more often than free
+                        const size_t _Size = 16 + static_cast<size_t>((_Seed >> 8) % ((_Seed & 4) ? 4096 : 256));
+                        _Blocks.emplace_back(_Al.allocate(_Size), _Size);
+                    } else if (!_Blocks.empty()) {
+                        const size_t _Victim = static_cast<size_t>((_Seed >> 16) % _Blocks.size());
+                        _Al.deallocate(_Blocks[_Victim].first, _Blocks[_Victim].second);
+                        _Blocks[_Victim] = _Blocks.back();
+                        _Blocks.pop_back();
+                    }
+                }
+
+                for (const auto& _Block : _Blocks) {
+                    _Al.deallocate(_Block.first, _Block.second);
+                }
+            });
+        }
+
+        for (::std::thread& _Thread : _Threads) {
+            _Thread.join();
+        }
+
+        ::mjx::stop_allocation_trace();
+        return true;
+    }
+
+    struct _Replay_result {
+        double _Seconds       = 0.0; // the sum of all operation latencies
+        size_t _Peak_resident = 0; // the largest growth of the resident set
+        size_t _Peak_live     = 0; // the largest number of live requested bytes
+        bool _Failed          = false;
+        ::std::vector<uint32_t> _Latencies; // in nanoseconds, one per operation
+    };
+
+    inline void _Update_maximum(::std::atomic<size_t>& _Max, const size_t _Value) noexcept {
+        size_t _Current = _Max.load(::std::memory_order_relaxed);
+        while (_Current < _Value && !_Max.compare_exchange_weak(_Current, _Value, ::std::memory_order_relaxed)) {
+        }
+    }
+
+    _Replay_result _Replay(const _Replay_trace& _Trace, allocator& _Al) {
+        // runs every thread's operations concurrently, each thread in its recorded order
+        _Replay_result _Result;
+        _Result._Latencies.resize(_Trace._Ops.size());
+        ::std::vector<::std::atomic<void*>> _Blocks(_Trace._Slot_count); // published by the allocating thread
+        ::std::atomic<size_t> _Live{0};
+        ::std::atomic<size_t> _Peak_live{0};
+        ::std::atomic<size_t> _Peak_resident{0};
+        ::std::atomic<bool> _Failed{false};
+        const size_t _Baseline = _Get_resident_bytes();
+        ::std::vector<::std::thread> _Threads;
+        for (const ::std::vector<size_t>& _Indices : _Trace._Thread_ops) {
+            _Threads.emplace_back([&, _Indices_ptr = &_Indices] {
+                size_t _Count = 0;
+                for (const size_t _Idx : *_Indices_ptr) {
+                    const _Replay_op& _Op        = _Trace._Ops[_Idx];
+                    ::std::atomic<void*>& _Block = _Blocks[_Op._Slot];
+                    if (_Op._Cross_thread) { // wait until the other thread has allocated the block
+                        while (!_Block.load(::std::memory_order_acquire)
+                               && !_Failed.load(::std::memory_order_relaxed)) {
+                            ::std::this_thread::yield();
+                        }
+                    }
+
+                    if (_Failed.load(::std::memory_order_relaxed)) { // the replay is incomplete anyway
+                        break;
+                    }
+
+                    void* _Ptr           = _Op._Allocate ? nullptr : _Block.load(::std::memory_order_relaxed);
+                    const auto _Op_start = ::std::chrono::steady_clock::now();
+                    try {
+                        if (_Op._Allocate) {
+                            _Ptr = _Al.allocate(_Op._Size, _Op._Align);
+                        } else {
+                            _Al.deallocate(_Ptr, _Op._Size, _Op._Align);
+                        }
+                    } catch (...) { // the allocator cannot serve the trace, let the other threads stop
+                        _Failed.store(true, ::std::memory_order_relaxed);
+                        break;
+                    }
+
+                    _Result._Latencies[_Idx] = static_cast<uint32_t>(
+                        ::std::chrono::duration_cast<::std::chrono::nanoseconds>(
+                            ::std::chrono::steady_clock::now() - _Op_start)
+                            .count());
+                    if (_Op._Allocate) { // count the block before it is published, so that _Live never wraps
+                        const size_t _Prev = _Live.fetch_add(_Op._Size, ::std::memory_order_relaxed);
+                        _Update_maximum(_Peak_live, _Prev + _Op._Size);
+                        _Block.store(_Ptr, ::std::memory_order_release);
+                    } else {
+                        _Live.fetch_sub(_Op._Size, ::std::memory_order_relaxed);
+                        _Block.store(nullptr, ::std::memory_order_relaxed);
+                    }
+
+                    if (++_Count % 1024 == 0) { // sample the resident set
+                        const size_t _Resident = _Get_resident_bytes();
+                        if (_Resident > _Baseline) {
+                            _Update_maximum(_Peak_resident, _Resident - _Baseline);
+                        }
+                    }
+                }
+            });
+        }
+
+        for (::std::thread& _Thread : _Threads) {
+            _Thread.join();
+        }
+
+        for (size_t _Idx = 0; _Idx < _Trace._Ops.size(); ++_Idx) { // free the blocks that the trace never freed
+            const _Replay_op& _Op = _Trace._Ops[_Idx];
+            if (void* const _Ptr = _Blocks[_Op._Slot].load(::std::memory_order_relaxed); _Op._Allocate && _Ptr) {
+                _Al.deallocate(_Ptr, _Op._Size, _Op._Align);
+                _Blocks[_Op._Slot].store(nullptr, ::std::memory_order_relaxed);
+            }
+        }
+
+        uint64_t _Total_ns = 0;
+        for (const uint32_t _Latency : _Result._Latencies) {
+            _Total_ns += _Latency;
+        }
+
+        _Result._Seconds       = static_cast<double>(_Total_ns) * 1e-9;
+        _Result._Peak_resident = _Peak_resident.load(::std::memory_order_relaxed);
+        _Result._Peak_live     = _Peak_live.load(::std::memory_order_relaxed);
+        _Result._Failed        = _Failed.load(::std::memory_order_relaxed);
+        return _Result;
+    }
+
+    void _Bm_replay(::benchmark::State& _State, const _Replay_trace& _Trace, allocator& _Al) {
+        ::std::vector<uint32_t> _Latencies;
+        size_t _Peak_resident = 0;
+        size_t _Peak_live     = 0;
+        for (auto _Ux : _State) {
+            _Replay_result _Result = _Replay(_Trace, _Al);
+            if (_Result._Failed) {
+                _State.SkipWithError("the allocator cannot serve the trace");
+                return;
+            }
+
+            _State.SetIterationTime(_Result._Seconds);
+            _Latencies.insert(_Latencies.end(), _Result._Latencies.begin(), _Result._Latencies.end());
+            _Peak_resident = (::std::max)(_Peak_resident, _Result._Peak_resident);
+            _Peak_live     = (::std::max)(_Peak_live, _Result._Peak_live);
+        }
+
+        _State.SetItemsProcessed(_State.iterations() * static_cast<int64_t>(_Trace._Ops.size()));
+        if (_Latencies.empty()) {
+            return;
+        }
+
+        const auto _Percentile = [&_Latencies](const double _Rank) {
+            const size_t _Idx = static_cast<size_t>(_Rank * static_cast<double>(_Latencies.size() - 1));
+            const auto _Nth = _Latencies.begin() + static_cast<ptrdiff_t>(_Idx);
+            ::std::nth_element(_Latencies.begin(), _Nth, _Latencies.end());
+            return static_cast<double>(_Latencies[_Idx]);
+        };
+        _State.counters["p50_ns"]      = _Percentile(0.5);
+        _State.counters["p99_ns"]      = _Percentile(0.99);
+        _State.counters["p999_ns"]     = _Percentile(0.999);
+        _State.counters["peak_rss_mb"] = static_cast<double>(_Peak_resident) / (1024.0 * 1024.0);
+        _State.counters["fragmentation"] =
+            _Peak_live > 0 ? static_cast<double>(_Peak_resident) / static_cast<double>(_Peak_live) : 0.0;
+    }
+} // namespace mjx
+
+int main(int _Argc, char** _Argv) {
+    ::benchmark::Initialize(&_Argc, _Argv);
+    for (int _Idx = 1; _Idx < _Argc; ++_Idx) { // Initialize() leaves the flags it does not recognize
+        if (::strncmp(_Argv[_Idx], "--", 2) == 0) {
+            ::fprintf(stderr, "unrecognized command-line flag: %s\n", _Argv[_Idx]);
+            return 1;
+        }
+    }
+
+    if (_Argc > 2) { // at most one trace can be replayed
+        ::fprintf(stderr, "usage: %s [benchmark options] [trace file]\n", _Argv[0]);
+        return 1;
+    }
+
+    ::std::string _Path;
+    const bool _Synthetic = _Argc <= 1;
+    if (!_Synthetic) { // replay the given trace
+        _Path = _Argv[1];
+    } else { // record a synthetic workload first
+        _Path = (::std::filesystem::temp_directory_path() / "mjxsdk_synthetic_trace").string();
+        if (!::mjx::_Record_synthetic_trace(_Path.c_str())) {
+            ::fprintf(stderr, "cannot record a synthetic trace to %s\n", _Path.c_str());
+            ::std::filesystem::remove(_Path);
+            return 1;
+        }
+    }
+
+    static ::mjx::_Replay_trace _Trace;
+    const bool _Loaded = ::mjx::_Load_trace(_Path.c_str(), _Trace);
+    if (_Synthetic) { // the trace is kept in memory, the file is no longer needed
+        ::std::filesystem::remove(_Path);
+    }
+
+    if (!_Loaded) {
+        ::fprintf(stderr, "%s is not a valid allocation trace\n", _Path.c_str());
+        return 1;
+    }
+
+    static ::mjx::system_allocator _System;
+    static ::mjx::small_object_allocator _Small_object;
+    static ::mjx::thread_cache_allocator _Thread_cache;
+    static ::mjx::memory_resource _Resource(256 * 1024 * 1024);
+    static ::mjx::tlsf_allocator _Tlsf(_Resource);
+    const ::std::pair<const char*, ::mjx::allocator*> _Allocators[] = {{"replay/system_allocator", &_System},
+        {"replay/small_object_allocator", &_Small_object}, {"replay/thread_cache_allocator", &_Thread_cache},
+        {"replay/tlsf_allocator", &_Tlsf}};
+    for (const auto& _Entry : _Allocators) {
+        ::benchmark::RegisterBenchmark(
+            _Entry.first, ::mjx::_Bm_replay, ::std::cref(_Trace), ::std::ref(*_Entry.second))
+            ->UseManualTime()
+            ->Unit(::benchmark::kMillisecond);
+    }
+
+    ::benchmark::RunSpecifiedBenchmarks();
+    ::benchmark::Shutdown();
+    return 0;
+}
\ No newline at end of file
@@ -20,7 +20,7 @@
 #else // ^^^ _MJX_WINDOWS ^^^ / vvv _MJX_LINUX vvv
 #define _REPORT_ERROR(_Fmt, ...)                                               \
     ::fprintf(stderr, "%s:%d: %s: ", __FILE__, __LINE__, __PRETTY_FUNCTION__); \
-    ::fprintf(stderr, _Fmt, __VA_ARGS__);                                      \
+    ::fprintf(stderr, _Fmt __VA_OPT__(, ) __VA_ARGS__);                        \
     ::abort()
 #endif // _MJX_WINDOWS
 
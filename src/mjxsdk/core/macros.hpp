@@ -12,4 +12,18 @@
 #else // ^^^ MSVC ^^^ / vvv Clang or GCC vvv
 #define _MJX_NOVTABLE
 #endif // _MJX_MSVC
+
+#ifdef _MJX_MSVC
+#define _MJX_NOINLINE __declspec(noinline)
+#else // ^^^ MSVC ^^^ / vvv Clang or GCC vvv
+#define _MJX_NOINLINE __attribute__((noinline))
+#endif // _MJX_MSVC
+
+// the address that the current function returns to, identifies its call site
+#ifdef _MJX_MSVC
+#include <intrin.h>
+#define _MJX_RETURN_ADDRESS() _ReturnAddress()
+#else // ^^^ MSVC ^^^ / vvv Clang or GCC vvv
+#define _MJX_RETURN_ADDRESS() __builtin_return_address(0)
+#endif // _MJX_MSVC
 #endif // _MJXSDK_CORE_MACROS_HPP_
\ No newline at end of file
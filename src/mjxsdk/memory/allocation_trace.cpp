@@ -0,0 +1,354 @@
+// allocation_trace.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mjxsdk/memory/allocation_trace.hpp>
+#include <mjxsdk/memory/impl/allocation_hooks.hpp>
+#include <mjxsdk/memory/impl/spin_lock.hpp>
+#include <mutex>
+#include <new>
+#ifdef _MJX_WINDOWS
+#include <mjxsdk/core/impl/tinywin.hpp>
+#else // ^^^ _MJX_WINDOWS ^^^ / vvv _MJX_LINUX vvv
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif // _MJX_WINDOWS
+
+namespace mjx {
+    namespace mjxsdk_impl {
+        class _Trace_file { // trace file mapped into memory
+        public:
+            _Trace_file() noexcept
+#ifdef _MJX_WINDOWS
+                : _Myfile(INVALID_HANDLE_VALUE), _Mymapping(nullptr),
+#else // ^^^ _MJX_WINDOWS ^^^ / vvv _MJX_LINUX vvv
+                : _Myfd(-1),
+#endif // _MJX_WINDOWS
+                _Myview(nullptr), _Mysize(0) {
+            }
+
+            _Trace_file(const _Trace_file&)            = delete;
+            _Trace_file& operator=(const _Trace_file&) = delete;
+
+            unsigned char* _View() const noexcept {
+                return _Myview;
+            }
+
+            size_t _Size() const noexcept {
+                return _Mysize;
+            }
+
+            bool _Open(const char* const _Path, const size_t _Size) noexcept {
+                // creates the file with the given size and maps all of it
+#ifdef _MJX_WINDOWS
+                _Myfile = ::CreateFileA(
+                    _Path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, 0, nullptr);
+                if (_Myfile == INVALID_HANDLE_VALUE) {
+                    return false;
+                }
+
+                const uint64_t _Size64 = _Size;
+                _Mymapping             = ::CreateFileMappingA(_Myfile, nullptr, PAGE_READWRITE,
+                    static_cast<::DWORD>(_Size64 >> 32), static_cast<::DWORD>(_Size64), nullptr);
+                if (_Mymapping) {
+                    _Myview = static_cast<unsigned char*>(::MapViewOfFile(_Mymapping, FILE_MAP_WRITE, 0, 0, _Size));
+                }
+#else // ^^^ _MJX_WINDOWS ^^^ / vvv _MJX_LINUX vvv
+                _Myfd = ::open(_Path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+                if (_Myfd < 0) {
+                    return false;
+                }
+
+                if (::ftruncate(_Myfd, static_cast<off_t>(_Size)) == 0) {
+                    void* const _View = ::mmap(nullptr, _Size, PROT_READ | PROT_WRITE, MAP_SHARED, _Myfd, 0);
+                    _Myview           = _View != MAP_FAILED ? static_cast<unsigned char*>(_View) : nullptr;
+                }
+#endif // _MJX_WINDOWS
+
+                if (!_Myview) { // the file cannot be mapped, remove what was created
+                    _Close(0);
+                    ::remove(_Path);
+                    return false;
+                }
+
+                _Mysize = _Size;
+                return true;
+            }
+
+            void _Close(const size_t _Used) noexcept {
+                // unmaps the file and trims it to the used bytes
+#ifdef _MJX_WINDOWS
+                if (_Myview) {
+                    ::UnmapViewOfFile(_Myview);
+                }
+
+                if (_Mymapping) {
+                    ::CloseHandle(_Mymapping);
+                }
+
+                if (_Myfile != INVALID_HANDLE_VALUE) {
+                    ::LARGE_INTEGER _End;
+                    _End.QuadPart = static_cast<::LONGLONG>(_Used);
+                    ::SetFilePointerEx(_Myfile, _End, nullptr, FILE_BEGIN);
+                    ::SetEndOfFile(_Myfile);
+                    ::CloseHandle(_Myfile);
+                }
+
+                _Myfile    = INVALID_HANDLE_VALUE;
+                _Mymapping = nullptr;
+#else // ^^^ _MJX_WINDOWS ^^^ / vvv _MJX_LINUX vvv
+                if (_Myview) {
+                    ::munmap(_Myview, _Mysize);
+                }
+
+                if (_Myfd >= 0) {
+                    static_cast<void>(::ftruncate(_Myfd, static_cast<off_t>(_Used)));
+                    ::close(_Myfd);
+                }
+
+                _Myfd = -1;
+#endif // _MJX_WINDOWS
+                _Myview = nullptr;
+                _Mysize = 0;
+            }
+
+        private:
+#ifdef _MJX_WINDOWS
+            ::HANDLE _Myfile;
+            ::HANDLE _Mymapping;
+#else // ^^^ _MJX_WINDOWS ^^^ / vvv _MJX_LINUX vvv
+            int _Myfd;
+#endif // _MJX_WINDOWS
+            unsigned char* _Myview;
+            size_t _Mysize;
+        };
+
+        struct _Trace_buffer { // events recorded by a single thread, copied to the file once it fills up
+            static constexpr size_t _Capacity = 256;
+
+            _Spin_lock _Lock; // taken by the owner while recording and by the recorder while stopping
+            uint64_t _Session; // the recording that the buffered events belong to
+            size_t _Count;
+            uint32_t _Thread;
+            _Trace_buffer* _Prev;
+            _Trace_buffer* _Next;
+            trace_event _Events[_Capacity];
+        };
+
+        class _Trace_recorder {
+        public:
+            _Trace_recorder() noexcept
+                : _Mymtx(), _Myfile(), _Myoffset(0), _Mydropped(0), _Mysession(0), _Mystart(0), _Myactive(false),
+                _Mybuffers_lock(), _Mybuffers(nullptr), _Mythreads(0) {}
+
+            _Trace_recorder(const _Trace_recorder&)            = delete;
+            _Trace_recorder& operator=(const _Trace_recorder&) = delete;
+
+            static _Trace_recorder& _Instance() noexcept {
+                // never destroyed, blocks may still be deallocated during static destruction
+                static _Trace_recorder* const _Obj = new _Trace_recorder();
+                return *_Obj;
+            }
+
+            bool _Start(const char* const _Path, const size_t _File_size) noexcept {
+                ::std::lock_guard<::std::mutex> _Guard(_Mymtx);
+                if (_Myactive || _File_size < sizeof(trace_file_header) || !_Myfile._Open(_Path, _File_size)) {
+                    return false;
+                }
+
+                _Myoffset  = sizeof(trace_file_header);
+                _Mydropped = 0;
+                _Mystart.store(_Now(), ::std::memory_order_relaxed);
+                _Mysession.fetch_add(1, ::std::memory_order_relaxed); // invalidates events of the previous recording
+                _Myactive = true;
+                _Enable_allocation_hook(_Allocation_trace_hook);
+                return true;
+            }
+
+            void _Stop() noexcept {
+                _Disable_allocation_hook(_Allocation_trace_hook);
+                {
+                    // copy the events that are still buffered, the order of locks matches _Record()
+                    ::std::lock_guard<_Spin_lock> _Guard(_Mybuffers_lock);
+                    for (_Trace_buffer* _Buf = _Mybuffers; _Buf; _Buf = _Buf->_Next) {
+                        ::std::lock_guard<_Spin_lock> _Buf_guard(_Buf->_Lock);
+                        _Flush(*_Buf);
+                    }
+                }
+
+                ::std::lock_guard<::std::mutex> _Guard(_Mymtx);
+                if (!_Myactive) {
+                    return;
+                }
+
+                trace_file_header _Header;
+                ::memcpy(_Header.magic, "MJXTRACE", sizeof(_Header.magic));
+                _Header.version       = trace_format_version;
+                _Header.event_size    = sizeof(trace_event);
+                _Header.event_count   = (_Myoffset - sizeof(trace_file_header)) / sizeof(trace_event);
+                _Header.dropped_count = _Mydropped;
+                ::memcpy(_Myfile._View(), &_Header, sizeof(trace_file_header));
+                _Myfile._Close(_Myoffset);
+                _Mysession.fetch_add(1, ::std::memory_order_relaxed);
+                _Myactive = false;
+            }
+
+            void _Record(const trace_event_kind _Kind, const void* const _Ptr, const size_t _Size,
+                const size_t _Align, const allocator_tag _Tag) noexcept;
+
+            void _Release_buffer(_Trace_buffer* const _Buf) noexcept {
+                // copies the events of an exiting thread and forgets its buffer
+                ::std::lock_guard<_Spin_lock> _Guard(_Mybuffers_lock);
+                {
+                    ::std::lock_guard<_Spin_lock> _Buf_guard(_Buf->_Lock);
+                    _Flush(*_Buf);
+                }
+
+                (_Buf->_Prev ? _Buf->_Prev->_Next : _Mybuffers) = _Buf->_Next;
+                if (_Buf->_Next) {
+                    _Buf->_Next->_Prev = _Buf->_Prev;
+                }
+
+                ::free(_Buf);
+            }
+
+        private:
+            static uint64_t _Now() noexcept {
+                const auto _Time = ::std::chrono::steady_clock::now().time_since_epoch();
+                return static_cast<uint64_t>(::std::chrono::duration_cast<::std::chrono::nanoseconds>(_Time).count());
+            }
+
+            _Trace_buffer* _Acquire_buffer() noexcept;
+
+            void _Flush(_Trace_buffer& _Buf) noexcept {
+                // copies the buffered events to the file, the buffer must be locked
+                ::std::lock_guard<::std::mutex> _Guard(_Mymtx);
+                if (_Myactive && _Buf._Session == _Mysession.load(::std::memory_order_relaxed)) {
+                    const size_t _Available = (_Myfile._Size() - _Myoffset) / sizeof(trace_event);
+                    const size_t _Count     = _Buf._Count < _Available ? _Buf._Count : _Available;
+                    ::memcpy(_Myfile._View() + _Myoffset, _Buf._Events, _Count * sizeof(trace_event));
+                    _Myoffset += _Count * sizeof(trace_event);
+                    _Mydropped += _Buf._Count - _Count;
+                }
+
+                _Buf._Count = 0;
+            }
+
+            ::std::mutex _Mymtx; // guards the file
+            _Trace_file _Myfile;
+            size_t _Myoffset; // the offset of the next event in the file
+            uint64_t _Mydropped;
+            ::std::atomic<uint64_t> _Mysession;
+            ::std::atomic<uint64_t> _Mystart;
+            bool _Myactive;
+            _Spin_lock _Mybuffers_lock;
+            _Trace_buffer* _Mybuffers; // the buffers of the threads that recorded events
+            ::std::atomic<uint32_t> _Mythreads;
+        };
+
+        thread_local _Trace_buffer* _Thread_trace_buffer = nullptr;
+
+        // set once the thread's buffer was released, later events of the thread are not recorded
+        thread_local bool _Thread_trace_finished = false;
+
+        struct _Thread_trace_cleanup { // releases the buffer of an exiting thread
+            ~_Thread_trace_cleanup() noexcept {
+                _Thread_trace_finished = true;
+                if (_Thread_trace_buffer) {
+                    _Trace_recorder::_Instance()._Release_buffer(_Thread_trace_buffer);
+                    _Thread_trace_buffer = nullptr;
+                }
+            }
+        };
+
+        thread_local _Thread_trace_cleanup _Thread_trace_cleaner;
+
+        _Trace_buffer* _Trace_recorder::_Acquire_buffer() noexcept {
+            // creates the calling thread's buffer, the C heap is never traced
+            _Trace_buffer* const _Buf = static_cast<_Trace_buffer*>(::malloc(sizeof(_Trace_buffer)));
+            if (!_Buf) {
+                return nullptr;
+            }
+
+            ::new (static_cast<void*>(&_Buf->_Lock)) _Spin_lock();
+            _Buf->_Session = 0;
+            _Buf->_Count   = 0;
+            _Buf->_Thread  = _Mythreads.fetch_add(1, ::std::memory_order_relaxed) + 1;
+            _Buf->_Prev    = nullptr;
+            {
+                ::std::lock_guard<_Spin_lock> _Guard(_Mybuffers_lock);
+                _Buf->_Next = _Mybuffers;
+                if (_Mybuffers) {
+                    _Mybuffers->_Prev = _Buf;
+                }
+
+                _Mybuffers = _Buf;
+            }
+
+            static_cast<void>(&_Thread_trace_cleaner); // constructs the cleanup object of the thread
+            _Thread_trace_buffer = _Buf;
+            return _Buf;
+        }
+
+        void _Trace_recorder::_Record(const trace_event_kind _Kind, const void* const _Ptr, const size_t _Size,
+            const size_t _Align, const allocator_tag _Tag) noexcept {
+            if (_Thread_trace_finished) { // the thread is exiting
+                return;
+            }
+
+            _Trace_buffer* _Buf = _Thread_trace_buffer;
+            if (!_Buf) { // first event of the thread
+                _Buf = _Acquire_buffer();
+                if (!_Buf) {
+                    return;
+                }
+            }
+
+            const uint64_t _Session = _Mysession.load(::std::memory_order_relaxed);
+            const uint64_t _Time    = _Now() - _Mystart.load(::std::memory_order_relaxed);
+            ::std::lock_guard<_Spin_lock> _Guard(_Buf->_Lock);
+            if (_Buf->_Session != _Session) { // the buffered events belong to a previous recording
+                _Buf->_Session = _Session;
+                _Buf->_Count   = 0;
+            }
+
+            const uint64_t _Address       = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(_Ptr));
+            const uint8_t _Align_log2     = static_cast<uint8_t>(_Align != 0 ? ::std::countr_zero(_Align) : 0);
+            _Buf->_Events[_Buf->_Count++] =
+                trace_event{_Time, _Address, _Size, _Buf->_Thread, _Align_log2, _Tag, _Kind, 0};
+            if (_Buf->_Count == _Trace_buffer::_Capacity) { // the buffer is full, copy it to the file
+                _Flush(*_Buf);
+            }
+        }
+
+        void _Trace_allocation(
+            void* const _Ptr, const size_t _Size, const size_t _Align, const allocator_tag _Tag) noexcept {
+            _Trace_recorder::_Instance()._Record(trace_event_kind::allocation, _Ptr, _Size, _Align, _Tag);
+        }
+
+        void _Trace_deallocation(
+            void* const _Ptr, const size_t _Size, const size_t _Align, const allocator_tag _Tag) noexcept {
+            _Trace_recorder::_Instance()._Record(trace_event_kind::deallocation, _Ptr, _Size, _Align, _Tag);
+        }
+    } // namespace mjxsdk_impl
+
+    bool start_allocation_trace(const char* const _Path, const size_t _File_size) noexcept {
+        return mjxsdk_impl::_Trace_recorder::_Instance()._Start(_Path, _File_size);
+    }
+
+    void stop_allocation_trace() noexcept {
+        mjxsdk_impl::_Trace_recorder::_Instance()._Stop();
+    }
+
+    bool is_allocation_trace_active() noexcept {
+        return mjxsdk_impl::_Is_allocation_hook_enabled(mjxsdk_impl::_Allocation_trace_hook);
+    }
+} // namespace mjx
\ No newline at end of file
@@ -0,0 +1,60 @@
+// allocation_trace.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _MJXSDK_MEMORY_ALLOCATION_TRACE_HPP_
+#define _MJXSDK_MEMORY_ALLOCATION_TRACE_HPP_
+#include <cstddef>
+#include <cstdint>
+#include <mjxsdk/core/export.hpp>
+#include <mjxsdk/memory/allocator.hpp>
+
+namespace mjx {
+    // the default size of the trace file, including its header
+    inline constexpr size_t default_trace_file_size = 256 * 1024 * 1024;
+
+    // the version of the trace file format
+    inline constexpr uint32_t trace_format_version = 1;
+
+    enum class trace_event_kind : uint8_t {
+        allocation   = 0,
+        deallocation = 1
+    };
+
+    struct trace_file_header { // the beginning of the trace file
+        char magic[8]; // "MJXTRACE"
+        uint32_t version; // trace_format_version
+        uint32_t event_size; // sizeof(trace_event)
+        uint64_t event_count; // the number of events that follow the header
+        uint64_t dropped_count; // the number of events that did not fit in the file
+    };
+
+    struct trace_event { // a single allocation or deallocation, stored in native byte order
+        uint64_t timestamp; // nanoseconds since the recording started
+        uint64_t address;
+        uint64_t size;
+        uint32_t thread; // sequential thread number, starting from 1
+        uint8_t align_log2; // log2 of the alignment, zero for the default alignment
+        allocator_tag tag;
+        trace_event_kind kind;
+        uint8_t reserved;
+    };
+
+    static_assert(sizeof(trace_file_header) == 32, "trace_file_header must have a fixed size");
+    static_assert(sizeof(trace_event) == 32, "trace_event must have a fixed size");
+
+    // Note: The recorder observes every allocator that reports its blocks, see leak_registry.hpp, and tags
+    //       each event with the allocator that handed out the block. Each thread appends events to its own
+    //       ring buffer, which is copied into the memory-mapped trace file whenever it fills up. The buffers
+    //       and the file never come from an allocator. Events of different threads are interleaved in batches,
+    //       sort them by timestamp to restore the global order. Events that do not fit in the file
+    //       are dropped and counted. stop_allocation_trace() flushes every buffer and trims the file.
+    _MJXSDK_EXPORT bool start_allocation_trace(
+        const char* const _Path, const size_t _File_size = default_trace_file_size) noexcept;
+    _MJXSDK_EXPORT void stop_allocation_trace() noexcept;
+    _MJXSDK_EXPORT bool is_allocation_trace_active() noexcept;
+} // namespace mjx
+
+#endif // _MJXSDK_MEMORY_ALLOCATION_TRACE_HPP_
\ No newline at end of file
@@ -3,10 +3,17 @@
 // Copyright (c) Mateusz Jandura. All rights reserved.
 // SPDX-License-Identifier: Apache-2.0
 
+#include <cstring>
+#include <memory>
 #include <mjxsdk/memory/allocator.hpp>
 #include <mjxsdk/memory/impl/global_allocator.hpp>
 
 namespace mjx {
+    namespace mjxsdk_impl {
+        // the allocator of the calling thread's most recent scoped_allocator_override (if any)
+        thread_local allocator* _Thread_allocator_override = nullptr;
+    } // namespace mjxsdk_impl
+
     allocator::allocator() noexcept {}
 
     allocator::allocator(const allocator&) noexcept {}
@@ -23,12 +30,76 @@ namespace mjx {
         return *this;
     }
 
+    void allocator::allocate_bulk(
+        const size_type _Size, const size_type _Align, const size_type _Count, pointer* const _Ptrs) {
+        // allocate each block separately, return the blocks allocated so far on failure
+        size_type _Idx = 0;
+        try {
+            for (; _Idx < _Count; ++_Idx) {
+                _Ptrs[_Idx] = allocate(_Size, _Align);
+            }
+        } catch (...) {
+            while (_Idx > 0) {
+                deallocate(_Ptrs[--_Idx], _Size, _Align);
+            }
+
+            throw;
+        }
+    }
+
+    void allocator::deallocate_bulk(
+        const pointer* const _Ptrs, const size_type _Count, const size_type _Size, const size_type _Align) noexcept {
+        // deallocate each block separately
+        for (size_type _Idx = 0; _Idx < _Count; ++_Idx) {
+            deallocate(_Ptrs[_Idx], _Size, _Align);
+        }
+    }
+
+    bool allocator::try_expand_in_place(
+        const pointer _Ptr, const size_type _Old_size, const size_type _New_size, const size_type) noexcept {
+        // without knowledge of the block's layout, only its current size can be kept
+        return _Ptr && _Old_size == _New_size;
+    }
+
+    allocator::pointer allocator::reallocate(
+        const pointer _Ptr, const size_type _Old_size, const size_type _New_size, const size_type _Align) {
+        if (!_Ptr) { // no block, allocate a new one
+            return allocate(_New_size, _Align);
+        }
+
+        if (_New_size == 0) { // empty block, deallocate the old one
+            deallocate(_Ptr, _Old_size, _Align);
+            return nullptr;
+        }
+
+        if (try_expand_in_place(_Ptr, _Old_size, _New_size, _Align)) { // resized in place, nothing to move
+            return _Ptr;
+        }
+
+        // the old block stays valid if the allocation fails
+        const pointer _New_ptr = allocate(_New_size, _Align);
+        ::memcpy(_New_ptr, _Ptr, _Old_size < _New_size ? _Old_size : _New_size);
+        deallocate(_Ptr, _Old_size, _Align);
+        return _New_ptr;
+    }
+
+    allocation_result allocator::allocate_at_least(const size_type _Size, const size_type _Align) {
+        // allocate the rounded size, so that the whole block can be deallocated with it
+        const size_type _Usable = good_size(_Size, _Align);
+        return {allocate(_Usable, _Align), _Usable};
+    }
+
+    allocator::size_type allocator::good_size(const size_type _Size, const size_type) const noexcept {
+        return _Size; // no rounding is known
+    }
+
     bool operator==(const allocator& _Left, const allocator& _Right) noexcept {
         return _Left.is_equal(_Right);
     }
 
     allocator& get_global_allocator() noexcept {
-        return mjxsdk_impl::_Global_allocator::_Instance()._Get();
+        allocator* const _Override = mjxsdk_impl::_Thread_allocator_override;
+        return _Override ? *_Override : mjxsdk_impl::_Global_allocator::_Instance()._Get();
     }
 
     void set_global_allocator(allocator& _New_al) noexcept {
@@ -38,4 +109,13 @@ namespace mjx {
     void reset_global_allocator() noexcept {
         mjxsdk_impl::_Global_allocator::_Instance()._Reset();
     }
+
+    scoped_allocator_override::scoped_allocator_override(allocator& _Al) noexcept
+        : _Myprev(mjxsdk_impl::_Thread_allocator_override) {
+        mjxsdk_impl::_Thread_allocator_override = ::std::addressof(_Al);
+    }
+
+    scoped_allocator_override::~scoped_allocator_override() noexcept {
+        mjxsdk_impl::_Thread_allocator_override = _Myprev;
+    }
 } // namespace mjx
\ No newline at end of file
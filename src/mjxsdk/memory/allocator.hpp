@@ -13,8 +13,25 @@
 
 namespace mjx {
     enum class allocator_tag : unsigned char {
-        unknown = 0,
-        system  = 1
+        unknown         = 0,
+        system          = 1,
+        monotonic       = 2,
+        pool            = 3,
+        small_object    = 4,
+        thread_cache    = 5,
+        concurrent_pool = 6,
+        buddy           = 7,
+        tlsf            = 8,
+        stack           = 9,
+        fallback        = 10,
+        segregator      = 11,
+        bucketizer      = 12,
+        stats           = 13
+    };
+
+    struct allocation_result { // allocated block with its usable size
+        void* ptr;
+        size_t count;
     };
 
     class _MJXSDK_EXPORT _MJX_NOVTABLE allocator { // base class for all allocators
@@ -39,6 +56,26 @@ namespace mjx {
         // deallocates storage with optional alignment
         virtual void deallocate(pointer _Ptr, size_type _Size, size_type _Align = 0) noexcept = 0;
 
+        // allocates _Count blocks of the same size and alignment, either all or none
+        virtual void allocate_bulk(size_type _Size, size_type _Align, size_type _Count, pointer* _Ptrs);
+
+        // deallocates _Count blocks that were allocated with the same size and alignment
+        virtual void deallocate_bulk(
+            const pointer* _Ptrs, size_type _Count, size_type _Size, size_type _Align = 0) noexcept;
+
+        // resizes the block without moving it, returns false if that is not possible
+        virtual bool try_expand_in_place(
+            pointer _Ptr, size_type _Old_size, size_type _New_size, size_type _Align = 0) noexcept;
+
+        // resizes the block, moves its contents to a new block if it cannot be resized in place
+        virtual pointer reallocate(pointer _Ptr, size_type _Old_size, size_type _New_size, size_type _Align = 0);
+
+        // allocates at least _Size bytes, the block may then be used and deallocated with the returned size
+        virtual allocation_result allocate_at_least(size_type _Size, size_type _Align = 0);
+
+        // returns the size of the block that would be allocated for a request of _Size bytes
+        virtual size_type good_size(size_type _Size, size_type _Align = 0) const noexcept;
+
         // returns the tag that identifies the allocator type
         virtual allocator_tag tag() const noexcept = 0;
 
@@ -60,9 +97,37 @@ namespace mjx {
     template <class _Alloc>
     concept compatible_allocator = is_compatible_allocator_v<_Alloc>;
 
+    // Note: A final allocator cannot be the base of another type, so a reference to it always refers
+    //       to an object of exactly that type. Its member functions can then be called directly,
+    //       without going through the virtual table, and inlined if their definitions are visible.
+    template <class _Alloc>
+    inline constexpr bool is_static_allocator_v =
+        is_compatible_allocator_v<_Alloc> && ::std::is_final_v<_Alloc>;
+
+    template <class _Alloc>
+    struct is_static_allocator : ::std::bool_constant<is_static_allocator_v<_Alloc>> {};
+
+    template <class _Alloc>
+    concept static_allocator = is_static_allocator_v<_Alloc>;
+
     _MJXSDK_EXPORT allocator& get_global_allocator() noexcept;
     _MJXSDK_EXPORT void set_global_allocator(allocator& _New_al) noexcept;
     _MJXSDK_EXPORT void reset_global_allocator() noexcept;
+
+    // Note: While an override is alive, get_global_allocator() returns its allocator on the calling thread,
+    //       other threads are not affected. Overrides nest, the most recent one wins. Blocks obtained
+    //       through an override must be deallocated before it ends, just as with set_global_allocator().
+    class _MJXSDK_EXPORT scoped_allocator_override { // redirects the calling thread's global allocator
+    public:
+        explicit scoped_allocator_override(allocator& _Al) noexcept;
+        ~scoped_allocator_override() noexcept;
+
+        scoped_allocator_override(const scoped_allocator_override&)            = delete;
+        scoped_allocator_override& operator=(const scoped_allocator_override&) = delete;
+
+    private:
+        allocator* _Myprev; // the override that was active before this one (if any)
+    };
 } // namespace mjx
 
 #endif // _MJXSDK_MEMORY_ALLOCATOR_HPP_
\ No newline at end of file
@@ -0,0 +1,368 @@
+// allocator_composition.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _MJXSDK_MEMORY_ALLOCATOR_COMPOSITION_HPP_
+#define _MJXSDK_MEMORY_ALLOCATOR_COMPOSITION_HPP_
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <mjxsdk/memory/allocator.hpp>
+#include <mjxsdk/memory/exception.hpp>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// Note: The templates below combine allocators at compile time. Each composed allocator derives from
+//       mjx::allocator, so the outermost layer can be used wherever an allocator is expected, but the layers
+//       call each other through qualified names, which bypasses the virtual dispatch between them.
+namespace mjx {
+    template <class _Alloc>
+    concept owning_allocator = compatible_allocator<_Alloc>
+        && requires(const _Alloc& _Al, allocator::const_pointer _Ptr, allocator::size_type _Size) {
+            { _Al.contains(_Ptr, _Size) } noexcept -> ::std::same_as<bool>;
+        };
+
+    template <owning_allocator _Primary, compatible_allocator _Fallback>
+    class fallback_allocator final : public allocator { // uses _Fallback when _Primary fails
+    public:
+        using value_type      = allocator::value_type;
+        using size_type       = allocator::size_type;
+        using difference_type = allocator::difference_type;
+        using pointer         = allocator::pointer;
+        using const_pointer   = allocator::const_pointer;
+        using primary_type    = _Primary;
+        using fallback_type   = _Fallback;
+
+        fallback_allocator() : _Myprimary(), _Myfallback() {}
+
+        template <class... _Types1, class... _Types2>
+        fallback_allocator(::std::piecewise_construct_t, ::std::tuple<_Types1...> _Primary_args,
+            ::std::tuple<_Types2...> _Fallback_args)
+            : _Myprimary(::std::make_from_tuple<_Primary>(::std::move(_Primary_args))),
+            _Myfallback(::std::make_from_tuple<_Fallback>(::std::move(_Fallback_args))) {}
+
+        fallback_allocator(const fallback_allocator&)            = delete;
+        fallback_allocator& operator=(const fallback_allocator&) = delete;
+
+        // allocates from the primary allocator, or from the fallback allocator if the primary one fails
+        pointer allocate(size_type _Size, size_type _Align = 0) override {
+            try {
+                return _Myprimary._Primary::allocate(_Size, _Align);
+            } catch (const allocation_limit_exceeded&) {
+                // the primary allocator is exhausted, try the fallback allocator
+            } catch (const allocation_failure&) {
+                // the primary allocator cannot serve the request, try the fallback allocator
+            }
+
+            return _Myfallback._Fallback::allocate(_Size, _Align);
+        }
+
+        // returns the block to the allocator that owns it
+        void deallocate(pointer _Ptr, size_type _Size, size_type _Align = 0) noexcept override {
+            if (_Myprimary.contains(_Ptr, _Size)) {
+                _Myprimary._Primary::deallocate(_Ptr, _Size, _Align);
+            } else {
+                _Myfallback._Fallback::deallocate(_Ptr, _Size, _Align);
+            }
+        }
+
+        // returns the tag that identifies the allocator type
+        allocator_tag tag() const noexcept override {
+            return allocator_tag::fallback;
+        }
+
+        // returns the largest supported allocation size
+        size_type max_size() const noexcept override {
+            const size_type _Primary_max  = _Myprimary._Primary::max_size();
+            const size_type _Fallback_max = _Myfallback._Fallback::max_size();
+            return _Primary_max > _Fallback_max ? _Primary_max : _Fallback_max;
+        }
+
+        // compares for equality with another allocator
+        bool is_equal(const allocator& _Other) const noexcept override {
+            // stateful allocator, equal only to itself
+            return this == ::std::addressof(_Other);
+        }
+
+        // checks whether the memory block comes from either allocator
+        bool contains(const_pointer _Ptr, const size_type _Size) const noexcept
+            requires owning_allocator<_Fallback>
+        {
+            return _Myprimary.contains(_Ptr, _Size) || _Myfallback.contains(_Ptr, _Size);
+        }
+
+        // returns the primary allocator
+        _Primary& primary() noexcept {
+            return _Myprimary;
+        }
+
+        const _Primary& primary() const noexcept {
+            return _Myprimary;
+        }
+
+        // returns the fallback allocator
+        _Fallback& fallback() noexcept {
+            return _Myfallback;
+        }
+
+        const _Fallback& fallback() const noexcept {
+            return _Myfallback;
+        }
+
+    private:
+        _Primary _Myprimary;
+        _Fallback _Myfallback;
+    };
+
+    template <size_t _Threshold, compatible_allocator _Small, compatible_allocator _Large>
+    class segregator final : public allocator { // splits requests by size at _Threshold
+    public:
+        using value_type      = allocator::value_type;
+        using size_type       = allocator::size_type;
+        using difference_type = allocator::difference_type;
+        using pointer         = allocator::pointer;
+        using const_pointer   = allocator::const_pointer;
+        using small_type      = _Small;
+        using large_type      = _Large;
+
+        // the largest size served by the small allocator
+        static constexpr size_type threshold = _Threshold;
+
+        segregator() : _Mysmall(), _Mylarge() {}
+
+        template <class... _Types1, class... _Types2>
+        segregator(::std::piecewise_construct_t, ::std::tuple<_Types1...> _Small_args,
+            ::std::tuple<_Types2...> _Large_args)
+            : _Mysmall(::std::make_from_tuple<_Small>(::std::move(_Small_args))),
+            _Mylarge(::std::make_from_tuple<_Large>(::std::move(_Large_args))) {}
+
+        segregator(const segregator&)            = delete;
+        segregator& operator=(const segregator&) = delete;
+
+        // allocates from the allocator selected by the requested size
+        pointer allocate(size_type _Size, size_type _Align = 0) override {
+            if (_Size <= _Threshold) {
+                return _Mysmall._Small::allocate(_Size, _Align);
+            } else {
+                return _Mylarge._Large::allocate(_Size, _Align);
+            }
+        }
+
+        // returns the block to the allocator selected by its size
+        void deallocate(pointer _Ptr, size_type _Size, size_type _Align = 0) noexcept override {
+            if (_Size <= _Threshold) {
+                _Mysmall._Small::deallocate(_Ptr, _Size, _Align);
+            } else {
+                _Mylarge._Large::deallocate(_Ptr, _Size, _Align);
+            }
+        }
+
+        // forwards the whole batch to the allocator selected by the requested size
+        void allocate_bulk(size_type _Size, size_type _Align, size_type _Count, pointer* _Ptrs) override {
+            if (_Size <= _Threshold) {
+                _Mysmall._Small::allocate_bulk(_Size, _Align, _Count, _Ptrs);
+            } else {
+                _Mylarge._Large::allocate_bulk(_Size, _Align, _Count, _Ptrs);
+            }
+        }
+
+        // returns the whole batch to the allocator selected by its size
+        void deallocate_bulk(
+            const pointer* _Ptrs, size_type _Count, size_type _Size, size_type _Align = 0) noexcept override {
+            if (_Size <= _Threshold) {
+                _Mysmall._Small::deallocate_bulk(_Ptrs, _Count, _Size, _Align);
+            } else {
+                _Mylarge._Large::deallocate_bulk(_Ptrs, _Count, _Size, _Align);
+            }
+        }
+
+        // returns the tag that identifies the allocator type
+        allocator_tag tag() const noexcept override {
+            return allocator_tag::segregator;
+        }
+
+        // returns the largest supported allocation size
+        size_type max_size() const noexcept override {
+            const size_type _Small_max = _Mysmall._Small::max_size();
+            const size_type _Large_max = _Mylarge._Large::max_size();
+            if (_Large_max > _Threshold) { // sizes above the threshold are limited by the large allocator
+                return _Large_max;
+            }
+
+            return _Small_max < _Threshold ? _Small_max : _Threshold;
+        }
+
+        // compares for equality with another allocator
+        bool is_equal(const allocator& _Other) const noexcept override {
+            // stateful allocator, equal only to itself
+            return this == ::std::addressof(_Other);
+        }
+
+        // checks whether the memory block comes from the allocator selected by its size
+        bool contains(const_pointer _Ptr, const size_type _Size) const noexcept
+            requires owning_allocator<_Small> && owning_allocator<_Large>
+        {
+            return _Size <= _Threshold ? _Mysmall.contains(_Ptr, _Size) : _Mylarge.contains(_Ptr, _Size);
+        }
+
+        // returns the allocator that serves small sizes
+        _Small& small() noexcept {
+            return _Mysmall;
+        }
+
+        const _Small& small() const noexcept {
+            return _Mysmall;
+        }
+
+        // returns the allocator that serves large sizes
+        _Large& large() noexcept {
+            return _Mylarge;
+        }
+
+        const _Large& large() const noexcept {
+            return _Mylarge;
+        }
+
+    private:
+        _Small _Mysmall;
+        _Large _Mylarge;
+    };
+
+    template <compatible_allocator _Alloc, size_t _Min, size_t _Max, size_t _Step>
+    class bucketizer final : public allocator { // buckets of sizes in (_Min, _Max], _Step apart
+    public:
+        static_assert(_Step > 0 && _Min < _Max, "the size range must not be empty");
+        static_assert((_Max - _Min) % _Step == 0, "the size range must be a multiple of the step");
+
+        using value_type      = allocator::value_type;
+        using size_type       = allocator::size_type;
+        using difference_type = allocator::difference_type;
+        using pointer         = allocator::pointer;
+        using const_pointer   = allocator::const_pointer;
+        using bucket_type     = _Alloc;
+
+        // the number of buckets, each one serves _Step consecutive sizes
+        static constexpr size_type bucket_count = (_Max - _Min) / _Step;
+
+        // Note: Each bucket is constructed with the largest size it serves followed by _Args if _Alloc
+        //       accepts such arguments (e.g., pool_allocator), otherwise with _Args alone. Every bucket
+        //       receives the same arguments, so they are always passed as lvalues and never moved from.
+        //       A bucketizer is not an argument, the copy constructor stays deleted.
+        template <class... _Types>
+            requires (!::std::is_same_v<::std::remove_cvref_t<_Types>, bucketizer> && ...)
+        explicit bucketizer(_Types&&... _Args)
+            : bucketizer(::std::make_index_sequence<bucket_count>{}, _Args...) {}
+
+        bucketizer(const bucketizer&)            = delete;
+        bucketizer& operator=(const bucketizer&) = delete;
+
+        // allocates from the bucket that serves the requested size
+        pointer allocate(size_type _Size, size_type _Align = 0) override {
+            if (_Size == 0) { // no allocation, do nothing
+                return nullptr;
+            }
+
+            if (_Size <= _Min || _Size > _Max) { // no bucket serves the requested size, raise an exception
+                allocation_limit_exceeded::raise();
+            }
+
+            return _Mybuckets[_Get_bucket_index(_Size)]._Alloc::allocate(_Size, _Align);
+        }
+
+        // returns the block to the bucket that serves its size
+        void deallocate(pointer _Ptr, size_type _Size, size_type _Align = 0) noexcept override {
+            if (!_Ptr || _Size <= _Min || _Size > _Max) { // invalid block, break
+                return;
+            }
+
+            _Mybuckets[_Get_bucket_index(_Size)]._Alloc::deallocate(_Ptr, _Size, _Align);
+        }
+
+        // forwards the whole batch to the bucket that serves the requested size
+        void allocate_bulk(size_type _Size, size_type _Align, size_type _Count, pointer* _Ptrs) override {
+            if (_Size == 0) { // no allocation, fill with null pointers
+                ::std::fill_n(_Ptrs, _Count, nullptr);
+                return;
+            }
+
+            if (_Size <= _Min || _Size > _Max) { // no bucket serves the requested size, raise an exception
+                allocation_limit_exceeded::raise();
+            }
+
+            _Mybuckets[_Get_bucket_index(_Size)]._Alloc::allocate_bulk(_Size, _Align, _Count, _Ptrs);
+        }
+
+        // returns the whole batch to the bucket that serves its size
+        void deallocate_bulk(
+            const pointer* _Ptrs, size_type _Count, size_type _Size, size_type _Align = 0) noexcept override {
+            if (_Size <= _Min || _Size > _Max) { // invalid blocks, break
+                return;
+            }
+
+            _Mybuckets[_Get_bucket_index(_Size)]._Alloc::deallocate_bulk(_Ptrs, _Count, _Size, _Align);
+        }
+
+        // returns the tag that identifies the allocator type
+        allocator_tag tag() const noexcept override {
+            return allocator_tag::bucketizer;
+        }
+
+        // returns the largest supported allocation size
+        size_type max_size() const noexcept override {
+            return _Max;
+        }
+
+        // compares for equality with another allocator
+        bool is_equal(const allocator& _Other) const noexcept override {
+            // stateful allocator, equal only to itself
+            return this == ::std::addressof(_Other);
+        }
+
+        // checks whether the memory block comes from the bucket that serves its size
+        bool contains(const_pointer _Ptr, const size_type _Size) const noexcept
+            requires owning_allocator<_Alloc>
+        {
+            if (_Size <= _Min || _Size > _Max) { // no bucket serves the size
+                return false;
+            }
+
+            return _Mybuckets[_Get_bucket_index(_Size)].contains(_Ptr, _Size);
+        }
+
+        // returns the bucket with the given index
+        _Alloc& bucket(const size_type _Idx) noexcept {
+            return _Mybuckets[_Idx];
+        }
+
+        const _Alloc& bucket(const size_type _Idx) const noexcept {
+            return _Mybuckets[_Idx];
+        }
+
+    private:
+        template <size_t... _Indices, class... _Types>
+        bucketizer(::std::index_sequence<_Indices...>, _Types&... _Args)
+            : _Mybuckets{{_Make_bucket<_Indices>(_Args...)...}} {}
+
+        template <size_t _Idx, class... _Types>
+        static _Alloc _Make_bucket(_Types&... _Args) {
+            constexpr size_type _Bucket_size = _Min + (_Idx + 1) * _Step;
+            if constexpr (::std::is_constructible_v<_Alloc, size_type, _Types&...>) {
+                return _Alloc(_Bucket_size, _Args...);
+            } else {
+                return _Alloc(_Args...);
+            }
+        }
+
+        static constexpr size_type _Get_bucket_index(const size_type _Size) noexcept {
+            return (_Size - _Min - 1) / _Step;
+        }
+
+        ::std::array<_Alloc, bucket_count> _Mybuckets;
+    };
+} // namespace mjx
+
+#endif // _MJXSDK_MEMORY_ALLOCATOR_COMPOSITION_HPP_
\ No newline at end of file
@@ -0,0 +1,215 @@
+// buddy_allocator.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <bit>
+#include <cstring>
+#include <mjxsdk/core/impl/utils.hpp>
+#include <mjxsdk/core/macros.hpp>
+#include <mjxsdk/memory/buddy_allocator.hpp>
+#include <mjxsdk/memory/exception.hpp>
+#include <mjxsdk/memory/impl/allocation_hooks.hpp>
+#include <mjxsdk/memory/impl/global_allocator.hpp>
+#include <mjxsdk/memory/impl/utils.hpp>
+#include <mjxsdk/memory/object.hpp>
+#include <utility>
+
+namespace mjx {
+    struct buddy_allocator::_Free_block { // free block that stores both links in-place
+        _Free_block* _Prev;
+        _Free_block* _Next;
+    };
+
+    buddy_allocator::buddy_allocator(memory_resource& _Resource, const size_type _Min_block_size)
+        : _Mybase(nullptr), _Mycapacity(0),
+        _Mymin_block(::std::bit_ceil(_Min_block_size > default_min_block_size ? _Min_block_size
+                                                                              : default_min_block_size)),
+        _Mybase_align(0), _Myorder_count(0), _Myfree_mask(0), _Myfree{}, _Myorders(nullptr) {
+        if (_Resource.size() < _Mymin_block) { // the resource cannot hold even the smallest block
+            return;
+        }
+
+        // Note: Blocks are offsets from the aligned beginning of the resource, so a block of a given order
+        //       is aligned to its own size as long as the beginning is aligned at least as much.
+        void* const _End = mjxsdk_impl::_Adjust_address_by_offset(_Resource.data(), _Resource.size());
+        _Mybase          = mjxsdk_impl::_Align_address(_Resource.data(), _Mymin_block);
+        if (_Mybase >= _End || mjxsdk_impl::_Distance_between(_Mybase, _End) < _Mymin_block) {
+            _Mybase = nullptr;
+            return;
+        }
+
+        const uintptr_t _Address = reinterpret_cast<uintptr_t>(_Mybase);
+        _Mycapacity              = ::std::bit_floor(mjxsdk_impl::_Distance_between(_Mybase, _End));
+        _Mybase_align            = static_cast<size_type>(_Address & (~_Address + 1));
+        _Myorder_count           = static_cast<size_type>(::std::countr_zero(_Mycapacity / _Mymin_block)) + 1;
+        _Myorders                = ::mjx::allocate_object_array_using_allocator<unsigned char>(
+            _Mycapacity / _Mymin_block, mjxsdk_impl::_Get_internal_allocator());
+        release();
+    }
+
+    buddy_allocator::~buddy_allocator() noexcept {
+        if (_Myorders) {
+            ::mjx::deallocate_object_array_using_allocator(
+                _Myorders, _Mycapacity / _Mymin_block, mjxsdk_impl::_Get_internal_allocator());
+        }
+    }
+
+    buddy_allocator::size_type buddy_allocator::_Get_order(
+        const size_type _Size, const size_type _Align) const noexcept {
+        // the block must be large enough for the size, and as large as the alignment so that it starts
+        // at an aligned offset
+        size_type _Block_size = _Size > _Align ? _Size : _Align;
+        if (_Block_size <= _Mymin_block) {
+            return 0;
+        }
+
+        _Block_size = ::std::bit_ceil(_Block_size);
+        return static_cast<size_type>(::std::countr_zero(_Block_size / _Mymin_block));
+    }
+
+    buddy_allocator::size_type buddy_allocator::_Get_block_index(const void* const _Ptr) const noexcept {
+        return mjxsdk_impl::_Distance_between(_Mybase, _Ptr) / _Mymin_block;
+    }
+
+    void* buddy_allocator::_Get_block_address(const size_type _Idx) const noexcept {
+        return mjxsdk_impl::_Adjust_address_by_offset(_Mybase, _Idx * _Mymin_block);
+    }
+
+    void buddy_allocator::_Push_free_block(const size_type _Idx, const size_type _Order) noexcept {
+        _Free_block* const _Block = static_cast<_Free_block*>(_Get_block_address(_Idx));
+        _Block->_Prev             = nullptr;
+        _Block->_Next             = _Myfree[_Order];
+        if (_Myfree[_Order]) {
+            _Myfree[_Order]->_Prev = _Block;
+        }
+
+        _Myfree[_Order] = _Block;
+        _Myfree_mask |= size_type{1} << _Order;
+        _Myorders[_Idx] = static_cast<unsigned char>(_Order + 1);
+    }
+
+    void buddy_allocator::_Remove_free_block(const size_type _Idx, const size_type _Order) noexcept {
+        _Free_block* const _Block = static_cast<_Free_block*>(_Get_block_address(_Idx));
+        if (_Block->_Prev) {
+            _Block->_Prev->_Next = _Block->_Next;
+        } else { // the block is the head of the list
+            _Myfree[_Order] = _Block->_Next;
+            if (!_Myfree[_Order]) { // no more free blocks of this order
+                _Myfree_mask &= ~(size_type{1} << _Order);
+            }
+        }
+
+        if (_Block->_Next) {
+            _Block->_Next->_Prev = _Block->_Prev;
+        }
+
+        _Myorders[_Idx] = 0;
+    }
+
+    buddy_allocator::pointer buddy_allocator::allocate(size_type _Size, size_type _Align) {
+        if (_Size == 0) { // no allocation, do nothing
+            return nullptr;
+        }
+
+        _Align = mjxsdk_impl::_Get_effective_alignment(_Align);
+        if (_Size > _Mycapacity || _Align > _Mycapacity) { // no block can hold the requested size
+            allocation_limit_exceeded::raise();
+        }
+
+        if (_Align > _Mybase_align) { // the region cannot guarantee the requested alignment
+            allocation_failure::raise();
+        }
+
+        // find the smallest order that has a free block and is large enough for the request
+        const size_type _Order     = _Get_order(_Size, _Align);
+        const size_type _Available = _Myfree_mask >> _Order;
+        if (_Available == 0) { // no free block is large enough, raise an exception
+            allocation_limit_exceeded::raise();
+        }
+
+        size_type _Found_order = _Order + static_cast<size_type>(::std::countr_zero(_Available));
+        const size_type _Idx   = _Get_block_index(_Myfree[_Found_order]);
+        _Remove_free_block(_Idx, _Found_order);
+        while (_Found_order > _Order) { // split the block, the upper half becomes a free buddy
+            --_Found_order;
+            _Push_free_block(_Idx + (size_type{1} << _Found_order), _Found_order);
+        }
+
+        void* const _Ptr = _Get_block_address(_Idx);
+        mjxsdk_impl::_Report_allocation(_Ptr, _Size, _Align, allocator_tag::buddy, _MJX_RETURN_ADDRESS());
+        return _Ptr;
+    }
+
+    void buddy_allocator::deallocate(pointer _Ptr, size_type _Size, size_type _Align) noexcept {
+        if (!_Ptr || _Size == 0) { // invalid block, break
+            return;
+        }
+
+        mjxsdk_impl::_Report_deallocation(_Ptr, _Size, _Align, allocator_tag::buddy);
+        size_type _Order = _Get_order(_Size, mjxsdk_impl::_Get_effective_alignment(_Align));
+        size_type _Idx   = _Get_block_index(_Ptr);
+        while (_Order + 1 < _Myorder_count) { // merge with the buddy as long as it is free
+            const size_type _Buddy = _Idx ^ (size_type{1} << _Order);
+            if (_Myorders[_Buddy] != _Order + 1) { // the buddy is allocated or split, break
+                break;
+            }
+
+            _Remove_free_block(_Buddy, _Order);
+            _Idx = _Idx < _Buddy ? _Idx : _Buddy;
+            ++_Order;
+        }
+
+        _Push_free_block(_Idx, _Order);
+    }
+
+    buddy_allocator::size_type buddy_allocator::good_size(size_type _Size, size_type _Align) const noexcept {
+        if (_Size == 0 || _Size > _Mycapacity) { // no block can serve the request
+            return _Size;
+        }
+
+        return _Mymin_block << _Get_order(_Size, mjxsdk_impl::_Get_effective_alignment(_Align));
+    }
+
+    allocator_tag buddy_allocator::tag() const noexcept {
+        return allocator_tag::buddy;
+    }
+
+    buddy_allocator::size_type buddy_allocator::max_size() const noexcept {
+        return _Mycapacity;
+    }
+
+    bool buddy_allocator::is_equal(const allocator& _Other) const noexcept {
+        // stateful allocator, equal only to itself
+        return this == ::std::addressof(_Other);
+    }
+
+    bool buddy_allocator::contains(const_pointer _Ptr, const size_type _Size) const noexcept {
+        if (!_Mybase) { // no managed region, nothing can be contained
+            return false;
+        }
+
+        return mjxsdk_impl::_Is_within_memory_block(_Mybase, mjxsdk_impl::_Adjust_address_by_offset(
+            _Mybase, _Mycapacity), _Ptr, mjxsdk_impl::_Adjust_address_by_offset(_Ptr, _Size));
+    }
+
+    buddy_allocator::size_type buddy_allocator::min_block_size() const noexcept {
+        return _Mymin_block;
+    }
+
+    buddy_allocator::size_type buddy_allocator::capacity() const noexcept {
+        return _Mycapacity;
+    }
+
+    void buddy_allocator::release() noexcept {
+        for (size_type _Order = 0; _Order < _Myorder_count; ++_Order) {
+            _Myfree[_Order] = nullptr;
+        }
+
+        _Myfree_mask = 0;
+        if (_Myorders) { // the whole region becomes a single free block
+            ::memset(_Myorders, 0, _Mycapacity / _Mymin_block);
+            _Push_free_block(0, _Myorder_count - 1);
+        }
+    }
+} // namespace mjx
\ No newline at end of file
@@ -0,0 +1,94 @@
+// buddy_allocator.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _MJXSDK_MEMORY_BUDDY_ALLOCATOR_HPP_
+#define _MJXSDK_MEMORY_BUDDY_ALLOCATOR_HPP_
+#include <climits>
+#include <mjxsdk/core/export.hpp>
+#include <mjxsdk/memory/allocator.hpp>
+#include <mjxsdk/memory/memory_resource.hpp>
+
+namespace mjx {
+    class _MJXSDK_EXPORT buddy_allocator final : public allocator { // binary buddy allocator over a resource
+    public:
+        using value_type      = allocator::value_type;
+        using size_type       = allocator::size_type;
+        using difference_type = allocator::difference_type;
+        using pointer         = allocator::pointer;
+        using const_pointer   = allocator::const_pointer;
+
+        // the default size of the smallest block, each free block must hold two links
+        static constexpr size_type default_min_block_size = 2 * sizeof(void*);
+
+        // the largest possible number of block orders
+        static constexpr size_type max_order_count = sizeof(size_type) * CHAR_BIT;
+
+        explicit buddy_allocator(memory_resource& _Resource, const size_type _Min_block_size = 0);
+        ~buddy_allocator() noexcept override;
+
+        buddy_allocator(const buddy_allocator&)            = delete;
+        buddy_allocator& operator=(const buddy_allocator&) = delete;
+
+        // allocates the smallest power-of-two block that can hold _Size bytes aligned to _Align
+        pointer allocate(size_type _Size, size_type _Align = 0) override;
+
+        // returns the block and merges it with its free buddies
+        void deallocate(pointer _Ptr, size_type _Size, size_type _Align = 0) noexcept override;
+
+        // returns the size of the power-of-two block that serves the request
+        size_type good_size(size_type _Size, size_type _Align = 0) const noexcept override;
+
+        // returns the tag that identifies the allocator type
+        allocator_tag tag() const noexcept override;
+
+        // returns the largest supported allocation size
+        size_type max_size() const noexcept override;
+
+        // compares for equality with another allocator
+        bool is_equal(const allocator& _Other) const noexcept override;
+
+        // checks whether the memory block comes from the managed resource
+        bool contains(const_pointer _Ptr, const size_type _Size) const noexcept;
+
+        // returns the size of the smallest block
+        size_type min_block_size() const noexcept;
+
+        // returns the size of the managed region (the largest power of two that fits in the resource)
+        size_type capacity() const noexcept;
+
+        // frees all blocks at once
+        void release() noexcept;
+
+    private:
+        struct _Free_block;
+
+        // returns the order of the block that serves the request
+        size_type _Get_order(const size_type _Size, const size_type _Align) const noexcept;
+
+        // returns the index of the smallest block that starts at the given address
+        size_type _Get_block_index(const void* const _Ptr) const noexcept;
+
+        // returns the address of the smallest block with the given index
+        void* _Get_block_address(const size_type _Idx) const noexcept;
+
+        // inserts the block into the free list of the given order
+        void _Push_free_block(const size_type _Idx, const size_type _Order) noexcept;
+
+        // removes the block from the free list of the given order
+        void _Remove_free_block(const size_type _Idx, const size_type _Order) noexcept;
+
+        void* _Mybase; // the beginning of the managed region
+        size_type _Mycapacity; // the size of the managed region
+        size_type _Mymin_block; // the size of the smallest block (order 0)
+        size_type _Mybase_align; // the largest alignment that the region can guarantee
+        size_type _Myorder_count; // the number of block orders, the largest order spans the whole region
+        size_type _Myfree_mask; // one bit for each order that has a free block
+        _Free_block* _Myfree[max_order_count]; // one free list per order
+        unsigned char* _Myorders; // order + 1 of each free block that starts at a given index, 0 otherwise
+    };
+} // namespace mjx
+
+#endif // _MJXSDK_MEMORY_BUDDY_ALLOCATOR_HPP_
\ No newline at end of file
@@ -0,0 +1,281 @@
+// concurrent_pool_allocator.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <algorithm>
+#include <atomic>
+#include <mjxsdk/core/impl/utils.hpp>
+#include <mjxsdk/core/macros.hpp>
+#include <mjxsdk/memory/concurrent_pool_allocator.hpp>
+#include <mjxsdk/memory/exception.hpp>
+#include <mjxsdk/memory/impl/allocation_hooks.hpp>
+#include <mjxsdk/memory/impl/global_allocator.hpp>
+#include <mjxsdk/memory/impl/lock_free_stack.hpp>
+#include <mjxsdk/memory/impl/utils.hpp>
+#include <mjxsdk/memory/object.hpp>
+#include <mutex>
+#include <new>
+#include <utility>
+
+namespace mjx {
+    namespace mjxsdk_impl {
+        struct _Pool_chunk_header { // header placed at the beginning of each upstream chunk
+            _Pool_chunk_header* _Next;
+            size_t _Size;
+        };
+
+        struct alignas(_Cache_line_size) _Concurrent_pool { // state shared by all threads
+            // Note: The free list and the carved offset are updated by every thread, so each of them
+            //       lives on its own cache line, away from the fields that are only read.
+            memory_resource* _Res;
+            allocator* _Upstream;
+            void* _Region; // the first aligned block of the resource
+            size_t _Region_size; // the number of usable bytes in the resource
+            size_t _Block_size; // the size of each block, as requested
+            size_t _Block_align; // the alignment of each block
+            size_t _Stride; // the distance between two adjacent blocks
+
+            alignas(_Cache_line_size) _Lock_free_stack _Free;
+            alignas(_Cache_line_size) ::std::atomic<size_t> _Carved; // bytes of the region carved so far
+
+            alignas(_Cache_line_size) ::std::mutex _Mtx; // serializes upstream chunk acquisition
+            _Pool_chunk_header* _Chunks; // chunks obtained from the upstream allocator
+
+            _Concurrent_pool(memory_resource* const _Resource, allocator* const _Upstream_al,
+                const size_t _Size, const size_t _Align) noexcept
+                : _Res(_Resource), _Upstream(_Upstream_al), _Region(nullptr), _Region_size(0),
+                _Block_size(_Size), _Block_align(_Get_effective_alignment(_Align)),
+                _Stride(_Align_value(_Size > sizeof(_Stack_node) ? _Size : sizeof(_Stack_node), _Block_align)),
+                _Free(), _Carved(0), _Mtx(), _Chunks(nullptr) {
+                if (_Res && !_Res->empty()) { // blocks are carved from the resource on demand
+                    void* const _End = _Adjust_address_by_offset(_Res->data(), _Res->size());
+                    _Region          = _Align_address(_Res->data(), _Block_align);
+                    _Region_size     = _Region < _End ? _Distance_between(_Region, _End) : 0;
+                }
+            }
+
+            void* _Carve_from_region() noexcept {
+                // reserves the next uncarved block of the resource, fails once the resource is exhausted
+                size_t _Offset = _Carved.load(::std::memory_order_relaxed);
+                while (_Region_size - _Offset >= _Stride) {
+                    if (_Carved.compare_exchange_weak(_Offset, _Offset + _Stride, ::std::memory_order_relaxed)) {
+                        return _Adjust_address_by_offset(_Region, _Offset);
+                    }
+                }
+
+                return nullptr;
+            }
+        };
+
+        inline _Concurrent_pool* _Create_concurrent_pool(memory_resource* const _Resource,
+            allocator* const _Upstream, const size_t _Size, const size_t _Align) {
+            // the pool is over-aligned, so the alignment must be passed explicitly
+            allocator& _Al = _Get_internal_allocator();
+            return ::mjx::construct_object(static_cast<_Concurrent_pool*>(_Al.allocate(
+                sizeof(_Concurrent_pool), alignof(_Concurrent_pool))), _Resource, _Upstream, _Size, _Align);
+        }
+
+        inline void _Delete_concurrent_pool(_Concurrent_pool* const _Pool) noexcept {
+            ::mjx::destroy_object(_Pool);
+            _Get_internal_allocator().deallocate(_Pool, sizeof(_Concurrent_pool), alignof(_Concurrent_pool));
+        }
+    } // namespace mjxsdk_impl
+
+    concurrent_pool_allocator::concurrent_pool_allocator(
+        const size_type _Block_size, memory_resource& _Resource, const size_type _Block_align)
+        : _Mypool(mjxsdk_impl::_Create_concurrent_pool(
+            ::std::addressof(_Resource), nullptr, _Block_size, _Block_align)) {}
+
+    concurrent_pool_allocator::concurrent_pool_allocator(
+        const size_type _Block_size, allocator& _Upstream, const size_type _Block_align)
+        : _Mypool(mjxsdk_impl::_Create_concurrent_pool(
+            nullptr, ::std::addressof(_Upstream), _Block_size, _Block_align)) {}
+
+    concurrent_pool_allocator::concurrent_pool_allocator(const size_type _Block_size,
+        memory_resource& _Resource, allocator& _Upstream, const size_type _Block_align)
+        : _Mypool(mjxsdk_impl::_Create_concurrent_pool(
+            ::std::addressof(_Resource), ::std::addressof(_Upstream), _Block_size, _Block_align)) {}
+
+    concurrent_pool_allocator::~concurrent_pool_allocator() noexcept {
+        release();
+        mjxsdk_impl::_Delete_concurrent_pool(_Mypool);
+    }
+
+    concurrent_pool_allocator::pointer concurrent_pool_allocator::_Allocate_from_upstream() {
+        ::std::lock_guard _Guard(_Mypool->_Mtx);
+        if (mjxsdk_impl::_Stack_node* const _Node = _Mypool->_Free._Pop(); _Node) {
+            return _Node; // another thread has refilled the free list in the meantime
+        }
+
+        // reserve enough space for the header, the alignment padding and all blocks
+        constexpr size_type _Header_size = sizeof(mjxsdk_impl::_Pool_chunk_header);
+        const size_type _Stride          = _Mypool->_Stride;
+        const size_type _Chunk_size      = _Header_size + _Mypool->_Block_align + _Stride * blocks_per_chunk;
+        mjxsdk_impl::_Internal_allocation_scope _Scope; // the blocks are reported, not the chunk
+        mjxsdk_impl::_Pool_chunk_header* const _Chunk =
+            static_cast<mjxsdk_impl::_Pool_chunk_header*>(_Mypool->_Upstream->allocate(_Chunk_size));
+        _Chunk->_Next    = _Mypool->_Chunks;
+        _Chunk->_Size    = _Chunk_size;
+        _Mypool->_Chunks = _Chunk;
+
+        // link all blocks but the first one and publish them with a single push
+        void* const _First = mjxsdk_impl::_Align_address(
+            mjxsdk_impl::_Adjust_address_by_offset(_Chunk, _Header_size), _Mypool->_Block_align);
+        mjxsdk_impl::_Stack_node* const _Head =
+            static_cast<mjxsdk_impl::_Stack_node*>(mjxsdk_impl::_Adjust_address_by_offset(_First, _Stride));
+        mjxsdk_impl::_Stack_node* _Tail = _Head;
+        for (size_type _Idx = 2; _Idx < blocks_per_chunk; ++_Idx) {
+            mjxsdk_impl::_Stack_node* const _Next =
+                static_cast<mjxsdk_impl::_Stack_node*>(mjxsdk_impl::_Adjust_address_by_offset(_Tail, _Stride));
+            _Tail->_Next.store(_Next, ::std::memory_order_relaxed);
+            _Tail = _Next;
+        }
+
+        _Mypool->_Free._Push_chain(_Head, _Tail);
+        return _First;
+    }
+
+    void concurrent_pool_allocator::_Check_request(const size_type _Size, const size_type _Align) const {
+        if (_Size > _Mypool->_Block_size) { // the block cannot hold the requested size, raise an exception
+            allocation_limit_exceeded::raise();
+        }
+
+        if (mjxsdk_impl::_Get_effective_alignment(_Align) > _Mypool->_Block_align) { // unsupported alignment
+            allocation_failure::raise();
+        }
+    }
+
+    concurrent_pool_allocator::pointer concurrent_pool_allocator::_Allocate_block() {
+        if (mjxsdk_impl::_Stack_node* const _Node = _Mypool->_Free._Pop(); _Node) { // reuse a freed block
+            return _Node;
+        }
+
+        if (void* const _Block = _Mypool->_Carve_from_region(); _Block) { // take a new block from the resource
+            return _Block;
+        }
+
+        if (!_Mypool->_Upstream) { // no upstream allocator, raise an exception
+            allocation_limit_exceeded::raise();
+        }
+
+        return _Allocate_from_upstream();
+    }
+
+    concurrent_pool_allocator::pointer concurrent_pool_allocator::allocate(size_type _Size, size_type _Align) {
+        if (_Size == 0) { // no allocation, do nothing
+            return nullptr;
+        }
+
+        _Check_request(_Size, _Align);
+        void* const _Ptr = _Allocate_block();
+        mjxsdk_impl::_Report_allocation(_Ptr, _Size, _Align, allocator_tag::concurrent_pool, _MJX_RETURN_ADDRESS());
+        return _Ptr;
+    }
+
+    void concurrent_pool_allocator::deallocate(pointer _Ptr, size_type _Size, size_type _Align) noexcept {
+        if (!_Ptr) { // invalid block, break
+            return;
+        }
+
+        mjxsdk_impl::_Report_deallocation(_Ptr, _Size, _Align, allocator_tag::concurrent_pool);
+        _Mypool->_Free._Push(::new (_Ptr) mjxsdk_impl::_Stack_node);
+    }
+
+    void concurrent_pool_allocator::allocate_bulk(
+        size_type _Size, size_type _Align, size_type _Count, pointer* _Ptrs) {
+        if (_Size == 0) { // no allocation, fill with null pointers
+            ::std::fill_n(_Ptrs, _Count, nullptr);
+            return;
+        }
+
+        _Check_request(_Size, _Align); // check once for the whole batch
+        const void* const _Return_address = _MJX_RETURN_ADDRESS();
+        size_type _Idx                    = 0;
+        try {
+            for (; _Idx < _Count; ++_Idx) {
+                _Ptrs[_Idx] = _Allocate_block();
+                mjxsdk_impl::_Report_allocation(
+                    _Ptrs[_Idx], _Size, _Align, allocator_tag::concurrent_pool, _Return_address);
+            }
+        } catch (...) {
+            deallocate_bulk(_Ptrs, _Idx, _Size, _Align); // return the blocks allocated so far
+            throw;
+        }
+    }
+
+    void concurrent_pool_allocator::deallocate_bulk(
+        const pointer* _Ptrs, size_type _Count, size_type _Size, size_type _Align) noexcept {
+        // link the blocks privately, then publish the whole chain with a single push
+        if (_Count == 0 || _Size == 0) { // no blocks, do nothing
+            return;
+        }
+
+        if (mjxsdk_impl::_Is_reporting_allocations()) { // let the diagnostic tools observe each block
+            for (size_type _Idx = 0; _Idx < _Count; ++_Idx) {
+                mjxsdk_impl::_Invoke_deallocation_hooks(_Ptrs[_Idx], _Size, _Align, allocator_tag::concurrent_pool);
+            }
+        }
+
+        mjxsdk_impl::_Stack_node* const _Head = ::new (_Ptrs[0]) mjxsdk_impl::_Stack_node;
+        mjxsdk_impl::_Stack_node* _Tail       = _Head;
+        for (size_type _Idx = 1; _Idx < _Count; ++_Idx) {
+            mjxsdk_impl::_Stack_node* const _Next = ::new (_Ptrs[_Idx]) mjxsdk_impl::_Stack_node;
+            _Tail->_Next.store(_Next, ::std::memory_order_relaxed);
+            _Tail = _Next;
+        }
+
+        _Mypool->_Free._Push_chain(_Head, _Tail);
+    }
+
+    bool concurrent_pool_allocator::try_expand_in_place(
+        pointer _Ptr, size_type, size_type _New_size, size_type) noexcept {
+        if (mjxsdk_impl::_Is_reporting_allocations()) { // let the caller reallocate, so that the hooks see the block
+            return false;
+        }
+
+        return _Ptr && _New_size > 0 && _New_size <= _Mypool->_Block_size;
+    }
+
+    concurrent_pool_allocator::size_type
+        concurrent_pool_allocator::good_size(size_type _Size, size_type) const noexcept {
+        return _Size == 0 || _Size > _Mypool->_Block_size ? _Size : _Mypool->_Block_size;
+    }
+
+    allocator_tag concurrent_pool_allocator::tag() const noexcept {
+        return allocator_tag::concurrent_pool;
+    }
+
+    concurrent_pool_allocator::size_type concurrent_pool_allocator::max_size() const noexcept {
+        return _Mypool->_Block_size;
+    }
+
+    bool concurrent_pool_allocator::is_equal(const allocator& _Other) const noexcept {
+        // stateful allocator, equal only to itself
+        return this == ::std::addressof(_Other);
+    }
+
+    concurrent_pool_allocator::size_type concurrent_pool_allocator::block_size() const noexcept {
+        return _Mypool->_Block_size;
+    }
+
+    concurrent_pool_allocator::size_type concurrent_pool_allocator::block_align() const noexcept {
+        return _Mypool->_Block_align;
+    }
+
+    allocator* concurrent_pool_allocator::upstream() const noexcept {
+        return _Mypool->_Upstream;
+    }
+
+    void concurrent_pool_allocator::release() noexcept {
+        mjxsdk_impl::_Internal_allocation_scope _Scope; // the chunks were never reported
+        while (_Mypool->_Chunks) { // return each chunk to the upstream allocator
+            mjxsdk_impl::_Pool_chunk_header* const _Next = _Mypool->_Chunks->_Next;
+            _Mypool->_Upstream->deallocate(_Mypool->_Chunks, _Mypool->_Chunks->_Size);
+            _Mypool->_Chunks = _Next;
+        }
+
+        _Mypool->_Free._Clear();
+        _Mypool->_Carved.store(0, ::std::memory_order_relaxed);
+    }
+} // namespace mjx
\ No newline at end of file
@@ -0,0 +1,95 @@
+// concurrent_pool_allocator.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _MJXSDK_MEMORY_CONCURRENT_POOL_ALLOCATOR_HPP_
+#define _MJXSDK_MEMORY_CONCURRENT_POOL_ALLOCATOR_HPP_
+#include <mjxsdk/core/export.hpp>
+#include <mjxsdk/memory/allocator.hpp>
+#include <mjxsdk/memory/memory_resource.hpp>
+
+namespace mjx {
+    namespace mjxsdk_impl {
+        struct _Concurrent_pool;
+    } // namespace mjxsdk_impl
+
+    class _MJXSDK_EXPORT concurrent_pool_allocator final : public allocator { // lock-free fixed-size block allocator
+    public:
+        using value_type      = allocator::value_type;
+        using size_type       = allocator::size_type;
+        using difference_type = allocator::difference_type;
+        using pointer         = allocator::pointer;
+        using const_pointer   = allocator::const_pointer;
+
+        // the number of blocks in each chunk requested from the upstream allocator
+        static constexpr size_type blocks_per_chunk = 256;
+
+        concurrent_pool_allocator(const size_type _Block_size, memory_resource& _Resource,
+            const size_type _Block_align = 0);
+        concurrent_pool_allocator(const size_type _Block_size, allocator& _Upstream,
+            const size_type _Block_align = 0);
+        concurrent_pool_allocator(const size_type _Block_size, memory_resource& _Resource,
+            allocator& _Upstream, const size_type _Block_align = 0);
+        ~concurrent_pool_allocator() noexcept override;
+
+        concurrent_pool_allocator(const concurrent_pool_allocator&)            = delete;
+        concurrent_pool_allocator& operator=(const concurrent_pool_allocator&) = delete;
+
+        // allocates one block, _Size and _Align must not exceed the block size and alignment
+        pointer allocate(size_type _Size, size_type _Align = 0) override;
+
+        // returns the block to the free list, may be called from any thread
+        void deallocate(pointer _Ptr, size_type _Size, size_type _Align = 0) noexcept override;
+
+        // allocates _Count blocks with a single call, either all or none
+        void allocate_bulk(size_type _Size, size_type _Align, size_type _Count, pointer* _Ptrs) override;
+
+        // returns _Count blocks to the free list with a single atomic operation
+        void deallocate_bulk(
+            const pointer* _Ptrs, size_type _Count, size_type _Size, size_type _Align = 0) noexcept override;
+
+        // succeeds as long as the new size fits in the block
+        bool try_expand_in_place(
+            pointer _Ptr, size_type _Old_size, size_type _New_size, size_type _Align = 0) noexcept override;
+
+        // returns the block size for any request that fits in a block
+        size_type good_size(size_type _Size, size_type _Align = 0) const noexcept override;
+
+        // returns the tag that identifies the allocator type
+        allocator_tag tag() const noexcept override;
+
+        // returns the largest supported allocation size
+        size_type max_size() const noexcept override;
+
+        // compares for equality with another allocator
+        bool is_equal(const allocator& _Other) const noexcept override;
+
+        // returns the size of each block
+        size_type block_size() const noexcept;
+
+        // returns the alignment of each block
+        size_type block_align() const noexcept;
+
+        // returns the upstream allocator (if any)
+        allocator* upstream() const noexcept;
+
+        // frees all blocks, must not be called while other threads use the allocator
+        void release() noexcept;
+
+    private:
+        // obtains a block from a new upstream chunk, the rest of the chunk goes to the free list
+        pointer _Allocate_from_upstream();
+
+        // checks whether a block can serve the requested size and alignment, raises an exception if not
+        void _Check_request(const size_type _Size, const size_type _Align) const;
+
+        // takes one block from the free list, the resource or a new upstream chunk
+        pointer _Allocate_block();
+
+        mjxsdk_impl::_Concurrent_pool* _Mypool;
+    };
+} // namespace mjx
+
+#endif // _MJXSDK_MEMORY_CONCURRENT_POOL_ALLOCATOR_HPP_
\ No newline at end of file
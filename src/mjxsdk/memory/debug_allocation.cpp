@@ -0,0 +1,73 @@
+// debug_allocation.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <mjxsdk/memory/debug_allocation.hpp>
+#include <mjxsdk/memory/impl/allocation_hooks.hpp>
+#include <mjxsdk/memory/impl/pointer_map.hpp>
+#ifdef _MJX_WINDOWS
+#include <mjxsdk/core/impl/tinywin.hpp>
+#else // ^^^ _MJX_WINDOWS ^^^ / vvv _MJX_LINUX vvv
+#include <cstdlib>
+#endif // _MJX_WINDOWS
+
+namespace mjx {
+    namespace mjxsdk_impl {
+        inline _Pointer_map<bool>& _Get_debug_blocks() noexcept {
+            // never destroyed, debug blocks may still be deallocated during static destruction
+            static _Pointer_map<bool>* const _Map = new _Pointer_map<bool>();
+            return *_Map;
+        }
+
+        bool _Register_debug_block(void* const _Ptr) noexcept {
+            return _Get_debug_blocks()._Insert(_Ptr, true);
+        }
+
+        bool _Unregister_debug_block(void* const _Ptr) noexcept {
+            return _Get_debug_blocks()._Erase(_Ptr);
+        }
+
+        inline bool _Is_debug_allocation_requested() noexcept {
+            // checks whether the MJXSDK_DEBUG_ALLOCATION environment variable is set to anything but "0"
+#ifdef _MJX_WINDOWS
+            char _Value[2];
+            const ::DWORD _Length = ::GetEnvironmentVariableA("MJXSDK_DEBUG_ALLOCATION", _Value, sizeof(_Value));
+            return _Length > 0 && (_Length >= sizeof(_Value) || _Value[0] != '0');
+#else // ^^^ _MJX_WINDOWS ^^^ / vvv _MJX_LINUX vvv
+            const char* const _Value = ::getenv("MJXSDK_DEBUG_ALLOCATION");
+            return _Value && _Value[0] != '\0' && (_Value[0] != '0' || _Value[1] != '\0');
+#endif // _MJX_WINDOWS
+        }
+
+        struct _Debug_allocation_initializer { // reads the environment once, when the library is loaded
+            _Debug_allocation_initializer() noexcept {
+                if (_Is_debug_allocation_requested()) {
+                    ::mjx::enable_debug_allocation();
+                }
+            }
+        };
+
+        const _Debug_allocation_initializer _Debug_allocation_init;
+    } // namespace mjxsdk_impl
+
+    void enable_debug_allocation() noexcept {
+#ifndef _DEBUG // debug builds always allocate debug blocks
+        // the block hook is never disabled, blocks allocated from now on must be recognized later
+        mjxsdk_impl::_Enable_allocation_hook(mjxsdk_impl::_Debug_block_hook);
+        mjxsdk_impl::_Enable_allocation_hook(mjxsdk_impl::_Debug_allocation_hook);
+#endif // _DEBUG
+    }
+
+    void disable_debug_allocation() noexcept {
+        mjxsdk_impl::_Disable_allocation_hook(mjxsdk_impl::_Debug_allocation_hook);
+    }
+
+    bool is_debug_allocation_enabled() noexcept {
+#ifdef _DEBUG
+        return true;
+#else // ^^^ _DEBUG ^^^ / vvv NDEBUG vvv
+        return mjxsdk_impl::_Is_allocation_hook_enabled(mjxsdk_impl::_Debug_allocation_hook);
+#endif // _DEBUG
+    }
+} // namespace mjx
\ No newline at end of file
@@ -0,0 +1,24 @@
+// debug_allocation.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _MJXSDK_MEMORY_DEBUG_ALLOCATION_HPP_
+#define _MJXSDK_MEMORY_DEBUG_ALLOCATION_HPP_
+#include <mjxsdk/core/export.hpp>
+
+namespace mjx {
+    // Note: In checked mode, system_allocator surrounds new blocks with the same metadata and sentinels
+    //       that debug builds always use, and verifies them on deallocation. Debug builds are always
+    //       in checked mode. Release builds enter it through enable_debug_allocation(), or at startup
+    //       if the MJXSDK_DEBUG_ALLOCATION environment variable is set to anything but "0".
+    //       Until checked mode is first enabled, and while no other diagnostic tool is enabled,
+    //       system_allocator only pays for a single branch. Blocks allocated in checked mode are
+    //       recognized and verified after the mode is disabled, so deallocations keep looking them up.
+    _MJXSDK_EXPORT void enable_debug_allocation() noexcept;
+    _MJXSDK_EXPORT void disable_debug_allocation() noexcept;
+    _MJXSDK_EXPORT bool is_debug_allocation_enabled() noexcept;
+} // namespace mjx
+
+#endif // _MJXSDK_MEMORY_DEBUG_ALLOCATION_HPP_
\ No newline at end of file
@@ -0,0 +1,192 @@
+// debug_quarantine.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <mjxsdk/core/impl/assert.hpp>
+#include <mjxsdk/memory/debug_quarantine.hpp>
+#include <mjxsdk/memory/impl/debug_block.hpp>
+#include <mjxsdk/memory/impl/spin_lock.hpp>
+#include <mutex>
+#include <new>
+#ifdef _MJX_X64
+#include <emmintrin.h>
+#endif // _MJX_X64
+
+namespace mjx {
+    namespace mjxsdk_impl {
+        // the number of bytes that quarantined blocks may occupy
+        ::std::atomic<size_t> _Debug_quarantine_limit{default_debug_quarantine_size};
+
+        // the pattern that fills deallocated blocks, 'DD' (Dead)
+        inline constexpr unsigned char _Poison_byte = 0xDD;
+
+        inline size_t _Find_poison_mismatch(const unsigned char* const _First, const size_t _Size) noexcept {
+            // returns the offset of the first byte that differs from the poison, or _Size if there is none
+            size_t _Off = 0;
+#ifdef _MJX_X64
+            const __m128i _Pattern = _mm_set1_epi8(static_cast<char>(_Poison_byte));
+            for (; _Off + 64 <= _Size; _Off += 64) { // compare 64 bytes at a time while the block is intact
+                const unsigned char* const _Chunk = _First + _Off;
+                const __m128i _Eq                 = _mm_and_si128(
+                    _mm_and_si128(
+                        _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(_Chunk)), _Pattern),
+                        _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(_Chunk + 16)), _Pattern)),
+                    _mm_and_si128(
+                        _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(_Chunk + 32)), _Pattern),
+                        _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(_Chunk + 48)), _Pattern)));
+                if (_mm_movemask_epi8(_Eq) != 0xFFFF) { // the mismatch is located by the scalar loop
+                    break;
+                }
+            }
+#endif // _MJX_X64
+
+            for (; _Off < _Size; ++_Off) {
+                if (_First[_Off] != _Poison_byte) {
+                    return _Off;
+                }
+            }
+
+            return _Size;
+        }
+
+        struct _Quarantined_block {
+            void* _Block;
+            size_t _Size;
+            size_t _Align;
+        };
+
+        class _Debug_quarantine { // FIFO of deallocated debug blocks
+        public:
+            _Debug_quarantine() noexcept
+                : _Myblocks(nullptr), _Mycapacity(0), _Myhead(0), _Mycount(0), _Mybytes(0), _Mylock() {}
+
+            _Debug_quarantine(const _Debug_quarantine&)            = delete;
+            _Debug_quarantine& operator=(const _Debug_quarantine&) = delete;
+
+            static _Debug_quarantine& _Instance() noexcept {
+                // never destroyed, debug blocks may still be deallocated during static destruction
+                static _Debug_quarantine* const _Obj = new _Debug_quarantine();
+                return *_Obj;
+            }
+
+            void _Push(void* const _Block, const size_t _Size, const size_t _Align) noexcept {
+                // poisons the block and queues it, then releases the oldest blocks that no longer fit
+                if (_Size > _Debug_quarantine_limit.load(::std::memory_order_relaxed)) { // never fits
+                    _Release(_Quarantined_block{_Block, _Size, _Align}, false);
+                    return;
+                }
+
+                // the header stays intact, so that a repeated deallocation is still reported
+                const size_t _Header_size = _Calculate_inline_header_size(_Align);
+                _Fill_at(_Block, _Size - _Header_size, static_cast<intptr_t>(_Header_size), _Poison_byte);
+                bool _Queued = false;
+                {
+                    ::std::lock_guard<_Spin_lock> _Guard(_Mylock);
+                    if (_Mycount < _Mycapacity || _Grow()) {
+                        _Myblocks[(_Myhead + _Mycount) % _Mycapacity] = _Quarantined_block{_Block, _Size, _Align};
+                        ++_Mycount;
+                        _Mybytes += _Size;
+                        _Queued = true;
+                    }
+                }
+
+                if (!_Queued) { // the queue cannot grow, release the block at once
+                    _Release(_Quarantined_block{_Block, _Size, _Align}, true);
+                }
+
+                _Trim(_Debug_quarantine_limit.load(::std::memory_order_relaxed));
+            }
+
+            void _Trim(const size_t _Limit) noexcept {
+                // releases the oldest blocks until the rest fits in _Limit bytes
+                for (;;) {
+                    _Quarantined_block _Oldest;
+                    {
+                        ::std::lock_guard<_Spin_lock> _Guard(_Mylock);
+                        if (_Mybytes <= _Limit || _Mycount == 0) {
+                            break;
+                        }
+
+                        _Oldest  = _Myblocks[_Myhead];
+                        _Myhead  = (_Myhead + 1) % _Mycapacity;
+                        _Mybytes -= _Oldest._Size;
+                        --_Mycount;
+                    }
+
+                    _Release(_Oldest, true);
+                }
+            }
+
+        private:
+            static void _Release(const _Quarantined_block& _Entry, const bool _Poisoned) noexcept {
+                // verifies that the block was not written since its deallocation, then frees it
+                if (_Poisoned) {
+                    const size_t _Header_size = _Calculate_inline_header_size(_Entry._Align);
+                    const size_t _Poison_size = _Entry._Size - _Header_size;
+                    const size_t _Off         = _Find_poison_mismatch(
+                        static_cast<const unsigned char*>(_Entry._Block) + _Header_size, _Poison_size);
+                    if (_Off != _Poison_size) { // report write-after-free
+                        _REPORT_ERROR("Corrupted block at 0x%p. Memory was written at 0x%p after the block "
+                                      "was deallocated.",
+                            _Adjust_address_by_offset(_Entry._Block, _Calculate_user_offset(_Entry._Align)),
+                            _Adjust_address_by_offset(_Entry._Block, _Header_size + _Off));
+                    }
+                }
+
+                if (_Has_out_of_band_header(_Entry._Align)) { // the block is gone, forget its header
+                    _Get_out_of_band_headers()._Erase(_Entry._Block);
+                }
+
+                ::operator delete(_Entry._Block, _Entry._Size, ::std::align_val_t{_Entry._Align});
+            }
+
+            bool _Grow() noexcept {
+                // doubles the capacity of the queue, keeping the order of the blocks
+                const size_t _New_capacity = _Mycapacity > 0 ? _Mycapacity * 2 : 256;
+                _Quarantined_block* const _New_blocks =
+                    static_cast<_Quarantined_block*>(::malloc(_New_capacity * sizeof(_Quarantined_block)));
+                if (!_New_blocks) { // not enough memory, keep the current queue
+                    return false;
+                }
+
+                for (size_t _Idx = 0; _Idx < _Mycount; ++_Idx) {
+                    _New_blocks[_Idx] = _Myblocks[(_Myhead + _Idx) % _Mycapacity];
+                }
+
+                ::free(_Myblocks);
+                _Myblocks   = _New_blocks;
+                _Mycapacity = _New_capacity;
+                _Myhead     = 0;
+                return true;
+            }
+
+            _Quarantined_block* _Myblocks; // ring buffer, the least recently deallocated block comes first
+            size_t _Mycapacity;
+            size_t _Myhead;
+            size_t _Mycount;
+            size_t _Mybytes;
+            _Spin_lock _Mylock;
+        };
+
+        void _Quarantine_debug_block(void* const _Block, const size_t _Size, const size_t _Align) noexcept {
+            _Debug_quarantine::_Instance()._Push(_Block, _Size, _Align);
+        }
+    } // namespace mjxsdk_impl
+
+    void set_debug_quarantine_size(const size_t _Size) noexcept {
+        mjxsdk_impl::_Debug_quarantine_limit.store(_Size, ::std::memory_order_relaxed);
+        mjxsdk_impl::_Debug_quarantine::_Instance()._Trim(_Size);
+    }
+
+    size_t debug_quarantine_size() noexcept {
+        return mjxsdk_impl::_Debug_quarantine_limit.load(::std::memory_order_relaxed);
+    }
+
+    void flush_debug_quarantine() noexcept {
+        mjxsdk_impl::_Debug_quarantine::_Instance()._Trim(0);
+    }
+} // namespace mjx
\ No newline at end of file
@@ -0,0 +1,27 @@
+// debug_quarantine.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _MJXSDK_MEMORY_DEBUG_QUARANTINE_HPP_
+#define _MJXSDK_MEMORY_DEBUG_QUARANTINE_HPP_
+#include <cstddef>
+#include <mjxsdk/core/export.hpp>
+
+namespace mjx {
+    // the default number of bytes that deallocated debug blocks may occupy before they are released
+    inline constexpr size_t default_debug_quarantine_size = 4 * 1024 * 1024;
+
+    // Note: Deallocated debug blocks are filled with a poison pattern and held in a FIFO quarantine
+    //       instead of being released at once. When a block leaves the quarantine, the pattern is verified
+    //       and any write-after-free is reported. A larger quarantine catches writes made later
+    //       at the cost of memory, a zero size releases every block at once.
+    _MJXSDK_EXPORT void set_debug_quarantine_size(const size_t _Size) noexcept;
+    _MJXSDK_EXPORT size_t debug_quarantine_size() noexcept;
+
+    // verifies and releases every quarantined block
+    _MJXSDK_EXPORT void flush_debug_quarantine() noexcept;
+} // namespace mjx
+
+#endif // _MJXSDK_MEMORY_DEBUG_QUARANTINE_HPP_
\ No newline at end of file
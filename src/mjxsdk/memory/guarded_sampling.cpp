@@ -0,0 +1,440 @@
+// guarded_sampling.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <mjxsdk/core/impl/assert.hpp>
+#include <mjxsdk/core/impl/utils.hpp>
+#include <mjxsdk/memory/guarded_sampling.hpp>
+#include <mjxsdk/memory/impl/allocation_hooks.hpp>
+#include <mjxsdk/memory/impl/spin_lock.hpp>
+#include <mjxsdk/memory/impl/utils.hpp>
+#include <mutex>
+#ifdef _MJX_WINDOWS
+#include <mjxsdk/core/impl/tinywin.hpp>
+#else // ^^^ _MJX_WINDOWS ^^^ / vvv _MJX_LINUX vvv
+#include <signal.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif // _MJX_WINDOWS
+
+namespace mjx {
+    namespace mjxsdk_impl {
+        inline size_t _Get_guard_page_size() noexcept {
+#ifdef _MJX_WINDOWS
+            ::SYSTEM_INFO _Info;
+            ::GetSystemInfo(&_Info);
+            return static_cast<size_t>(_Info.dwPageSize);
+#else // ^^^ _MJX_WINDOWS ^^^ / vvv _MJX_LINUX vvv
+            return static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+#endif // _MJX_WINDOWS
+        }
+
+        inline void* _Reserve_guard_pages(const size_t _Size) noexcept {
+            // reserves inaccessible pages
+#ifdef _MJX_WINDOWS
+            return ::VirtualAlloc(nullptr, _Size, MEM_RESERVE | MEM_COMMIT, PAGE_NOACCESS);
+#else // ^^^ _MJX_WINDOWS ^^^ / vvv _MJX_LINUX vvv
+            void* const _Ptr = ::mmap(nullptr, _Size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            return _Ptr != MAP_FAILED ? _Ptr : nullptr;
+#endif // _MJX_WINDOWS
+        }
+
+        inline void _Release_guard_pages(void* const _Pages, const size_t _Size) noexcept {
+#ifdef _MJX_WINDOWS
+            (void) _Size;
+            ::VirtualFree(_Pages, 0, MEM_RELEASE);
+#else // ^^^ _MJX_WINDOWS ^^^ / vvv _MJX_LINUX vvv
+            ::munmap(_Pages, _Size);
+#endif // _MJX_WINDOWS
+        }
+
+        inline void _Protect_guard_page(void* const _Page, const size_t _Size, const bool _Accessible) noexcept {
+#ifdef _MJX_WINDOWS
+            ::DWORD _Old;
+            ::VirtualProtect(_Page, _Size, _Accessible ? PAGE_READWRITE : PAGE_NOACCESS, &_Old);
+#else // ^^^ _MJX_WINDOWS ^^^ / vvv _MJX_LINUX vvv
+            ::mprotect(_Page, _Size, _Accessible ? PROT_READ | PROT_WRITE : PROT_NONE);
+#endif // _MJX_WINDOWS
+        }
+
+        class _Fault_message { // report built on the stack, usable in a signal handler
+        public:
+            _Fault_message() noexcept : _Mybuf(), _Mylen(0) {}
+
+            _Fault_message(const _Fault_message&)            = delete;
+            _Fault_message& operator=(const _Fault_message&) = delete;
+
+            void _Append(const char* _Str) noexcept {
+                while (*_Str != '\0') {
+                    _Append_char(*_Str++);
+                }
+            }
+
+            void _Append_address(const void* const _Addr) noexcept {
+                // writes the address in hexadecimal
+                char _Digits[2 * sizeof(uintptr_t)];
+                size_t _Count    = 0;
+                uintptr_t _Value = reinterpret_cast<uintptr_t>(_Addr);
+                do {
+                    _Digits[_Count++] = "0123456789abcdef"[_Value & 0xF];
+                    _Value >>= 4;
+                } while (_Value != 0);
+
+                _Append("0x");
+                while (_Count > 0) {
+                    _Append_char(_Digits[--_Count]);
+                }
+            }
+
+            void _Append_size(size_t _Value) noexcept {
+                // writes the size in decimal
+                char _Digits[20]; // enough for a 64-bit value
+                size_t _Count = 0;
+                do {
+                    _Digits[_Count++] = static_cast<char>('0' + _Value % 10);
+                    _Value /= 10;
+                } while (_Value != 0);
+
+                while (_Count > 0) {
+                    _Append_char(_Digits[--_Count]);
+                }
+            }
+
+            void _Write() const noexcept {
+                // Note: fprintf() must not be used here, the fault may have occurred while the stream lock was held.
+                //       write() is async-signal-safe and WriteFile() takes no CRT lock.
+#ifdef _MJX_WINDOWS
+                ::DWORD _Written;
+                ::WriteFile(
+                    ::GetStdHandle(STD_ERROR_HANDLE), _Mybuf, static_cast<::DWORD>(_Mylen), &_Written, nullptr);
+#else // ^^^ _MJX_WINDOWS ^^^ / vvv _MJX_LINUX vvv
+                const ::ssize_t _Written = ::write(STDERR_FILENO, _Mybuf, _Mylen);
+                static_cast<void>(_Written); // nothing else can be done in a fault handler
+#endif // _MJX_WINDOWS
+            }
+
+        private:
+            void _Append_char(const char _Ch) noexcept {
+                if (_Mylen < sizeof(_Mybuf)) { // truncate overlong messages
+                    _Mybuf[_Mylen++] = _Ch;
+                }
+            }
+
+            char _Mybuf[256];
+            size_t _Mylen;
+        };
+
+        struct _Guarded_slot { // a page that holds at most one block
+            void* _Block; // the last block placed in the page
+            size_t _Size;
+            bool _Live;
+        };
+
+        class _Guarded_pool { // pages of sampled blocks, separated by guard pages
+        public:
+            _Guarded_pool(unsigned char* const _Pages, const size_t _Page_size, _Guarded_slot* const _Slots,
+                size_t* const _Free, const size_t _Slot_count) noexcept
+                : _Mybegin(_Pages), _Myend(_Pages + (2 * _Slot_count + 1) * _Page_size), _Mypage(_Page_size),
+                _Myslots(_Slots), _Myfree(_Free), _Myslot_count(_Slot_count), _Myfree_head(0),
+                _Myfree_count(_Slot_count), _Mysamples(0), _Mylock() {
+                for (size_t _Idx = 0; _Idx < _Slot_count; ++_Idx) {
+                    _Myfree[_Idx] = _Idx;
+                }
+            }
+
+            _Guarded_pool(const _Guarded_pool&)            = delete;
+            _Guarded_pool& operator=(const _Guarded_pool&) = delete;
+
+            static _Guarded_pool* _Create(const size_t _Slot_count) noexcept {
+                // the pool is never released, its blocks may be deallocated at any time
+                const size_t _Page_size  = _Get_guard_page_size();
+                const size_t _Pool_bytes = (2 * _Slot_count + 1) * _Page_size;
+                void* const _Pages       = _Reserve_guard_pages(_Pool_bytes);
+                void* const _Storage     = ::malloc(sizeof(_Guarded_pool));
+                void* const _Slots       = ::calloc(_Slot_count, sizeof(_Guarded_slot));
+                void* const _Free        = ::calloc(_Slot_count, sizeof(size_t));
+                if (!_Pages || !_Storage || !_Slots || !_Free) {
+                    if (_Pages) {
+                        _Release_guard_pages(_Pages, _Pool_bytes);
+                    }
+
+                    ::free(_Storage);
+                    ::free(_Slots);
+                    ::free(_Free);
+                    return nullptr;
+                }
+
+                return ::new (_Storage) _Guarded_pool(static_cast<unsigned char*>(_Pages), _Page_size,
+                    static_cast<_Guarded_slot*>(_Slots), static_cast<size_t*>(_Free), _Slot_count);
+            }
+
+            size_t _Page_size() const noexcept {
+                return _Mypage;
+            }
+
+            const void* _Begin() const noexcept {
+                return _Mybegin;
+            }
+
+            size_t _Size() const noexcept {
+                return _Distance_between(_Mybegin, _Myend);
+            }
+
+            bool _Contains(const void* const _Ptr) const noexcept {
+                return _Ptr >= _Mybegin && _Ptr < _Myend;
+            }
+
+            void* _Allocate(const size_t _Size, size_t _Align) noexcept {
+                // places the block at either end of a free page, so that one of its neighbours is a guard page
+                ::std::lock_guard<_Spin_lock> _Guard(_Mylock);
+                if (_Myfree_count == 0) { // every slot is taken
+                    return nullptr;
+                }
+
+                const size_t _Slot_idx = _Myfree[_Myfree_head];
+                _Myfree_head           = (_Myfree_head + 1) % _Myslot_count;
+                --_Myfree_count;
+
+                unsigned char* const _Page = _Slot_page(_Slot_idx);
+                _Protect_guard_page(_Page, _Mypage, true);
+                _Align              = _Get_effective_alignment(_Align);
+                const bool _Right   = ++_Mysamples % 2 != 0; // alternate between overruns and underruns
+                void* const _Block  = _Right ? _Page + ((_Mypage - _Size) & ~(_Align - 1)) : _Page;
+                _Myslots[_Slot_idx] = _Guarded_slot{_Block, _Size, true};
+                return _Block;
+            }
+
+            void _Deallocate(void* const _Ptr) noexcept {
+                // protects the page, so that any later access faults
+                ::std::lock_guard<_Spin_lock> _Guard(_Mylock);
+                const size_t _Page_idx = _Distance_between(_Mybegin, _Ptr) / _Mypage;
+                // Note: _REPORT_ERROR() does not abort in every configuration. An invalid deallocation must not
+                //       reach the free list either way, otherwise the slot would be handed out twice.
+                if (_Page_idx % 2 == 0) { // the pointer points to a guard page
+                    _REPORT_ERROR("Invalid deallocation of 0x%p, which is a guard page.", _Ptr);
+                    return;
+                }
+
+                _Guarded_slot& _Slot = _Myslots[_Page_idx / 2];
+                if (!_Slot._Live) { // the slot is already free
+                    _REPORT_ERROR("Double deallocation of guarded block at 0x%p.", _Ptr);
+                    return;
+                } else if (_Slot._Block != _Ptr) { // the pointer points inside the block
+                    _REPORT_ERROR("Invalid deallocation of 0x%p, the block begins at 0x%p.", _Ptr, _Slot._Block);
+                    return;
+                }
+
+                _Slot._Live = false;
+                _Protect_guard_page(_Slot_page(_Page_idx / 2), _Mypage, false);
+                _Myfree[(_Myfree_head + _Myfree_count) % _Myslot_count] = _Page_idx / 2;
+                ++_Myfree_count;
+            }
+
+            void _Report_fault(const void* const _Addr) const noexcept {
+                // describes an access that faulted inside the pool, called from the fault handler
+                _Fault_message _Msg;
+                const size_t _Page_idx = _Distance_between(_Mybegin, _Addr) / _Mypage;
+                if (_Page_idx % 2 != 0) { // a slot page, only a freed slot is inaccessible
+                    _Append_block_fault(_Msg, "Use-after-free", _Myslots[_Page_idx / 2], _Addr);
+                    return;
+                }
+
+                // a guard page, blame the nearer of the live blocks around it
+                const size_t _Next_slot = _Page_idx / 2;
+                const _Guarded_slot* const _Before =
+                    _Next_slot > 0 && _Myslots[_Next_slot - 1]._Live ? &_Myslots[_Next_slot - 1] : nullptr;
+                const _Guarded_slot* const _After =
+                    _Next_slot < _Myslot_count && _Myslots[_Next_slot]._Live ? &_Myslots[_Next_slot] : nullptr;
+                size_t _Overrun  = static_cast<size_t>(-1);
+                size_t _Underrun = static_cast<size_t>(-1);
+                if (_Before) { // the distance past the end of the block before the guard page
+                    _Overrun = _Distance_between(_Adjust_address_by_offset(_Before->_Block, _Before->_Size), _Addr);
+                }
+
+                if (_After) { // the distance before the beginning of the block after the guard page
+                    _Underrun = _Distance_between(_Addr, _After->_Block);
+                }
+
+                if (_After && _Underrun < _Overrun) {
+                    _Append_block_fault(_Msg, "Buffer underrun", *_After, _Addr);
+                } else if (_Before) {
+                    _Append_block_fault(_Msg, "Buffer overrun", *_Before, _Addr);
+                } else {
+                    _Msg._Append("Invalid access to guard page at ");
+                    _Msg._Append_address(_Addr);
+                    _Msg._Append(".\n");
+                    _Msg._Write();
+                }
+            }
+
+        private:
+            static void _Append_block_fault(_Fault_message& _Msg, const char* const _Kind,
+                const _Guarded_slot& _Slot, const void* const _Addr) noexcept {
+                // writes "<kind> of guarded block at <block> (<size> bytes), accessed at <address>."
+                _Msg._Append(_Kind);
+                _Msg._Append(" of guarded block at ");
+                _Msg._Append_address(_Slot._Block);
+                _Msg._Append(" (");
+                _Msg._Append_size(_Slot._Size);
+                _Msg._Append(" bytes), accessed at ");
+                _Msg._Append_address(_Addr);
+                _Msg._Append(".\n");
+                _Msg._Write();
+            }
+
+            unsigned char* _Slot_page(const size_t _Slot_idx) const noexcept {
+                // guard pages have even indices, slot pages have odd ones
+                return _Mybegin + (2 * _Slot_idx + 1) * _Mypage;
+            }
+
+            unsigned char* const _Mybegin;
+            unsigned char* const _Myend;
+            const size_t _Mypage;
+            _Guarded_slot* const _Myslots;
+            size_t* const _Myfree; // ring buffer of free slots, the least recently freed one comes first
+            const size_t _Myslot_count;
+            size_t _Myfree_head;
+            size_t _Myfree_count;
+            size_t _Mysamples;
+            _Spin_lock _Mylock;
+        };
+
+        // the pool, created by the first start_guarded_sampling() and never destroyed
+        ::std::atomic<_Guarded_pool*> _Guarded_pool_instance{nullptr};
+
+        // the average number of allocations between two guarded ones
+        ::std::atomic<size_t> _Guarded_sample_rate{default_guarded_sample_rate};
+
+        struct _Guarded_sampler_state { // per-thread sampling state
+            size_t _Allocations_until_sample = 0;
+            uint64_t _Seed                   = 0; // the state of the random number generator, zero if not seeded
+        };
+
+        thread_local _Guarded_sampler_state _Thread_guarded_sampler;
+
+        inline size_t _Next_guarded_sample(_Guarded_sampler_state& _State) noexcept {
+            // draws the number of allocations until the next sample, uniformly from [1, 2 * rate - 1]
+            if (_State._Seed == 0) { // seed from the state's address, which differs between threads
+                _State._Seed = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(&_State)) | 1;
+            }
+
+            _State._Seed ^= _State._Seed << 13;
+            _State._Seed ^= _State._Seed >> 7;
+            _State._Seed ^= _State._Seed << 17;
+            const size_t _Rate = _Guarded_sample_rate.load(::std::memory_order_relaxed);
+            return _Rate > 1 ? 1 + static_cast<size_t>(_State._Seed % (2 * _Rate - 1)) : 1;
+        }
+
+#ifdef _MJX_WINDOWS
+        ::LONG CALLBACK _Handle_guarded_fault(::EXCEPTION_POINTERS* const _Info) noexcept {
+            // reports access violations inside the pool, then lets the next handler deal with the exception
+            const ::EXCEPTION_RECORD* const _Record = _Info->ExceptionRecord;
+            if (_Record->ExceptionCode == EXCEPTION_ACCESS_VIOLATION && _Record->NumberParameters >= 2) {
+                const void* const _Addr    = reinterpret_cast<const void*>(_Record->ExceptionInformation[1]);
+                _Guarded_pool* const _Pool = _Guarded_pool_instance.load(::std::memory_order_acquire);
+                if (_Pool && _Pool->_Contains(_Addr)) {
+                    _Pool->_Report_fault(_Addr);
+                }
+            }
+
+            return EXCEPTION_CONTINUE_SEARCH;
+        }
+
+        inline void _Install_guarded_fault_handler() noexcept {
+            // the handler runs before any frame-based handler, so that the fault is reported even if it is caught
+            ::AddVectoredExceptionHandler(1, _Handle_guarded_fault);
+        }
+#else // ^^^ _MJX_WINDOWS ^^^ / vvv _MJX_LINUX vvv
+        struct sigaction _Previous_fault_action;
+
+        void _Handle_guarded_fault(int, ::siginfo_t* const _Info, void*) noexcept {
+            // reports faults inside the pool, then restores the previous handler, which handles the fault
+            // when the faulting instruction is executed again
+            _Guarded_pool* const _Pool = _Guarded_pool_instance.load(::std::memory_order_acquire);
+            if (_Pool && _Pool->_Contains(_Info->si_addr)) {
+                _Pool->_Report_fault(_Info->si_addr);
+            }
+
+            ::sigaction(SIGSEGV, &_Previous_fault_action, nullptr);
+        }
+
+        inline void _Install_guarded_fault_handler() noexcept {
+            struct sigaction _Action = {};
+            _Action.sa_sigaction     = _Handle_guarded_fault;
+            _Action.sa_flags         = SA_SIGINFO;
+            ::sigemptyset(&_Action.sa_mask);
+            ::sigaction(SIGSEGV, &_Action, &_Previous_fault_action);
+        }
+#endif // _MJX_WINDOWS
+
+        void* _Try_allocate_guarded(const size_t _Size, const size_t _Align) noexcept {
+            _Guarded_sampler_state& _State = _Thread_guarded_sampler;
+            if (_State._Seed == 0) { // first allocation on this thread, draw the initial distance
+                _State._Allocations_until_sample = _Next_guarded_sample(_State);
+            }
+
+            if (_State._Allocations_until_sample > 1) { // not sampled
+                --_State._Allocations_until_sample;
+                return nullptr;
+            }
+
+            _State._Allocations_until_sample = _Next_guarded_sample(_State);
+            _Guarded_pool* const _Pool       = _Guarded_pool_instance.load(::std::memory_order_acquire);
+            if (!_Pool || _Size > _Pool->_Page_size() || _Align > _Pool->_Page_size()) { // does not fit in a page
+                return nullptr;
+            }
+
+            return _Pool->_Allocate(_Size, _Align);
+        }
+
+        bool _Try_deallocate_guarded(void* const _Ptr) noexcept {
+            _Guarded_pool* const _Pool = _Guarded_pool_instance.load(::std::memory_order_acquire);
+            if (!_Pool || !_Pool->_Contains(_Ptr)) { // not a guarded block
+                return false;
+            }
+
+            _Pool->_Deallocate(_Ptr);
+            return true;
+        }
+    } // namespace mjxsdk_impl
+
+    bool start_guarded_sampling(const size_t _Sample_rate, const size_t _Slot_count) noexcept {
+        static ::std::mutex _Mtx;
+        ::std::lock_guard<::std::mutex> _Guard(_Mtx);
+        if (!mjxsdk_impl::_Guarded_pool_instance.load(::std::memory_order_relaxed)) { // reserve the pool
+            mjxsdk_impl::_Guarded_pool* const _Pool =
+                mjxsdk_impl::_Guarded_pool::_Create(_Slot_count > 0 ? _Slot_count : 1);
+            if (!_Pool) {
+                return false;
+            }
+
+            mjxsdk_impl::_Install_guarded_fault_handler();
+            mjxsdk_impl::_Guarded_pool_instance.store(_Pool, ::std::memory_order_release);
+            mjxsdk_impl::_Guarded_pool_size.store(_Pool->_Size(), ::std::memory_order_relaxed);
+            mjxsdk_impl::_Guarded_pool_begin.store(
+                reinterpret_cast<uintptr_t>(_Pool->_Begin()), ::std::memory_order_release);
+        }
+
+        mjxsdk_impl::_Guarded_sample_rate.store(_Sample_rate, ::std::memory_order_relaxed);
+        mjxsdk_impl::_Enable_allocation_hook(mjxsdk_impl::_Guarded_sampling_hook);
+        return true;
+    }
+
+    void stop_guarded_sampling() noexcept {
+        mjxsdk_impl::_Disable_allocation_hook(mjxsdk_impl::_Guarded_sampling_hook);
+    }
+
+    bool is_guarded_sampling_active() noexcept {
+        return mjxsdk_impl::_Is_allocation_hook_enabled(mjxsdk_impl::_Guarded_sampling_hook);
+    }
+
+    bool is_guarded_block(const void* const _Ptr) noexcept {
+        mjxsdk_impl::_Guarded_pool* const _Pool =
+            mjxsdk_impl::_Guarded_pool_instance.load(::std::memory_order_acquire);
+        return _Pool && _Pool->_Contains(_Ptr);
+    }
+} // namespace mjx
\ No newline at end of file
@@ -0,0 +1,33 @@
+// guarded_sampling.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _MJXSDK_MEMORY_GUARDED_SAMPLING_HPP_
+#define _MJXSDK_MEMORY_GUARDED_SAMPLING_HPP_
+#include <cstddef>
+#include <mjxsdk/core/export.hpp>
+
+namespace mjx {
+    // the default average number of allocations between two guarded ones
+    inline constexpr size_t default_guarded_sample_rate = 5000;
+
+    // the default number of guarded blocks that can exist at once
+    inline constexpr size_t default_guarded_slot_count = 256;
+
+    // Note: A sampled system_allocator block that fits in a page is placed in its own page of a dedicated pool,
+    //       between two inaccessible guard pages, and its page is made inaccessible once it is deallocated.
+    //       Overruns, underruns and use-after-free therefore fault at the faulting instruction.
+    //       The pool is reserved by the first start and keeps its slot count, freed slots are reused
+    //       in FIFO order to keep freed pages protected for as long as possible.
+    _MJXSDK_EXPORT bool start_guarded_sampling(size_t _Sample_rate = default_guarded_sample_rate,
+        size_t _Slot_count = default_guarded_slot_count) noexcept;
+    _MJXSDK_EXPORT void stop_guarded_sampling() noexcept;
+    _MJXSDK_EXPORT bool is_guarded_sampling_active() noexcept;
+
+    // checks whether the block was placed in the guarded pool
+    _MJXSDK_EXPORT bool is_guarded_block(const void* const _Ptr) noexcept;
+} // namespace mjx
+
+#endif // _MJXSDK_MEMORY_GUARDED_SAMPLING_HPP_
\ No newline at end of file
@@ -0,0 +1,304 @@
+// heap_profiler.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mjxsdk/core/macros.hpp>
+#include <mjxsdk/memory/heap_profiler.hpp>
+#include <mjxsdk/memory/impl/allocation_hooks.hpp>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#ifdef _MJX_WINDOWS
+#include <mjxsdk/core/impl/tinywin.hpp>
+#else // ^^^ _MJX_WINDOWS ^^^ / vvv _MJX_LINUX vvv
+#include <execinfo.h>
+#endif // _MJX_WINDOWS
+
+namespace mjx {
+    namespace mjxsdk_impl {
+        // the largest number of frames captured for a single sample
+        inline constexpr int _Max_sample_frames = 32;
+
+        // the frames of _Capture_sample_stack() and _Profile_allocation()
+        inline constexpr int _Profiler_frames = 2;
+
+        struct _Sample_stack { // call stack of a sampled allocation
+            void* _Frames[_Max_sample_frames];
+            int _Depth;
+
+            bool operator==(const _Sample_stack& _Other) const noexcept {
+                return _Depth == _Other._Depth
+                    && ::memcmp(_Frames, _Other._Frames, static_cast<size_t>(_Depth) * sizeof(void*)) == 0;
+            }
+        };
+
+        struct _Sample_stack_hash {
+            size_t operator()(const _Sample_stack& _Stack) const noexcept {
+                // FNV-1a over the frame addresses
+                uint64_t _Hash = 0xCBF2'9CE4'8422'2325;
+                for (int _Idx = 0; _Idx < _Stack._Depth; ++_Idx) {
+                    _Hash ^= static_cast<uint64_t>(reinterpret_cast<uintptr_t>(_Stack._Frames[_Idx]));
+                    _Hash *= 0x0000'0100'0000'01B3;
+                }
+
+                return static_cast<size_t>(_Hash);
+            }
+        };
+
+        struct _Sample_site { // samples taken at a single call stack
+            uint64_t _Live_count;
+            uint64_t _Live_bytes;
+            uint64_t _Total_count;
+            uint64_t _Total_bytes;
+        };
+
+        struct _Sampled_block { // live sampled block
+            size_t _Size;
+            _Sample_site* _Site;
+        };
+
+        struct _Sampler_state { // per-thread sampling state
+            int64_t _Bytes_until_sample = 0; // the number of bytes to allocate before the next sample
+            uint64_t _Seed              = 0; // the state of the random number generator, zero if not seeded
+            bool _Busy                  = false; // set while the thread is inside the profiler
+        };
+
+        thread_local _Sampler_state _Thread_sampler;
+
+        _MJX_NOINLINE int _Capture_sample_stack(void** const _Frames) noexcept {
+            // captures the caller's stack without the frames of the profiler itself
+#ifdef _MJX_WINDOWS
+            return static_cast<int>(
+                ::RtlCaptureStackBackTrace(_Profiler_frames, _Max_sample_frames, _Frames, nullptr));
+#else // ^^^ _MJX_WINDOWS ^^^ / vvv _MJX_LINUX vvv
+            void* _Buf[_Max_sample_frames + _Profiler_frames];
+            const int _Depth = ::backtrace(_Buf, _Max_sample_frames + _Profiler_frames) - _Profiler_frames;
+            if (_Depth <= 0) {
+                return 0;
+            }
+
+            ::memcpy(_Frames, _Buf + _Profiler_frames, static_cast<size_t>(_Depth) * sizeof(void*));
+            return _Depth;
+#endif // _MJX_WINDOWS
+        }
+
+        inline size_t _Hash_block_address(const void* const _Ptr) noexcept {
+            // blocks are at least 8-byte aligned, so the lowest bits carry no information
+            const uint64_t _Value = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(_Ptr)) >> 3;
+            return static_cast<size_t>(_Value * 0x9E37'79B9'7F4A'7C15 >> 32);
+        }
+
+        class _Heap_profiler { // singleton class that stores the sampled blocks
+        public:
+            _Heap_profiler(const _Heap_profiler&)            = delete;
+            _Heap_profiler& operator=(const _Heap_profiler&) = delete;
+
+            static _Heap_profiler& _Instance() noexcept {
+                // never destroyed, sampled blocks may still be deallocated during static destruction
+                static _Heap_profiler* const _Obj = new _Heap_profiler();
+                return *_Obj;
+            }
+
+            size_t _Interval() const noexcept {
+                return _Myinterval.load(::std::memory_order_relaxed);
+            }
+
+            void _Start(const size_t _Interval) noexcept {
+                ::std::lock_guard<::std::mutex> _Guard(_Mymtx);
+                _Myblocks.clear();
+                _Mysites.clear();
+                for (::std::atomic<uint32_t>& _Count : _Myfilter) {
+                    _Count.store(0, ::std::memory_order_relaxed);
+                }
+
+                _Myinterval.store(_Interval > 0 ? _Interval : 1, ::std::memory_order_relaxed);
+            }
+
+            void _Record(void* const _Ptr, const size_t _Size, const _Sample_stack& _Stack) noexcept {
+                ::std::lock_guard<::std::mutex> _Guard(_Mymtx);
+                try {
+                    // references to the elements of an unordered_map remain valid after rehashing
+                    _Sample_site& _Site = _Mysites.try_emplace(_Stack, _Sample_site{}).first->second;
+                    const auto _Result  = _Myblocks.try_emplace(_Ptr, _Sampled_block{_Size, &_Site});
+                    if (_Result.second) { // a new block, count it in the filter
+                        _Myfilter[_Hash_block_address(_Ptr) % _Filter_size].fetch_add(
+                            1, ::std::memory_order_relaxed);
+                    } else { // the block was freed while the profiler was stopped, replace the stale sample
+                        _Sampled_block& _Stale = _Result.first->second;
+                        --_Stale._Site->_Live_count;
+                        _Stale._Site->_Live_bytes -= _Stale._Size;
+                        _Stale = _Sampled_block{_Size, &_Site};
+                    }
+
+                    ++_Site._Live_count;
+                    _Site._Live_bytes += _Size;
+                    ++_Site._Total_count;
+                    _Site._Total_bytes += _Size;
+                } catch (const ::std::bad_alloc&) { // no memory to track the block, drop the sample
+                }
+            }
+
+            void _Forget(void* const _Ptr) noexcept {
+                ::std::atomic<uint32_t>& _Count = _Myfilter[_Hash_block_address(_Ptr) % _Filter_size];
+                if (_Count.load(::std::memory_order_relaxed) == 0) { // the block was certainly not sampled
+                    return;
+                }
+
+                ::std::lock_guard<::std::mutex> _Guard(_Mymtx);
+                const auto _Iter = _Myblocks.find(_Ptr);
+                if (_Iter == _Myblocks.end()) { // the block shares the filter slot with a sampled one
+                    return;
+                }
+
+                _Sample_site* const _Site = _Iter->second._Site;
+                --_Site->_Live_count;
+                _Site->_Live_bytes -= _Iter->second._Size;
+                _Myblocks.erase(_Iter);
+                _Count.fetch_sub(1, ::std::memory_order_relaxed);
+            }
+
+            bool _Write(FILE* const _File) noexcept {
+                ::std::lock_guard<::std::mutex> _Guard(_Mymtx);
+                _Sample_site _Total = {};
+                for (const auto& _Pair : _Mysites) {
+                    _Total._Live_count += _Pair.second._Live_count;
+                    _Total._Live_bytes += _Pair.second._Live_bytes;
+                    _Total._Total_count += _Pair.second._Total_count;
+                    _Total._Total_bytes += _Pair.second._Total_bytes;
+                }
+
+                // the header holds the totals and the sampling interval, which pprof uses to unsample
+                ::fprintf(_File, "heap profile: %6llu: %8llu [%6llu: %8llu] @ heap_v2/%zu\n",
+                    static_cast<unsigned long long>(_Total._Live_count),
+                    static_cast<unsigned long long>(_Total._Live_bytes),
+                    static_cast<unsigned long long>(_Total._Total_count),
+                    static_cast<unsigned long long>(_Total._Total_bytes), _Interval());
+                for (const auto& _Pair : _Mysites) {
+                    const _Sample_site& _Site = _Pair.second;
+                    ::fprintf(_File, "%6llu: %8llu [%6llu: %8llu] @",
+                        static_cast<unsigned long long>(_Site._Live_count),
+                        static_cast<unsigned long long>(_Site._Live_bytes),
+                        static_cast<unsigned long long>(_Site._Total_count),
+                        static_cast<unsigned long long>(_Site._Total_bytes));
+                    for (int _Idx = 0; _Idx < _Pair.first._Depth; ++_Idx) {
+                        ::fprintf(_File, " %p", _Pair.first._Frames[_Idx]);
+                    }
+
+                    ::fputc('\n', _File);
+                }
+
+                return _Write_mapped_libraries(_File) && ::ferror(_File) == 0;
+            }
+
+        private:
+            // the number of counters in the filter that lets most deallocations skip the lock
+            static constexpr size_t _Filter_size = 4096;
+
+            _Heap_profiler() noexcept
+                : _Myinterval(default_heap_sampling_interval), _Mymtx(), _Mysites(), _Myblocks(), _Myfilter() {}
+
+            static bool _Write_mapped_libraries(FILE* const _File) noexcept {
+                // pprof needs the memory map to symbolize the addresses
+                ::fputs("\nMAPPED_LIBRARIES:\n", _File);
+#ifdef _MJX_LINUX
+                FILE* const _Maps = ::fopen("/proc/self/maps", "r");
+                if (!_Maps) {
+                    return false;
+                }
+
+                char _Buf[4096];
+                size_t _Read;
+                while ((_Read = ::fread(_Buf, 1, sizeof(_Buf), _Maps)) > 0) {
+                    ::fwrite(_Buf, 1, _Read, _File);
+                }
+
+                ::fclose(_Maps);
+#endif // _MJX_LINUX
+                return true;
+            }
+
+            ::std::atomic<size_t> _Myinterval; // the average number of bytes between two samples
+            ::std::mutex _Mymtx;
+            ::std::unordered_map<_Sample_stack, _Sample_site, _Sample_stack_hash> _Mysites;
+            ::std::unordered_map<void*, _Sampled_block> _Myblocks;
+            ::std::array<::std::atomic<uint32_t>, _Filter_size> _Myfilter; // sampled blocks per address hash
+        };
+
+        inline int64_t _Next_sample_distance(_Sampler_state& _State, const size_t _Interval) noexcept {
+            // draws the distance to the next sample from an exponential distribution (xorshift64* generator)
+            if (_State._Seed == 0) { // seed from the state's address, which differs between threads
+                _State._Seed = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(&_State)) | 1;
+            }
+
+            _State._Seed ^= _State._Seed >> 12;
+            _State._Seed ^= _State._Seed << 25;
+            _State._Seed ^= _State._Seed >> 27;
+            const double _Uniform = static_cast<double>((_State._Seed * 0x2545'F491'4F6C'DD1D) >> 11) * 0x1.0p-53;
+            const double _Distance = -::std::log(1.0 - _Uniform) * static_cast<double>(_Interval);
+            return _Distance < 1.0 ? 1 : static_cast<int64_t>(_Distance);
+        }
+
+        void _Profile_allocation(void* const _Ptr, const size_t _Size) noexcept {
+            _Sampler_state& _State = _Thread_sampler;
+            if (_State._Busy) { // the profiler allocates for itself, do not sample it
+                return;
+            }
+
+            _Heap_profiler& _Profiler = _Heap_profiler::_Instance();
+            if (_State._Seed == 0) { // first allocation on this thread, draw the initial distance
+                _State._Bytes_until_sample = _Next_sample_distance(_State, _Profiler._Interval());
+            }
+
+            _State._Bytes_until_sample -= static_cast<int64_t>(_Size);
+            if (_State._Bytes_until_sample > 0) { // not sampled
+                return;
+            }
+
+            _State._Busy = true;
+            _Sample_stack _Stack{};
+            _Stack._Depth = _Capture_sample_stack(_Stack._Frames);
+            _Profiler._Record(_Ptr, _Size, _Stack);
+            _State._Bytes_until_sample = _Next_sample_distance(_State, _Profiler._Interval());
+            _State._Busy               = false;
+        }
+
+        void _Profile_deallocation(void* const _Ptr) noexcept {
+            _Sampler_state& _State = _Thread_sampler;
+            if (!_State._Busy) {
+                _State._Busy = true;
+                _Heap_profiler::_Instance()._Forget(_Ptr);
+                _State._Busy = false;
+            }
+        }
+    } // namespace mjxsdk_impl
+
+    void start_heap_profiler(const size_t _Interval) noexcept {
+        mjxsdk_impl::_Heap_profiler::_Instance()._Start(_Interval);
+        mjxsdk_impl::_Enable_allocation_hook(mjxsdk_impl::_Heap_profiler_hook);
+    }
+
+    void stop_heap_profiler() noexcept {
+        mjxsdk_impl::_Disable_allocation_hook(mjxsdk_impl::_Heap_profiler_hook);
+    }
+
+    bool is_heap_profiler_active() noexcept {
+        return mjxsdk_impl::_Is_allocation_hook_enabled(mjxsdk_impl::_Heap_profiler_hook);
+    }
+
+    bool write_heap_profile(const char* const _Path) noexcept {
+        FILE* const _File = ::fopen(_Path, "w");
+        if (!_File) {
+            return false;
+        }
+
+        const bool _Result = mjxsdk_impl::_Heap_profiler::_Instance()._Write(_File);
+        return ::fclose(_File) == 0 && _Result;
+    }
+} // namespace mjx
\ No newline at end of file
@@ -0,0 +1,28 @@
+// heap_profiler.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _MJXSDK_MEMORY_HEAP_PROFILER_HPP_
+#define _MJXSDK_MEMORY_HEAP_PROFILER_HPP_
+#include <cstddef>
+#include <mjxsdk/core/export.hpp>
+
+namespace mjx {
+    // the default average number of bytes allocated between two samples
+    inline constexpr size_t default_heap_sampling_interval = 512 * 1024;
+
+    // Note: The profiler observes every allocator that reports its blocks, see leak_registry.hpp.
+    //       Each thread samples one allocation every _Interval bytes on average (geometric sampling),
+    //       captures its call stack and tracks the block until it is deallocated. Samples taken before
+    //       stop_heap_profiler() are kept, so that a profile can still be written, until the next start.
+    _MJXSDK_EXPORT void start_heap_profiler(size_t _Interval = default_heap_sampling_interval) noexcept;
+    _MJXSDK_EXPORT void stop_heap_profiler() noexcept;
+    _MJXSDK_EXPORT bool is_heap_profiler_active() noexcept;
+
+    // writes the live sampled blocks, grouped by call stack, in the legacy pprof heap profile format
+    _MJXSDK_EXPORT bool write_heap_profile(const char* const _Path) noexcept;
+} // namespace mjx
+
+#endif // _MJXSDK_MEMORY_HEAP_PROFILER_HPP_
\ No newline at end of file
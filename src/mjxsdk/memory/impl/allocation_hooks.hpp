@@ -0,0 +1,169 @@
+// allocation_hooks.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _MJXSDK_MEMORY_IMPL_ALLOCATION_HOOKS_HPP_
+#define _MJXSDK_MEMORY_IMPL_ALLOCATION_HOOKS_HPP_
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mjxsdk/memory/allocator.hpp>
+
+namespace mjx {
+    namespace mjxsdk_impl {
+        enum _Allocation_hook : uint32_t { // diagnostic tools that observe the allocators
+            _Heap_profiler_hook    = 0x1,
+            _Leak_registry_hook    = 0x2,
+            _Guarded_sampling_hook = 0x4, // new blocks may be placed in the guarded pool
+            _Debug_allocation_hook = 0x8, // new blocks are debug blocks
+            _Debug_block_hook      = 0x10, // debug blocks were allocated, deallocated blocks may be debug blocks
+            _Allocation_trace_hook = 0x20
+        };
+
+        // the set of enabled hooks, system_allocator reads it once per call and leaves the fast path
+        // only if any hook is enabled
+        inline ::std::atomic<uint32_t> _Enabled_allocation_hooks{0};
+
+        inline bool _Has_allocation_hooks() noexcept {
+            return _Enabled_allocation_hooks.load(::std::memory_order_relaxed) != 0;
+        }
+
+        inline bool _Is_allocation_hook_enabled(const _Allocation_hook _Hook) noexcept {
+            return (_Enabled_allocation_hooks.load(::std::memory_order_relaxed) & _Hook) != 0;
+        }
+
+        inline void _Enable_allocation_hook(const _Allocation_hook _Hook) noexcept {
+            _Enabled_allocation_hooks.fetch_or(_Hook, ::std::memory_order_relaxed);
+        }
+
+        inline void _Disable_allocation_hook(const _Allocation_hook _Hook) noexcept {
+            _Enabled_allocation_hooks.fetch_and(~static_cast<uint32_t>(_Hook), ::std::memory_order_relaxed);
+        }
+
+        // the hooks that only observe blocks, they never decide where a block is placed
+        inline constexpr uint32_t _Observer_hooks =
+            _Heap_profiler_hook | _Leak_registry_hook | _Allocation_trace_hook;
+
+        // the number of internal allocation scopes that are active on the calling thread
+        inline thread_local size_t _Internal_allocation_depth = 0;
+
+        // Note: Blocks are reported by the allocator that hands them out, with its own tag. Chunks that
+        //       an allocator obtains from its upstream allocator for its own use are allocated
+        //       in an internal scope, so that they are not reported as well.
+        class _Internal_allocation_scope { // hides the enclosed allocations from the observer hooks
+        public:
+            _Internal_allocation_scope() noexcept {
+                ++_Internal_allocation_depth;
+            }
+
+            ~_Internal_allocation_scope() noexcept {
+                --_Internal_allocation_depth;
+            }
+
+            _Internal_allocation_scope(const _Internal_allocation_scope&)            = delete;
+            _Internal_allocation_scope& operator=(const _Internal_allocation_scope&) = delete;
+        };
+
+        inline bool _Is_reporting_allocations() noexcept {
+            // checks whether any observer hook is enabled and the calling thread is not in an internal scope
+            return (_Enabled_allocation_hooks.load(::std::memory_order_relaxed) & _Observer_hooks) != 0
+                && _Internal_allocation_depth == 0;
+        }
+
+        // defined by the heap profiler
+        void _Profile_allocation(void* const _Ptr, const size_t _Size) noexcept;
+        void _Profile_deallocation(void* const _Ptr) noexcept;
+
+        // defined by the leak registry
+        void _Register_allocation(void* const _Ptr, const size_t _Size,
+            const allocator_tag _Tag, const void* const _Return_address) noexcept;
+        void _Unregister_allocation(void* const _Ptr) noexcept;
+
+        // defined by the allocation trace recorder
+        void _Trace_allocation(
+            void* const _Ptr, const size_t _Size, const size_t _Align, const allocator_tag _Tag) noexcept;
+        void _Trace_deallocation(
+            void* const _Ptr, const size_t _Size, const size_t _Align, const allocator_tag _Tag) noexcept;
+
+        // defined by guarded sampling
+        void* _Try_allocate_guarded(const size_t _Size, const size_t _Align) noexcept;
+        bool _Try_deallocate_guarded(void* const _Ptr) noexcept;
+
+        // the address range of the guarded pool, published by the first start_guarded_sampling() and never changed
+        inline ::std::atomic<uintptr_t> _Guarded_pool_begin{0};
+        inline ::std::atomic<size_t> _Guarded_pool_size{0};
+
+        inline bool _Is_guarded_address(const void* const _Ptr) noexcept {
+            // checks whether the address lies in the guarded pool, a single load if the pool does not exist
+            const uintptr_t _Begin = _Guarded_pool_begin.load(::std::memory_order_relaxed);
+            return _Begin != 0
+                && reinterpret_cast<uintptr_t>(_Ptr) - _Begin < _Guarded_pool_size.load(::std::memory_order_relaxed);
+        }
+
+        // defined by the runtime debug allocation mode
+        bool _Register_debug_block(void* const _Ptr) noexcept;
+        bool _Unregister_debug_block(void* const _Ptr) noexcept;
+
+        inline void _Invoke_allocation_hooks(void* const _Ptr, const size_t _Size, const size_t _Align,
+            const allocator_tag _Tag, const void* const _Return_address) noexcept {
+            // notifies the enabled hooks about a new block, _Return_address identifies the call site
+            if (_Internal_allocation_depth != 0) { // the block is used internally by another allocator
+                return;
+            }
+
+            const uint32_t _Hooks = _Enabled_allocation_hooks.load(::std::memory_order_relaxed);
+            if (_Hooks & _Heap_profiler_hook) {
+                _Profile_allocation(_Ptr, _Size);
+            }
+
+            if (_Hooks & _Leak_registry_hook) {
+                _Register_allocation(_Ptr, _Size, _Tag, _Return_address);
+            }
+
+            if (_Hooks & _Allocation_trace_hook) {
+                _Trace_allocation(_Ptr, _Size, _Align, _Tag);
+            }
+        }
+
+        inline void _Invoke_deallocation_hooks(
+            void* const _Ptr, const size_t _Size, const size_t _Align, const allocator_tag _Tag) noexcept {
+            // notifies the enabled hooks about a block that is about to be freed
+            if (_Internal_allocation_depth != 0) { // the block is used internally by another allocator
+                return;
+            }
+
+            const uint32_t _Hooks = _Enabled_allocation_hooks.load(::std::memory_order_relaxed);
+            if (_Hooks & _Heap_profiler_hook) {
+                _Profile_deallocation(_Ptr);
+            }
+
+            if (_Hooks & _Leak_registry_hook) {
+                _Unregister_allocation(_Ptr);
+            }
+
+            if (_Hooks & _Allocation_trace_hook) {
+                _Trace_deallocation(_Ptr, _Size, _Align, _Tag);
+            }
+        }
+
+        inline void _Report_allocation(void* const _Ptr, const size_t _Size, const size_t _Align,
+            const allocator_tag _Tag, const void* const _Return_address) noexcept {
+            // lets the observer hooks see a block handed out by an allocator other than system_allocator
+            if (_Is_reporting_allocations()) {
+                _Invoke_allocation_hooks(_Ptr, _Size, _Align, _Tag, _Return_address);
+            }
+        }
+
+        inline void _Report_deallocation(
+            void* const _Ptr, const size_t _Size, const size_t _Align, const allocator_tag _Tag) noexcept {
+            // lets the observer hooks see a block returned to an allocator other than system_allocator
+            if (_Is_reporting_allocations()) {
+                _Invoke_deallocation_hooks(_Ptr, _Size, _Align, _Tag);
+            }
+        }
+    } // namespace mjxsdk_impl
+} // namespace mjx
+
+#endif // _MJXSDK_MEMORY_IMPL_ALLOCATION_HOOKS_HPP_
\ No newline at end of file
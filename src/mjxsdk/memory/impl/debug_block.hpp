@@ -6,11 +6,12 @@
 #pragma once
 #ifndef _MJXSDK_MEMORY_IMPL_DEBUG_BLOCK_HPP_
 #define _MJXSDK_MEMORY_IMPL_DEBUG_BLOCK_HPP_
-#ifdef _DEBUG
 #include <cstdint>
+#include <cstring>
 #include <mjxsdk/core/impl/assert.hpp>
 #include <mjxsdk/core/impl/utils.hpp>
 #include <mjxsdk/memory/allocator.hpp>
+#include <mjxsdk/memory/impl/pointer_map.hpp>
 #include <mjxsdk/memory/impl/utils.hpp>
 
 namespace mjx {
@@ -78,9 +79,37 @@ namespace mjx {
             }
         };
 
+        // the smallest alignment for which the header is kept out of band, inline metadata would be padded
+        // to the alignment and waste about two alignment units per block
+        inline constexpr size_t _Out_of_band_alignment = 4096;
+
+        constexpr bool _Has_out_of_band_header(const size_t _Align) noexcept {
+            // checks whether the header is kept in the side table, the block then begins with the user block
+            // and only the overrun sentinel is inline
+            return _Align >= _Out_of_band_alignment;
+        }
+
+        constexpr size_t _Calculate_user_size(const size_t _Size, const size_t _Align) noexcept {
+            // inline metadata requires the user block to be a multiple of the alignment
+            return _Has_out_of_band_header(_Align) ? _Size : _Align_value(_Size, _Align);
+        }
+
+        constexpr intptr_t _Calculate_user_offset(const size_t _Align) noexcept {
+            return _Has_out_of_band_header(_Align) ? 0 : _Block_offset::_User_block(_Align);
+        }
+
+        constexpr size_t _Calculate_inline_header_size(const size_t _Align) noexcept {
+            // returns the number of leading bytes that hold the header, zero if it is kept out of band
+            return _Has_out_of_band_header(_Align) ? 0 : _Block_header_size;
+        }
+
         constexpr size_t _Calculate_block_size(const size_t _Size, const size_t _Align) noexcept {
             // calculates block size including user block and metadata
             constexpr size_t _Sentinel_size = sizeof(_Block_sentinel);
+            if (_Has_out_of_band_header(_Align)) { // only the overrun sentinel follows the user block
+                return _Size + _Sentinel_size;
+            }
+
             return _Align_value(_Block_header_size + _Sentinel_size, _Align)
                 + _Align_value(_Size + _Sentinel_size, _Align);
         }
@@ -96,6 +125,13 @@ namespace mjx {
             return _Block_size - _Block_offset::_Block_padding(_User_size, _Align);
         }
 
+        inline _Pointer_map<_Block_header>& _Get_out_of_band_headers() noexcept {
+            // the side table of headers, keyed by the user block,
+            // never destroyed, debug blocks may still be deallocated during static destruction
+            static _Pointer_map<_Block_header>* const _Headers = new _Pointer_map<_Block_header>();
+            return *_Headers;
+        }
+
         inline void _Fill_at(
             void* const _Dest, const size_t _Size, const intptr_t _Off, const int _Value) noexcept {
             // fills _Size bytes at (_Dest + _Off) with _Value
@@ -114,12 +150,21 @@ namespace mjx {
             ::memcpy(_Dest, _Adjust_address_by_offset(_Src, _Off), _Size);
         }
 
-        void* _Prepare_block(void* const _Block, const size_t _Block_size,
+        inline void* _Prepare_block(void* const _Block, const size_t _Block_size,
             const size_t _User_size, const size_t _Align, const allocator_tag _Tag) noexcept {
-            // embeds debug metadata into the given memory block
+            // embeds debug metadata into the given memory block, returns null if the header cannot be stored
             constexpr size_t _Sentinel_size = sizeof(_Block_sentinel);
             const _Block_header _Header     = {_User_size, _Align, _Tag, _Block_state::_Allocated};
             const _Block_sentinel _Sentinel;
+            if (_Has_out_of_band_header(_Align)) { // store the header in the side table
+                if (!_Get_out_of_band_headers()._Insert(_Block, _Header)) {
+                    return nullptr;
+                }
+
+                _Copy_dest_at(_Block, &_Sentinel, _Sentinel_size, _User_size);
+                return _Block;
+            }
+
             _Copy_dest_at(_Block, &_Header, _Block_header_size, _Block_offset::_Header);
             
             size_t _Padding = _Calculate_header_padding_size(_Align);
@@ -140,7 +185,7 @@ namespace mjx {
             return _Adjust_address_by_offset(_Block, _Block_offset::_User_block(_Align));
         }
 
-        void _Validate_block_state(
+        inline void _Validate_block_state(
             void* const _Block, const void* const _Ptr, _Block_header& _Header) noexcept {
             // validates the current block state and detects invalid memory usage
             switch (_Header._State) {
@@ -156,10 +201,14 @@ namespace mjx {
 
             // mark the block as deallocated to prevent double-free
             _Header._State = _Block_state::_Deallocated;
-            _Copy_dest_at(_Block, &_Header, _Block_header_size, _Block_offset::_Header);
+            if (_Has_out_of_band_header(_Header._Align)) { // the block begins with the user block
+                _Get_out_of_band_headers()._Insert(_Ptr, _Header);
+            } else {
+                _Copy_dest_at(_Block, &_Header, _Block_header_size, _Block_offset::_Header);
+            }
         }
 
-        _Block_metadata _Extract_metadata(
+        inline _Block_metadata _Extract_metadata(
             void* const _Block, const size_t _Size, const size_t _Align) noexcept {
             // extracts block metadata (header and sentinels) from the given memory block
             constexpr size_t _Sentinel_size = sizeof(_Block_sentinel);
@@ -172,11 +221,21 @@ namespace mjx {
             return _Meta;
         }
 
-        void* _Extract_and_validate_block(void* const _Ptr, const size_t _Size,
+        inline void* _Extract_and_validate_block(void* const _Ptr, const size_t _Size,
             const size_t _Align, const allocator_tag _Tag) noexcept {
             // extracts the original block from the user pointer and validates its metadata and integrity
-            void* const _Block    = _Adjust_address_by_offset(_Ptr, -_Block_offset::_User_block(_Align));
-            _Block_metadata _Meta = _Extract_metadata(_Block, _Size, _Align);
+            void* const _Block = _Adjust_address_by_offset(_Ptr, -_Calculate_user_offset(_Align));
+            _Block_metadata _Meta;
+            if (_Has_out_of_band_header(_Align)) { // the header is in the side table, there is no underrun sentinel
+                if (!_Get_out_of_band_headers()._Find(_Ptr, &_Meta._Header)) {
+                    _REPORT_ERROR("Corrupted block at 0x%p. Memory was not allocated.", _Ptr);
+                }
+
+                _Copy_src_at(&_Meta._Overrun_sentinel, _Block, sizeof(_Block_sentinel), _Size);
+            } else {
+                _Meta = _Extract_metadata(_Block, _Size, _Align);
+            }
+
             if (_Meta._Header._Size != _Size) { // report size mismatch
                 _REPORT_ERROR("Corrupted block at 0x%p. Size is %zu, but should be %zu.",
                     _Ptr, _Size, _Meta._Header._Size);
@@ -206,6 +265,9 @@ namespace mjx {
             return _Block;
         }
 
+        // poisons the deallocated block and holds it in the quarantine before it is freed
+        void _Quarantine_debug_block(void* const _Block, const size_t _Size, const size_t _Align) noexcept;
+
         template <class _AllocFn>
         inline constexpr bool _Is_nothrow_alloc_fn = noexcept(
             noexcept(::std::declval<_AllocFn>()(size_t{0}, size_t{0})));
@@ -214,19 +276,24 @@ namespace mjx {
         inline constexpr bool _Is_nothrow_dealloc_fn = noexcept(
             noexcept(::std::declval<_DeallocFn>()(nullptr, size_t{0}, size_t{0})));
 
-        template <class _AllocFn>
-        inline void* _Allocate_debug_block(size_t _Size, size_t _Align, const allocator_tag _Tag,
-            _AllocFn&& _Alloc) noexcept(_Is_nothrow_alloc_fn<_AllocFn>) {
+        template <class _AllocFn, class _DeallocFn>
+        inline void* _Allocate_debug_block(size_t _Size, size_t _Align, const allocator_tag _Tag, _AllocFn&& _Alloc,
+            _DeallocFn&& _Dealloc) noexcept(_Is_nothrow_alloc_fn<_AllocFn> && _Is_nothrow_dealloc_fn<_DeallocFn>) {
             // allocates and prepares a debug block with alignment and metadata
             _Align                   = _Get_effective_alignment(_Align);
-            _Size                    = _Align_value(_Size, _Align);
+            _Size                    = _Calculate_user_size(_Size, _Align);
             const size_t _Block_size = _Calculate_block_size(_Size, _Align);
             void* const _Block       = _Alloc(_Block_size, _Align);
             if (!_Block) { // allocation failed, break
                 return nullptr;
             }
 
-            return _Prepare_block(_Block, _Block_size, _Size, _Align, _Tag);
+            void* const _Ptr = _Prepare_block(_Block, _Block_size, _Size, _Align, _Tag);
+            if (!_Ptr) { // the header cannot be stored, release the block
+                _Dealloc(_Block, _Block_size, _Align);
+            }
+
+            return _Ptr;
         }
 
         template <class _DeallocFn>
@@ -234,12 +301,11 @@ namespace mjx {
             const allocator_tag _Tag, _DeallocFn&& _Dealloc) noexcept(_Is_nothrow_dealloc_fn<_DeallocFn>) {
             // extracts and frees a debug block with alignment and metadata
             _Align = _Get_effective_alignment(_Align);
-            _Size  = _Align_value(_Size, _Align);
+            _Size  = _Calculate_user_size(_Size, _Align);
             _Dealloc(_Extract_and_validate_block(_Ptr, _Size, _Align, _Tag),
                 _Calculate_block_size(_Size, _Align), _Align);
         }
     } // namespace mjxsdk_impl
 } // namespace mjx
 
-#endif // _DEBUG
 #endif // _MJXSDK_MEMORY_IMPL_DEBUG_BLOCK_HPP_
\ No newline at end of file
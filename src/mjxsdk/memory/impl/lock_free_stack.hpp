@@ -0,0 +1,140 @@
+// lock_free_stack.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _MJXSDK_MEMORY_IMPL_LOCK_FREE_STACK_HPP_
+#define _MJXSDK_MEMORY_IMPL_LOCK_FREE_STACK_HPP_
+#include <atomic>
+#include <cstdint>
+
+namespace mjx {
+    namespace mjxsdk_impl {
+        struct _Stack_node { // node stored in-place in each free block
+            ::std::atomic<_Stack_node*> _Next;
+        };
+
+        // Note: The head of the stack is a pointer paired with a tag that is incremented on every
+        //       successful update. If a node is popped and pushed back between the load and the CAS
+        //       of another thread (the ABA problem), the tag no longer matches and the CAS fails.
+        //       When 128-bit integers are available (x64 Clang and GCC), the pointer and a full 64-bit
+        //       tag are updated with a double-width CAS (cmpxchg16b). Otherwise, the pointer and tag
+        //       are packed into a single 64-bit word, with a 32-bit tag on x86 and a 16-bit tag on x64,
+        //       where only the lower 48 bits of a user-space address are significant.
+#ifdef _MJX_INT128_SUPPORTED
+        using _Tagged_word = unsigned __int128;
+
+        inline constexpr int _Tagged_ptr_bits = 64;
+#else // ^^^ _MJX_INT128_SUPPORTED ^^^ / vvv !_MJX_INT128_SUPPORTED vvv
+        using _Tagged_word = uint64_t;
+
+#ifdef _MJX_X64
+        inline constexpr int _Tagged_ptr_bits = 48;
+#else // ^^^ _MJX_X64 ^^^ / vvv _MJX_X86 vvv
+        inline constexpr int _Tagged_ptr_bits = 32;
+#endif // _MJX_X64
+#endif // _MJX_INT128_SUPPORTED
+
+        inline constexpr _Tagged_word _Tagged_ptr_mask = (_Tagged_word{1} << _Tagged_ptr_bits) - 1;
+
+        inline _Tagged_word _Make_tagged_ptr(_Stack_node* const _Ptr, const _Tagged_word _Tag) noexcept {
+            return static_cast<_Tagged_word>(reinterpret_cast<uintptr_t>(_Ptr)) | (_Tag << _Tagged_ptr_bits);
+        }
+
+        inline _Stack_node* _Get_tagged_ptr(const _Tagged_word _Word) noexcept {
+            return reinterpret_cast<_Stack_node*>(static_cast<uintptr_t>(_Word & _Tagged_ptr_mask));
+        }
+
+        inline _Tagged_word _Get_next_tag(const _Tagged_word _Word) noexcept {
+            // the tag wraps around naturally once it overflows its bits
+            return (_Word >> _Tagged_ptr_bits) + 1;
+        }
+
+        class _Lock_free_stack { // Treiber stack protected against the ABA problem
+        public:
+            _Lock_free_stack() noexcept : _Myhead(0) {}
+
+            _Lock_free_stack(const _Lock_free_stack&)            = delete;
+            _Lock_free_stack& operator=(const _Lock_free_stack&) = delete;
+
+            void _Push(_Stack_node* const _Node) noexcept {
+                _Push_chain(_Node, _Node);
+            }
+
+            void _Push_chain(_Stack_node* const _First, _Stack_node* const _Last) noexcept {
+                // pushes a chain of nodes that is already linked from _First to _Last
+                _Tagged_word _Old = _Load();
+                for (;;) {
+                    _Last->_Next.store(_Get_tagged_ptr(_Old), ::std::memory_order_relaxed);
+                    if (_Compare_exchange(_Old, _Make_tagged_ptr(_First, _Get_next_tag(_Old)))) {
+                        return;
+                    }
+                }
+            }
+
+            _Stack_node* _Pop() noexcept {
+                _Tagged_word _Old = _Load();
+                for (;;) {
+                    _Stack_node* const _Node = _Get_tagged_ptr(_Old);
+                    if (!_Node) { // the stack is empty, break
+                        return nullptr;
+                    }
+
+                    // Note: The node might have been popped by another thread already, in which case _Next
+                    //       is stale. The memory itself stays valid, as nodes are never returned to
+                    //       the system while the stack is in use, and the CAS below fails.
+                    _Stack_node* const _Next = _Node->_Next.load(::std::memory_order_relaxed);
+                    if (_Compare_exchange(_Old, _Make_tagged_ptr(_Next, _Get_next_tag(_Old)))) {
+                        return _Node;
+                    }
+                }
+            }
+
+            void _Clear() noexcept {
+                // the caller must guarantee that no other thread uses the stack
+                _Myhead = 0;
+            }
+
+        private:
+#ifdef _MJX_INT128_SUPPORTED
+            _Tagged_word _Load() const noexcept {
+                // Note: The halves are loaded separately, a torn value is harmless as it only makes
+                //       the first CAS fail, which then returns the consistent value.
+                const volatile uint64_t* const _Halves = reinterpret_cast<const volatile uint64_t*>(&_Myhead);
+#ifdef _MJX_LITTLE_ENDIAN
+                return (static_cast<_Tagged_word>(_Halves[1]) << 64) | _Halves[0];
+#else // ^^^ _MJX_LITTLE_ENDIAN ^^^ / vvv _MJX_BIG_ENDIAN vvv
+                return (static_cast<_Tagged_word>(_Halves[0]) << 64) | _Halves[1];
+#endif // _MJX_LITTLE_ENDIAN
+            }
+
+            bool _Compare_exchange(_Tagged_word& _Expected, const _Tagged_word _Desired) noexcept {
+                // the legacy __sync built-in is expanded to an inline cmpxchg16b when compiled with -mcx16
+                const _Tagged_word _Prev = __sync_val_compare_and_swap(&_Myhead, _Expected, _Desired);
+                if (_Prev == _Expected) {
+                    return true;
+                }
+
+                _Expected = _Prev;
+                return false;
+            }
+
+            alignas(16) _Tagged_word _Myhead;
+#else // ^^^ _MJX_INT128_SUPPORTED ^^^ / vvv !_MJX_INT128_SUPPORTED vvv
+            _Tagged_word _Load() const noexcept {
+                return _Myhead.load(::std::memory_order_acquire);
+            }
+
+            bool _Compare_exchange(_Tagged_word& _Expected, const _Tagged_word _Desired) noexcept {
+                return _Myhead.compare_exchange_weak(
+                    _Expected, _Desired, ::std::memory_order_acq_rel, ::std::memory_order_acquire);
+            }
+
+            ::std::atomic<_Tagged_word> _Myhead;
+#endif // _MJX_INT128_SUPPORTED
+        };
+    } // namespace mjxsdk_impl
+} // namespace mjx
+
+#endif // _MJXSDK_MEMORY_IMPL_LOCK_FREE_STACK_HPP_
\ No newline at end of file
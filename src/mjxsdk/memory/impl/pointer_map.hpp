@@ -0,0 +1,223 @@
+// pointer_map.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _MJXSDK_MEMORY_IMPL_POINTER_MAP_HPP_
+#define _MJXSDK_MEMORY_IMPL_POINTER_MAP_HPP_
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <mjxsdk/memory/impl/spin_lock.hpp>
+#include <mjxsdk/memory/impl/utils.hpp>
+#include <mutex>
+#include <type_traits>
+
+namespace mjx {
+    namespace mjxsdk_impl {
+        // Note: The map is used by the diagnostic tools that observe system_allocator, so its storage comes
+        //       straight from the C heap. Each shard is an open-addressing table with linear probing,
+        //       entries are removed by shifting the following ones back, so no tombstones accumulate.
+        template <class _Ty>
+        class _Pointer_map { // sharded hash table keyed by block address
+        public:
+            static_assert(::std::is_trivially_copyable_v<_Ty>, "_Ty must be trivially copyable");
+
+            // the number of independently locked shards
+            static constexpr size_t _Shard_count = 64;
+
+            // the capacity of a shard's table once it stores its first entry
+            static constexpr size_t _Initial_capacity = 64;
+
+            _Pointer_map() noexcept : _Myshards() {}
+
+            ~_Pointer_map() noexcept {
+                for (_Shard& _Sh : _Myshards) {
+                    ::free(_Sh._Slots);
+                }
+            }
+
+            _Pointer_map(const _Pointer_map&)            = delete;
+            _Pointer_map& operator=(const _Pointer_map&) = delete;
+
+            bool _Insert(const void* const _Key, const _Ty& _Value) noexcept {
+                // inserts or replaces the entry, fails only if the table cannot grow
+                const uint64_t _Hash = _Hash_key(_Key);
+                _Shard& _Sh          = _Myshards[_Hash >> (64 - _Shard_bits)];
+                ::std::lock_guard<_Spin_lock> _Guard(_Sh._Lock);
+                if ((_Sh._Size + 1) * 2 > _Sh._Capacity && !_Grow(_Sh)) { // keep the load factor below 50%
+                    return false;
+                }
+
+                const size_t _Mask = _Sh._Capacity - 1;
+                size_t _Idx        = static_cast<size_t>(_Hash) & _Mask;
+                while (_Sh._Slots[_Idx]._Key && _Sh._Slots[_Idx]._Key != _Key) {
+                    _Idx = (_Idx + 1) & _Mask;
+                }
+
+                if (!_Sh._Slots[_Idx]._Key) { // a new entry
+                    ++_Sh._Size;
+                }
+
+                _Sh._Slots[_Idx] = _Slot{_Key, _Value};
+                return true;
+            }
+
+            bool _Erase(const void* const _Key, _Ty* const _Value = nullptr) noexcept {
+                // removes the entry and optionally returns its value
+                const uint64_t _Hash = _Hash_key(_Key);
+                _Shard& _Sh          = _Myshards[_Hash >> (64 - _Shard_bits)];
+                ::std::lock_guard<_Spin_lock> _Guard(_Sh._Lock);
+                if (_Sh._Size == 0) { // nothing to remove
+                    return false;
+                }
+
+                const size_t _Mask = _Sh._Capacity - 1;
+                size_t _Idx        = static_cast<size_t>(_Hash) & _Mask;
+                while (_Sh._Slots[_Idx]._Key != _Key) {
+                    if (!_Sh._Slots[_Idx]._Key) { // reached the end of the probe sequence
+                        return false;
+                    }
+
+                    _Idx = (_Idx + 1) & _Mask;
+                }
+
+                if (_Value) {
+                    *_Value = _Sh._Slots[_Idx]._Value;
+                }
+
+                // move back the entries that would become unreachable through the emptied slot
+                size_t _Next = _Idx;
+                for (;;) {
+                    _Next = (_Next + 1) & _Mask;
+                    if (!_Sh._Slots[_Next]._Key) {
+                        break;
+                    }
+
+                    const size_t _Home = static_cast<size_t>(_Hash_key(_Sh._Slots[_Next]._Key)) & _Mask;
+                    const bool _Stays  = _Idx <= _Next ? _Idx < _Home && _Home <= _Next
+                                                       : _Idx < _Home || _Home <= _Next;
+                    if (!_Stays) { // the entry can be reached through the emptied slot only
+                        _Sh._Slots[_Idx] = _Sh._Slots[_Next];
+                        _Idx             = _Next;
+                    }
+                }
+
+                _Sh._Slots[_Idx]._Key = nullptr;
+                --_Sh._Size;
+                return true;
+            }
+
+            bool _Find(const void* const _Key, _Ty* const _Value) noexcept {
+                const uint64_t _Hash = _Hash_key(_Key);
+                _Shard& _Sh          = _Myshards[_Hash >> (64 - _Shard_bits)];
+                ::std::lock_guard<_Spin_lock> _Guard(_Sh._Lock);
+                if (_Sh._Size == 0) { // nothing to find
+                    return false;
+                }
+
+                const size_t _Mask = _Sh._Capacity - 1;
+                size_t _Idx = static_cast<size_t>(_Hash) & _Mask;
+                while (_Sh._Slots[_Idx]._Key != _Key) {
+                    if (!_Sh._Slots[_Idx]._Key) { // reached the end of the probe sequence
+                        return false;
+                    }
+
+                    _Idx = (_Idx + 1) & _Mask;
+                }
+
+                *_Value = _Sh._Slots[_Idx]._Value;
+                return true;
+            }
+
+            template <class _Fn>
+            void _For_each(_Fn&& _Func) {
+                // calls _Func(key, value) for each entry, locking one shard at a time
+                for (_Shard& _Sh : _Myshards) {
+                    ::std::lock_guard<_Spin_lock> _Guard(_Sh._Lock);
+                    for (size_t _Idx = 0; _Idx < _Sh._Capacity; ++_Idx) {
+                        if (_Sh._Slots[_Idx]._Key) {
+                            _Func(_Sh._Slots[_Idx]._Key, _Sh._Slots[_Idx]._Value);
+                        }
+                    }
+                }
+            }
+
+            size_t _Size() noexcept {
+                size_t _Total = 0;
+                for (_Shard& _Sh : _Myshards) {
+                    ::std::lock_guard<_Spin_lock> _Guard(_Sh._Lock);
+                    _Total += _Sh._Size;
+                }
+
+                return _Total;
+            }
+
+            void _Clear() noexcept {
+                for (_Shard& _Sh : _Myshards) {
+                    ::std::lock_guard<_Spin_lock> _Guard(_Sh._Lock);
+                    ::free(_Sh._Slots);
+                    _Sh._Slots    = nullptr;
+                    _Sh._Capacity = 0;
+                    _Sh._Size     = 0;
+                }
+            }
+
+        private:
+            static constexpr size_t _Shard_bits = 6; // log2(_Shard_count)
+
+            static_assert(_Shard_count == size_t{1} << _Shard_bits, "_Shard_bits must match _Shard_count");
+
+            struct _Slot {
+                const void* _Key; // null if the slot is empty
+                _Ty _Value;
+            };
+
+            struct alignas(_Cache_line_size) _Shard {
+                _Spin_lock _Lock;
+                _Slot* _Slots    = nullptr;
+                size_t _Capacity = 0; // always zero or a power of 2
+                size_t _Size     = 0;
+            };
+
+            static uint64_t _Hash_key(const void* const _Key) noexcept {
+                // the upper bits select the shard, the lower bits select the slot
+                const uint64_t _Hash =
+                    static_cast<uint64_t>(reinterpret_cast<uintptr_t>(_Key)) * 0x9E37'79B9'7F4A'7C15;
+                return _Hash ^ (_Hash >> 29);
+            }
+
+            static bool _Grow(_Shard& _Sh) noexcept {
+                // doubles the capacity of the shard and reinserts its entries
+                const size_t _New_capacity = _Sh._Capacity > 0 ? _Sh._Capacity * 2 : _Initial_capacity;
+                _Slot* const _New_slots    = static_cast<_Slot*>(::calloc(_New_capacity, sizeof(_Slot)));
+                if (!_New_slots) { // not enough memory, keep the current table
+                    return false;
+                }
+
+                const size_t _Mask = _New_capacity - 1;
+                for (size_t _Old = 0; _Old < _Sh._Capacity; ++_Old) {
+                    if (_Sh._Slots[_Old]._Key) {
+                        size_t _Idx = static_cast<size_t>(_Hash_key(_Sh._Slots[_Old]._Key)) & _Mask;
+                        while (_New_slots[_Idx]._Key) {
+                            _Idx = (_Idx + 1) & _Mask;
+                        }
+
+                        _New_slots[_Idx] = _Sh._Slots[_Old];
+                    }
+                }
+
+                ::free(_Sh._Slots);
+                _Sh._Slots    = _New_slots;
+                _Sh._Capacity = _New_capacity;
+                return true;
+            }
+
+            ::std::array<_Shard, _Shard_count> _Myshards;
+        };
+    } // namespace mjxsdk_impl
+} // namespace mjx
+
+#endif // _MJXSDK_MEMORY_IMPL_POINTER_MAP_HPP_
\ No newline at end of file
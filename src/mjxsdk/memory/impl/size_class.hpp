@@ -0,0 +1,91 @@
+// size_class.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _MJXSDK_MEMORY_IMPL_SIZE_CLASS_HPP_
+#define _MJXSDK_MEMORY_IMPL_SIZE_CLASS_HPP_
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <mjxsdk/core/impl/utils.hpp>
+#include <mjxsdk/memory/impl/utils.hpp>
+
+namespace mjx {
+    namespace mjxsdk_impl {
+        // Note: Small sizes are rounded up to one of the size classes below. Sizes up to 128 bytes
+        //       use a 16-byte step, then each power-of-two range is split into four equal steps,
+        //       which keeps the internal fragmentation of every class under 25%.
+        //
+        //       class:  0    1  ...    7    8    9   10   11   12   13  ...   16  ...   19
+        //       size:  16   32  ...  128  160  192  224  256  320  384  ...  640  ... 1024
+        inline constexpr size_t _Size_class_granularity  = 16;
+        inline constexpr size_t _Size_class_linear_limit = 128;
+        inline constexpr size_t _Size_class_limit        = 1024;
+        inline constexpr size_t _Size_class_count        = 20;
+
+        constexpr size_t _Size_class_index(const size_t _Size) noexcept {
+            // returns the index of the smallest size class that can hold _Size bytes (1 <= _Size <= 1024)
+            if (_Size <= _Size_class_linear_limit) { // linear range, one class per 16 bytes
+                return (_Align_value(_Size, _Size_class_granularity) / _Size_class_granularity) - 1;
+            }
+
+            // geometric range, four classes per power of two
+            const size_t _Group = static_cast<size_t>(::std::bit_width(_Size - 1)) - 8;
+            const size_t _Base  = _Size_class_linear_limit << _Group;
+            const size_t _Step  = (_Size_class_linear_limit / 4) << _Group;
+            return (_Size_class_linear_limit / _Size_class_granularity) + (4 * _Group)
+                + (_Align_value(_Size - _Base, _Step) / _Step) - 1;
+        }
+
+        constexpr size_t _Size_class_size(const size_t _Idx) noexcept {
+            // returns the block size of the given size class
+            constexpr size_t _Linear_count = _Size_class_linear_limit / _Size_class_granularity;
+            if (_Idx < _Linear_count) { // linear range
+                return (_Idx + 1) * _Size_class_granularity;
+            }
+
+            const size_t _Group = (_Idx - _Linear_count) / 4;
+            const size_t _Step  = (_Size_class_linear_limit / 4) << _Group;
+            return (_Size_class_linear_limit << _Group) + (((_Idx - _Linear_count) % 4) + 1) * _Step;
+        }
+
+        consteval ::std::array<size_t, _Size_class_count> _Make_size_class_table() noexcept {
+            // builds the table of block sizes, indexed by the size class
+            ::std::array<size_t, _Size_class_count> _Table = {};
+            for (size_t _Idx = 0; _Idx < _Size_class_count; ++_Idx) {
+                _Table[_Idx] = _Size_class_size(_Idx);
+            }
+
+            return _Table;
+        }
+
+        inline constexpr ::std::array<size_t, _Size_class_count> _Size_class_table = _Make_size_class_table();
+
+        constexpr bool _Verify_size_classes() noexcept {
+            // checks that each size maps to the smallest class that can hold it
+            for (size_t _Size = 1; _Size <= _Size_class_limit; ++_Size) {
+                const size_t _Idx = _Size_class_index(_Size);
+                if (_Idx >= _Size_class_count || _Size_class_table[_Idx] < _Size) {
+                    return false;
+                }
+
+                if (_Idx > 0 && _Size_class_table[_Idx - 1] >= _Size) {
+                    return false;
+                }
+            }
+
+            return _Size_class_table[_Size_class_count - 1] == _Size_class_limit;
+        }
+
+        static_assert(_Verify_size_classes(), "size classes are inconsistent");
+
+        constexpr bool _Fits_size_class(const size_t _Size, const size_t _Align) noexcept {
+            // size classes are aligned to 16 bytes, stricter alignments must be served elsewhere
+            return _Size <= _Size_class_limit && _Get_effective_alignment(_Align) <= _Size_class_granularity;
+        }
+    } // namespace mjxsdk_impl
+} // namespace mjx
+
+#endif // _MJXSDK_MEMORY_IMPL_SIZE_CLASS_HPP_
\ No newline at end of file
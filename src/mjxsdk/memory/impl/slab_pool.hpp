@@ -0,0 +1,153 @@
+// slab_pool.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _MJXSDK_MEMORY_IMPL_SLAB_POOL_HPP_
+#define _MJXSDK_MEMORY_IMPL_SLAB_POOL_HPP_
+#include <cstddef>
+#include <mjxsdk/core/impl/utils.hpp>
+#include <mjxsdk/memory/impl/allocation_hooks.hpp>
+#include <mjxsdk/memory/impl/global_allocator.hpp>
+#include <mjxsdk/memory/impl/utils.hpp>
+#include <mutex>
+
+namespace mjx {
+    namespace mjxsdk_impl {
+        class _Slab_pool { // thread-safe pool of equal blocks carved from page-aligned slabs
+        public:
+            static constexpr size_t _Slab_size  = 64 * 1024;
+            static constexpr size_t _Slab_align = 4096;
+
+            _Slab_pool() noexcept
+                : _Mymtx(), _Myfree(nullptr), _Myslabs(nullptr), _Mycur(nullptr), _Myend(nullptr), _Mysize(0) {}
+
+            ~_Slab_pool() noexcept {
+                _Release();
+            }
+
+            _Slab_pool(const _Slab_pool&)            = delete;
+            _Slab_pool& operator=(const _Slab_pool&) = delete;
+
+            void _Set_block_size(const size_t _Size) noexcept {
+                // must be called before the first allocation, _Size must be a multiple of 16
+                _Mysize = _Size;
+            }
+
+            size_t _Block_size() const noexcept {
+                return _Mysize;
+            }
+
+            void* _Allocate() {
+                ::std::lock_guard<::std::mutex> _Guard(_Mymtx);
+                return _Allocate_unlocked();
+            }
+
+            void _Allocate_batch(void** const _Ptrs, const size_t _Count) {
+                // allocates _Count blocks under a single lock, either all or none
+                ::std::lock_guard<::std::mutex> _Guard(_Mymtx);
+                size_t _Idx = 0;
+                try {
+                    for (; _Idx < _Count; ++_Idx) {
+                        _Ptrs[_Idx] = _Allocate_unlocked();
+                    }
+                } catch (...) {
+                    while (_Idx > 0) { // return the blocks allocated so far
+                        _Push_unlocked(_Ptrs[--_Idx]);
+                    }
+
+                    throw;
+                }
+            }
+
+            void _Deallocate(void* const _Ptr) noexcept {
+                ::std::lock_guard<::std::mutex> _Guard(_Mymtx);
+                _Push_unlocked(_Ptr);
+            }
+
+            void _Deallocate_batch(void* const* const _Ptrs, const size_t _Count) noexcept {
+                // links the blocks outside of the lock, then splices the whole chain at once
+                if (_Count == 0) {
+                    return;
+                }
+
+                for (size_t _Idx = 0; _Idx < _Count - 1; ++_Idx) {
+                    static_cast<_Free_block*>(_Ptrs[_Idx])->_Next = static_cast<_Free_block*>(_Ptrs[_Idx + 1]);
+                }
+
+                _Free_block* const _Last = static_cast<_Free_block*>(_Ptrs[_Count - 1]);
+                ::std::lock_guard<::std::mutex> _Guard(_Mymtx);
+                _Last->_Next = _Myfree;
+                _Myfree      = static_cast<_Free_block*>(_Ptrs[0]);
+            }
+
+            void _Release() noexcept {
+                // returns all slabs to the internal allocator, invalidates all blocks
+                ::std::lock_guard<::std::mutex> _Guard(_Mymtx);
+                _Internal_allocation_scope _Scope; // the slabs were never reported
+                while (_Myslabs) {
+                    _Slab_header* const _Next = _Myslabs->_Next;
+                    _Get_internal_allocator().deallocate(_Myslabs, _Slab_size, _Slab_align);
+                    _Myslabs = _Next;
+                }
+
+                _Myfree = nullptr;
+                _Mycur  = nullptr;
+                _Myend  = nullptr;
+            }
+
+        private:
+            struct _Free_block { // free block that stores the link to the next free block in-place
+                _Free_block* _Next;
+            };
+
+            struct _Slab_header { // header placed at the beginning of each slab
+                _Slab_header* _Next;
+            };
+
+            void* _Allocate_unlocked() {
+                if (_Myfree) { // reuse the most recently freed block
+                    _Free_block* const _Block = _Myfree;
+                    _Myfree                   = _Block->_Next;
+                    return _Block;
+                }
+
+                if (_Distance_between(_Mycur, _Myend) < _Mysize) { // the current slab is exhausted
+                    _Allocate_slab();
+                }
+
+                void* const _Block = _Mycur;
+                _Mycur             = _Adjust_address_by_offset(_Mycur, _Mysize);
+                return _Block;
+            }
+
+            void _Push_unlocked(void* const _Ptr) noexcept {
+                _Free_block* const _Block = static_cast<_Free_block*>(_Ptr);
+                _Block->_Next             = _Myfree;
+                _Myfree                   = _Block;
+            }
+
+            void _Allocate_slab() {
+                // the first block follows the slab header, aligned to the size class granularity
+                _Internal_allocation_scope _Scope; // the blocks are reported by their owner, not the slab
+                constexpr size_t _Header_size = _Align_value(sizeof(_Slab_header), size_t{16});
+                _Slab_header* const _Slab     = static_cast<_Slab_header*>(
+                    _Get_internal_allocator().allocate(_Slab_size, _Slab_align));
+                _Slab->_Next = _Myslabs;
+                _Myslabs     = _Slab;
+                _Mycur       = _Adjust_address_by_offset(_Slab, _Header_size);
+                _Myend       = _Adjust_address_by_offset(_Slab, _Slab_size);
+            }
+
+            ::std::mutex _Mymtx;
+            _Free_block* _Myfree; // the head of the free list
+            _Slab_header* _Myslabs; // all slabs owned by this pool
+            void* _Mycur; // the first byte of the current slab that was not carved into blocks yet
+            void* _Myend; // the end of the current slab
+            size_t _Mysize; // the size of each block
+        };
+    } // namespace mjxsdk_impl
+} // namespace mjx
+
+#endif // _MJXSDK_MEMORY_IMPL_SLAB_POOL_HPP_
\ No newline at end of file
@@ -0,0 +1,63 @@
+// spin_lock.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _MJXSDK_MEMORY_IMPL_SPIN_LOCK_HPP_
+#define _MJXSDK_MEMORY_IMPL_SPIN_LOCK_HPP_
+#include <atomic>
+#include <thread>
+#if defined(_MJX_X64) || defined(_MJX_X86)
+#include <immintrin.h>
+#endif // defined(_MJX_X64) || defined(_MJX_X86)
+
+namespace mjx {
+    namespace mjxsdk_impl {
+        inline void _Spin_pause() noexcept {
+            // tells the processor that the thread is spinning
+#if defined(_MJX_X64) || defined(_MJX_X86)
+            _mm_pause();
+#endif // defined(_MJX_X64) || defined(_MJX_X86)
+        }
+
+        // Note: The lock itself never enters the kernel. The only exception is a contended waiter that has spun
+        //       _Spins_before_yield times, it gives up its time slice with a single sched_yield()/SwitchToThread()
+        //       call, because on an oversubscribed machine the owner cannot make progress otherwise.
+        //       An uncontended lock() and every unlock() make no system calls.
+        class _Spin_lock { // lock that never blocks in the kernel while the critical section is short
+        public:
+            // the number of spins after which the waiting thread gives up its time slice
+            static constexpr int _Spins_before_yield = 128;
+
+            _Spin_lock() noexcept : _Myflag() {}
+
+            _Spin_lock(const _Spin_lock&)            = delete;
+            _Spin_lock& operator=(const _Spin_lock&) = delete;
+
+            void lock() noexcept {
+                while (_Myflag.test_and_set(::std::memory_order_acquire)) {
+                    // wait until the lock looks free to avoid bouncing the cache line between cores
+                    int _Spins = 0;
+                    while (_Myflag.test(::std::memory_order_relaxed)) {
+                        if (++_Spins < _Spins_before_yield) {
+                            _Spin_pause();
+                        } else { // the owner has probably been preempted, let it run
+                            ::std::this_thread::yield();
+                            _Spins = 0;
+                        }
+                    }
+                }
+            }
+
+            void unlock() noexcept {
+                _Myflag.clear(::std::memory_order_release);
+            }
+
+        private:
+            ::std::atomic_flag _Myflag;
+        };
+    } // namespace mjxsdk_impl
+} // namespace mjx
+
+#endif // _MJXSDK_MEMORY_IMPL_SPIN_LOCK_HPP_
\ No newline at end of file
@@ -0,0 +1,228 @@
+// thread_cache.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _MJXSDK_MEMORY_IMPL_THREAD_CACHE_HPP_
+#define _MJXSDK_MEMORY_IMPL_THREAD_CACHE_HPP_
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <mjxsdk/memory/impl/global_allocator.hpp>
+#include <mjxsdk/memory/impl/size_class.hpp>
+#include <mjxsdk/memory/impl/slab_pool.hpp>
+#include <mjxsdk/memory/object.hpp>
+
+namespace mjx {
+    namespace mjxsdk_impl {
+        // Note: Each thread keeps a magazine of free blocks for every size class. An empty magazine
+        //       is refilled with one batch from the shared backend, a full magazine returns its oldest
+        //       batch to the backend. Both operations take the backend lock only once per batch.
+        inline constexpr size_t _Magazine_capacity = 64;
+        inline constexpr size_t _Magazine_batch    = 32;
+        inline constexpr size_t _Max_thread_caches = 8; // the number of allocators cached by each thread
+
+        class _Thread_cache_backend { // shared, reference-counted state of a thread-caching allocator
+        public:
+            _Thread_cache_backend() noexcept : _Myrefs(1) {
+                for (size_t _Idx = 0; _Idx < _Size_class_count; ++_Idx) {
+                    _Mypools[_Idx]._Set_block_size(_Size_class_table[_Idx]);
+                }
+            }
+
+            _Thread_cache_backend(const _Thread_cache_backend&)            = delete;
+            _Thread_cache_backend& operator=(const _Thread_cache_backend&) = delete;
+
+            _Slab_pool& _Pool(const size_t _Idx) noexcept {
+                return _Mypools[_Idx];
+            }
+
+            void _Acquire() noexcept {
+                _Myrefs.fetch_add(1, ::std::memory_order_relaxed);
+            }
+
+            void _Release() noexcept {
+                // the last owner (either the allocator or a thread cache) destroys the backend
+                if (_Myrefs.fetch_sub(1, ::std::memory_order_acq_rel) == 1) {
+                    ::mjx::delete_object_using_allocator(this, _Get_internal_allocator());
+                }
+            }
+
+        private:
+            _Slab_pool _Mypools[_Size_class_count];
+            ::std::atomic<size_t> _Myrefs; // one reference for the allocator and one for each thread cache
+        };
+
+        struct _Magazine { // stack of free blocks that belong to the same size class
+            size_t _Count = 0;
+            void* _Blocks[_Magazine_capacity];
+        };
+
+        class _Thread_cache { // blocks cached by a single thread for a single backend
+        public:
+            explicit _Thread_cache(_Thread_cache_backend* const _Backend) noexcept : _Mybackend(_Backend) {
+                _Mybackend->_Acquire();
+            }
+
+            ~_Thread_cache() noexcept {
+                _Flush();
+                _Mybackend->_Release();
+            }
+
+            _Thread_cache(const _Thread_cache&)            = delete;
+            _Thread_cache& operator=(const _Thread_cache&) = delete;
+
+            _Thread_cache_backend* _Backend() const noexcept {
+                return _Mybackend;
+            }
+
+            void* _Allocate(const size_t _Idx) {
+                _Magazine& _Mag = _Mymags[_Idx];
+                if (_Mag._Count == 0) { // the magazine is empty, refill it with one batch
+                    _Mybackend->_Pool(_Idx)._Allocate_batch(_Mag._Blocks, _Magazine_batch);
+                    _Mag._Count = _Magazine_batch;
+                }
+
+                return _Mag._Blocks[--_Mag._Count];
+            }
+
+            void _Deallocate(const size_t _Idx, void* const _Ptr) noexcept {
+                _Magazine& _Mag = _Mymags[_Idx];
+                if (_Mag._Count == _Magazine_capacity) { // the magazine is full, flush the oldest batch
+                    _Mybackend->_Pool(_Idx)._Deallocate_batch(_Mag._Blocks, _Magazine_batch);
+                    ::memmove(_Mag._Blocks, _Mag._Blocks + _Magazine_batch,
+                        (_Magazine_capacity - _Magazine_batch) * sizeof(void*));
+                    _Mag._Count -= _Magazine_batch;
+                }
+
+                _Mag._Blocks[_Mag._Count++] = _Ptr;
+            }
+
+            void _Allocate_bulk(const size_t _Idx, void** const _Ptrs, const size_t _Count) {
+                // takes the missing blocks from the backend first, so that a failure leaves the magazine intact
+                _Magazine& _Mag      = _Mymags[_Idx];
+                const size_t _Cached = _Count < _Mag._Count ? _Count : _Mag._Count;
+                if (_Cached < _Count) { // the magazine cannot serve all blocks, take the rest in one batch
+                    _Mybackend->_Pool(_Idx)._Allocate_batch(_Ptrs + _Cached, _Count - _Cached);
+                }
+
+                _Mag._Count -= _Cached;
+                ::memcpy(_Ptrs, _Mag._Blocks + _Mag._Count, _Cached * sizeof(void*));
+            }
+
+            void _Deallocate_bulk(const size_t _Idx, void* const* const _Ptrs, const size_t _Count) noexcept {
+                // fills the magazine, the remaining blocks are returned to the backend in one batch
+                _Magazine& _Mag      = _Mymags[_Idx];
+                const size_t _Free   = _Magazine_capacity - _Mag._Count;
+                const size_t _Cached = _Count < _Free ? _Count : _Free;
+                ::memcpy(_Mag._Blocks + _Mag._Count, _Ptrs, _Cached * sizeof(void*));
+                _Mag._Count += _Cached;
+                if (_Cached < _Count) {
+                    _Mybackend->_Pool(_Idx)._Deallocate_batch(_Ptrs + _Cached, _Count - _Cached);
+                }
+            }
+
+            void _Flush() noexcept {
+                // returns all cached blocks to the backend
+                for (size_t _Idx = 0; _Idx < _Size_class_count; ++_Idx) {
+                    _Magazine& _Mag = _Mymags[_Idx];
+                    _Mybackend->_Pool(_Idx)._Deallocate_batch(_Mag._Blocks, _Mag._Count);
+                    _Mag._Count = 0;
+                }
+            }
+
+        private:
+            _Thread_cache_backend* _Mybackend;
+            _Magazine _Mymags[_Size_class_count];
+        };
+
+        class _Thread_cache_registry { // per-thread list of caches, flushed when the thread exits
+        public:
+            _Thread_cache* _Find(const _Thread_cache_backend* const _Backend) const noexcept {
+                for (_Thread_cache* const _Cache : _Mycaches) {
+                    if (_Cache && _Cache->_Backend() == _Backend) {
+                        return _Cache;
+                    }
+                }
+
+                return nullptr;
+            }
+
+            _Thread_cache* _Find_or_create(_Thread_cache_backend* const _Backend);
+
+            void _Remove(const _Thread_cache_backend* const _Backend) noexcept {
+                for (_Thread_cache*& _Cache : _Mycaches) {
+                    if (_Cache && _Cache->_Backend() == _Backend) {
+                        _Destroy_cache(_Cache);
+                    }
+                }
+            }
+
+            void _Destroy() noexcept {
+                // destroys all caches, the registry must not be used by this thread anymore
+                for (_Thread_cache*& _Cache : _Mycaches) {
+                    _Destroy_cache(_Cache);
+                }
+
+                _Mydestroyed = true;
+            }
+
+            bool _Destroyed() const noexcept {
+                return _Mydestroyed;
+            }
+
+        private:
+            static void _Destroy_cache(_Thread_cache*& _Cache) noexcept {
+                // flushes the cache and releases its reference to the backend
+                if (_Cache) {
+                    ::mjx::delete_object_using_allocator(_Cache, _Get_internal_allocator());
+                    _Cache = nullptr;
+                }
+            }
+
+            // Note: The registry must stay trivially destructible, so that accessing it does not
+            //       require any initialization guard. The caches are destroyed by _Thread_cache_cleanup.
+            _Thread_cache* _Mycaches[_Max_thread_caches];
+            size_t _Mynext; // the next slot to be reused
+            bool _Mydestroyed; // set once the thread is being terminated
+        };
+
+        inline thread_local _Thread_cache_registry _Tls_thread_cache_registry = {};
+
+        struct _Thread_cache_cleanup { // destroys the calling thread's caches when the thread exits
+            bool _Registered = false;
+
+            ~_Thread_cache_cleanup() noexcept {
+                _Tls_thread_cache_registry._Destroy();
+            }
+        };
+
+        inline _Thread_cache* _Thread_cache_registry::_Find_or_create(_Thread_cache_backend* const _Backend) {
+            _Thread_cache* _Cache = _Find(_Backend);
+            if (_Cache) { // the cache already exists, break
+                return _Cache;
+            }
+
+            // touch the cleanup object, so that its destructor runs when the thread exits
+            static thread_local _Thread_cache_cleanup _Cleanup;
+            _Cleanup._Registered = true;
+
+            // evict caches in round-robin order once all slots are in use
+            _Thread_cache*& _Slot = _Mycaches[_Mynext];
+            _Mynext               = (_Mynext + 1) % _Max_thread_caches;
+            _Destroy_cache(_Slot);
+            _Slot = ::mjx::create_object_using_allocator<_Thread_cache>(_Get_internal_allocator(), _Backend);
+            return _Slot;
+        }
+
+        inline _Thread_cache_registry* _Get_thread_cache_registry() noexcept {
+            // returns the calling thread's registry, or null if the thread is being terminated
+            _Thread_cache_registry* const _Registry = ::std::addressof(_Tls_thread_cache_registry);
+            return _Registry->_Destroyed() ? nullptr : _Registry;
+        }
+    } // namespace mjxsdk_impl
+} // namespace mjx
+
+#endif // _MJXSDK_MEMORY_IMPL_THREAD_CACHE_HPP_
\ No newline at end of file
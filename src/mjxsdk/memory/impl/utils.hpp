@@ -7,9 +7,15 @@
 #ifndef _MJXSDK_MEMORY_IMPL_UTILS_HPP_
 #define _MJXSDK_MEMORY_IMPL_UTILS_HPP_
 #include <cstddef>
+#include <cstdint>
+#include <mjxsdk/core/impl/utils.hpp>
+#include <type_traits>
 
 namespace mjx {
     namespace mjxsdk_impl {
+        // the assumed size of a cache line, used to keep frequently modified data apart
+        inline constexpr size_t _Cache_line_size = 64;
+
         template <class _OffTy>
         inline constexpr bool _Is_valid_offset_type = ::std::is_integral_v<_OffTy>
             && !::std::is_same_v<_OffTy, bool>; // allows all integral types except bool
@@ -34,6 +40,18 @@ namespace mjx {
             return _Block_begin >= _Base_begin && _Block_end <= _Base_end;
         }
 
+        inline void* _Align_address(void* const _Address, const size_t _Align) noexcept {
+            // returns the nearest address that is greater than or equal to _Address and aligned to _Align
+            return reinterpret_cast<void*>(
+                _Align_value(reinterpret_cast<uintptr_t>(_Address), static_cast<uintptr_t>(_Align)));
+        }
+
+        inline size_t _Distance_between(const void* const _First, const void* const _Last) noexcept {
+            // returns the number of bytes between two addresses, _First must not be greater than _Last
+            return static_cast<size_t>(
+                static_cast<const unsigned char*>(_Last) - static_cast<const unsigned char*>(_First));
+        }
+
         constexpr size_t _Get_effective_alignment(const size_t _Align) noexcept {
             // returns the effective alignment for allocation and deallocation
             return _Align >= __STDCPP_DEFAULT_NEW_ALIGNMENT__ ? _Align : __STDCPP_DEFAULT_NEW_ALIGNMENT__;
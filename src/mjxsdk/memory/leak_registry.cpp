@@ -0,0 +1,184 @@
+// leak_registry.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <mjxsdk/memory/impl/allocation_hooks.hpp>
+#include <mjxsdk/memory/impl/pointer_map.hpp>
+#include <mjxsdk/memory/impl/utils.hpp>
+#include <mjxsdk/memory/leak_registry.hpp>
+#include <new>
+#include <unordered_map>
+#include <vector>
+#ifdef _MJX_LINUX
+#include <dlfcn.h>
+#endif // _MJX_LINUX
+
+namespace mjx {
+    namespace mjxsdk_impl {
+        struct _Live_block { // registered block
+            size_t _Size;
+            const void* _Return_address;
+            allocator_tag _Tag;
+        };
+
+        struct _Allocation_site_hash {
+            size_t operator()(const allocation_site& _Site) const noexcept {
+                return ::std::hash<const void*>{}(_Site.return_address) ^ static_cast<size_t>(_Site.tag);
+            }
+        };
+
+        struct _Allocation_site_equal {
+            bool operator()(const allocation_site& _Left, const allocation_site& _Right) const noexcept {
+                return _Left.return_address == _Right.return_address && _Left.tag == _Right.tag;
+            }
+        };
+
+        class _Leak_registry { // singleton class that stores the live blocks
+        public:
+            _Leak_registry(const _Leak_registry&)            = delete;
+            _Leak_registry& operator=(const _Leak_registry&) = delete;
+
+            static _Leak_registry& _Instance() noexcept {
+                // never destroyed, registered blocks may still be deallocated during static destruction
+                static _Leak_registry* const _Obj = new _Leak_registry();
+                return *_Obj;
+            }
+
+            void _Clear() noexcept {
+                _Myblocks._Clear();
+            }
+
+            void _Register(void* const _Ptr, const _Live_block& _Block) noexcept {
+                // a block that cannot be registered is not reported, the allocation itself still succeeds
+                static_cast<void>(_Myblocks._Insert(_Ptr, _Block));
+            }
+
+            void _Unregister(void* const _Ptr) noexcept {
+                _Myblocks._Erase(_Ptr);
+            }
+
+            size_t _Live_count() noexcept {
+                return _Myblocks._Size();
+            }
+
+            ::std::vector<allocation_site> _Collect_sites() {
+                // groups the live blocks by call site and tag, the sites with the most bytes come first
+                ::std::unordered_map<allocation_site, size_t, _Allocation_site_hash, _Allocation_site_equal> _Index;
+                ::std::vector<allocation_site> _Sites;
+                _Myblocks._For_each([&](const void*, const _Live_block& _Block) {
+                    const allocation_site _Key = {_Block._Return_address, _Block._Tag, 0, 0};
+                    const auto _Result         = _Index.try_emplace(_Key, _Sites.size());
+                    if (_Result.second) { // the first block from this site
+                        _Sites.push_back(_Key);
+                    }
+
+                    allocation_site& _Site = _Sites[_Result.first->second];
+                    ++_Site.count;
+                    _Site.bytes += _Block._Size;
+                });
+
+                ::std::sort(_Sites.begin(), _Sites.end(),
+                    [](const allocation_site& _Left, const allocation_site& _Right) noexcept {
+                        return _Left.bytes > _Right.bytes;
+                    });
+                return _Sites;
+            }
+
+        private:
+            _Leak_registry() noexcept : _Myblocks() {}
+
+            _Pointer_map<_Live_block> _Myblocks;
+        };
+
+        void _Register_allocation(void* const _Ptr, const size_t _Size,
+            const allocator_tag _Tag, const void* const _Return_address) noexcept {
+            _Leak_registry::_Instance()._Register(_Ptr, _Live_block{_Size, _Return_address, _Tag});
+        }
+
+        void _Unregister_allocation(void* const _Ptr) noexcept {
+            _Leak_registry::_Instance()._Unregister(_Ptr);
+        }
+
+        inline void _Write_allocation_site(FILE* const _File, const allocation_site& _Site) noexcept {
+            ::fprintf(_File, "%12zu bytes in %8zu blocks (tag %u) from %p", _Site.bytes, _Site.count,
+                static_cast<unsigned int>(_Site.tag), _Site.return_address);
+#ifdef _MJX_LINUX
+            ::Dl_info _Info;
+            if (::dladdr(_Site.return_address, &_Info) != 0) { // resolve the nearest exported symbol
+                if (_Info.dli_sname) {
+                    ::fprintf(_File, " %s+0x%zx", _Info.dli_sname,
+                        _Distance_between(_Info.dli_saddr, _Site.return_address));
+                }
+
+                if (_Info.dli_fname) {
+                    ::fprintf(_File, " (%s+0x%zx)", _Info.dli_fname,
+                        _Distance_between(_Info.dli_fbase, _Site.return_address));
+                }
+            }
+#endif // _MJX_LINUX
+            ::fputc('\n', _File);
+        }
+    } // namespace mjxsdk_impl
+
+    void start_leak_registry() noexcept {
+        mjxsdk_impl::_Leak_registry::_Instance()._Clear();
+        mjxsdk_impl::_Enable_allocation_hook(mjxsdk_impl::_Leak_registry_hook);
+    }
+
+    void stop_leak_registry() noexcept {
+        mjxsdk_impl::_Disable_allocation_hook(mjxsdk_impl::_Leak_registry_hook);
+    }
+
+    bool is_leak_registry_active() noexcept {
+        return mjxsdk_impl::_Is_allocation_hook_enabled(mjxsdk_impl::_Leak_registry_hook);
+    }
+
+    size_t live_allocation_count() noexcept {
+        return mjxsdk_impl::_Leak_registry::_Instance()._Live_count();
+    }
+
+    size_t get_live_allocation_sites(allocation_site* const _Sites, const size_t _Capacity) noexcept {
+        try {
+            const ::std::vector<allocation_site> _All = mjxsdk_impl::_Leak_registry::_Instance()._Collect_sites();
+            ::std::copy_n(_All.begin(), (::std::min)(_All.size(), _Capacity), _Sites);
+            return _All.size();
+        } catch (const ::std::bad_alloc&) { // not enough memory to group the blocks
+            return 0;
+        }
+    }
+
+    bool write_leak_report(const char* const _Path) noexcept {
+        ::std::vector<allocation_site> _Sites;
+        try {
+            _Sites = mjxsdk_impl::_Leak_registry::_Instance()._Collect_sites();
+        } catch (const ::std::bad_alloc&) { // not enough memory to group the blocks
+            return false;
+        }
+
+        FILE* const _File = ::fopen(_Path, "w");
+        if (!_File) {
+            return false;
+        }
+
+        size_t _Count = 0;
+        size_t _Bytes = 0;
+        for (const allocation_site& _Site : _Sites) {
+            _Count += _Site.count;
+            _Bytes += _Site.bytes;
+        }
+
+        ::fprintf(
+            _File, "leak report: %zu bytes in %zu blocks from %zu call sites\n", _Bytes, _Count, _Sites.size());
+        for (const allocation_site& _Site : _Sites) {
+            mjxsdk_impl::_Write_allocation_site(_File, _Site);
+        }
+
+        const bool _Result = ::ferror(_File) == 0;
+        return ::fclose(_File) == 0 && _Result;
+    }
+} // namespace mjx
\ No newline at end of file
@@ -0,0 +1,42 @@
+// leak_registry.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _MJXSDK_MEMORY_LEAK_REGISTRY_HPP_
+#define _MJXSDK_MEMORY_LEAK_REGISTRY_HPP_
+#include <cstddef>
+#include <mjxsdk/core/export.hpp>
+#include <mjxsdk/memory/allocator.hpp>
+
+namespace mjx {
+    struct allocation_site { // live allocations made from a single call site
+        const void* return_address; // the address that the allocating call returned to
+        allocator_tag tag; // the allocator that made the allocations
+        size_t count; // the number of live allocations
+        size_t bytes; // the number of live bytes
+    };
+
+    // Note: The registry works in release builds. Every block is registered by the allocator that hands it out,
+    //       with that allocator's tag. Chunks that pool, small-object, thread-caching and TLSF allocators
+    //       draw from their upstream allocator are not registered themselves. monotonic_allocator and
+    //       stack_allocator are seen only through their upstream chunks, and blocks still live when an
+    //       allocator is released stay registered. Every live block is stored in a sharded hash table
+    //       together with its size, tag and call site. Blocks registered before stop_leak_registry()
+    //       are kept, so that they can still be reported, until the next start.
+    _MJXSDK_EXPORT void start_leak_registry() noexcept;
+    _MJXSDK_EXPORT void stop_leak_registry() noexcept;
+    _MJXSDK_EXPORT bool is_leak_registry_active() noexcept;
+
+    // returns the number of registered blocks that were not deallocated yet
+    _MJXSDK_EXPORT size_t live_allocation_count() noexcept;
+
+    // copies up to _Capacity call sites with live blocks, the most bytes first, returns the number of sites
+    _MJXSDK_EXPORT size_t get_live_allocation_sites(allocation_site* const _Sites, const size_t _Capacity) noexcept;
+
+    // writes the live blocks grouped by call site, the most bytes first
+    _MJXSDK_EXPORT bool write_leak_report(const char* const _Path) noexcept;
+} // namespace mjx
+
+#endif // _MJXSDK_MEMORY_LEAK_REGISTRY_HPP_
\ No newline at end of file
@@ -0,0 +1,171 @@
+// monotonic_allocator.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <mjxsdk/memory/exception.hpp>
+#include <mjxsdk/memory/impl/utils.hpp>
+#include <mjxsdk/memory/monotonic_allocator.hpp>
+#include <utility>
+
+namespace mjx {
+    struct monotonic_allocator::_Chunk_header { // header placed at the beginning of each upstream chunk
+        _Chunk_header* _Next;
+        size_type _Size;
+    };
+
+    monotonic_allocator::monotonic_allocator(memory_resource& _Resource) noexcept
+        : _Myres(::std::addressof(_Resource)), _Myupstream(nullptr),
+        _Mychunks(nullptr), _Mycur(nullptr), _Myend(nullptr), _Mynext(0) {
+        _Reset_buffer();
+    }
+
+    monotonic_allocator::monotonic_allocator(allocator& _Upstream) noexcept
+        : _Myres(nullptr), _Myupstream(::std::addressof(_Upstream)),
+        _Mychunks(nullptr), _Mycur(nullptr), _Myend(nullptr), _Mynext(0) {
+        _Reset_buffer();
+    }
+
+    monotonic_allocator::monotonic_allocator(memory_resource& _Resource, allocator& _Upstream) noexcept
+        : _Myres(::std::addressof(_Resource)), _Myupstream(::std::addressof(_Upstream)),
+        _Mychunks(nullptr), _Mycur(nullptr), _Myend(nullptr), _Mynext(0) {
+        _Reset_buffer();
+    }
+
+    monotonic_allocator::~monotonic_allocator() noexcept {
+        release();
+    }
+
+    void monotonic_allocator::_Reset_buffer() noexcept {
+        if (_Myres && !_Myres->empty()) { // start from the beginning of the resource
+            _Mycur  = _Myres->data();
+            _Myend  = mjxsdk_impl::_Adjust_address_by_offset(_Myres->data(), _Myres->size());
+            _Mynext = _Myres->size() > min_chunk_size ? _Myres->size() : min_chunk_size;
+        } else { // no resource, wait for the first upstream chunk
+            _Mycur  = nullptr;
+            _Myend  = nullptr;
+            _Mynext = min_chunk_size;
+        }
+    }
+
+    monotonic_allocator::pointer
+        monotonic_allocator::_Try_allocate(const size_type _Size, const size_type _Align) noexcept {
+        if (!_Mycur) { // no buffer, break
+            return nullptr;
+        }
+
+        void* const _Ptr = mjxsdk_impl::_Align_address(_Mycur, _Align);
+        if (_Ptr < _Mycur || _Ptr > _Myend) { // alignment moved the address out of the buffer
+            return nullptr;
+        }
+
+        if (_Size > mjxsdk_impl::_Distance_between(_Ptr, _Myend)) { // not enough space, break
+            return nullptr;
+        }
+
+        _Mycur = mjxsdk_impl::_Adjust_address_by_offset(_Ptr, _Size);
+        return _Ptr;
+    }
+
+    void monotonic_allocator::_Allocate_chunk(const size_type _Size, const size_type _Align) {
+        // reserve enough space for the header, the requested block and its alignment padding
+        constexpr size_type _Header_size = sizeof(_Chunk_header);
+        if (_Size > _Myupstream->max_size() - _Header_size - _Align) { // block too large, raise an exception
+            allocation_limit_exceeded::raise();
+        }
+
+        const size_type _Min_size   = _Header_size + _Size + _Align;
+        const size_type _Chunk_size = _Mynext > _Min_size ? _Mynext : _Min_size;
+        _Chunk_header* const _Chunk = static_cast<_Chunk_header*>(_Myupstream->allocate(_Chunk_size));
+        _Chunk->_Next               = _Mychunks;
+        _Chunk->_Size               = _Chunk_size;
+        _Mychunks                   = _Chunk;
+        _Mycur                      = mjxsdk_impl::_Adjust_address_by_offset(_Chunk, _Header_size);
+        _Myend                      = mjxsdk_impl::_Adjust_address_by_offset(_Chunk, _Chunk_size);
+        if (_Mynext <= (static_cast<size_type>(-1) >> 1)) { // grow the next chunk geometrically
+            _Mynext <<= 1;
+        }
+    }
+
+    monotonic_allocator::pointer monotonic_allocator::allocate(size_type _Size, size_type _Align) {
+        if (_Size == 0) { // no allocation, do nothing
+            return nullptr;
+        }
+
+        _Align     = mjxsdk_impl::_Get_effective_alignment(_Align);
+        void* _Ptr = _Try_allocate(_Size, _Align);
+        if (!_Ptr) { // the current buffer is exhausted, try to obtain a new chunk
+            if (!_Myupstream) { // no upstream allocator, raise an exception
+                allocation_limit_exceeded::raise();
+            }
+
+            _Allocate_chunk(_Size, _Align);
+            _Ptr = _Try_allocate(_Size, _Align);
+        }
+
+        return _Ptr;
+    }
+
+    void monotonic_allocator::deallocate(pointer, size_type, size_type) noexcept {}
+
+    bool monotonic_allocator::try_expand_in_place(
+        pointer _Ptr, size_type _Old_size, size_type _New_size, size_type) noexcept {
+        if (!_Ptr || mjxsdk_impl::_Adjust_address_by_offset(_Ptr, _Old_size) != _Mycur) { // not the last block
+            return _Ptr && _Old_size == _New_size;
+        }
+
+        if (_New_size > mjxsdk_impl::_Distance_between(_Ptr, _Myend)) { // not enough space left, break
+            return false;
+        }
+
+        _Mycur = mjxsdk_impl::_Adjust_address_by_offset(_Ptr, _New_size);
+        return true;
+    }
+
+    allocator_tag monotonic_allocator::tag() const noexcept {
+        return allocator_tag::monotonic;
+    }
+
+    monotonic_allocator::size_type monotonic_allocator::max_size() const noexcept {
+        if (_Myupstream) { // the upstream allocator limits the chunk size
+            return _Myupstream->max_size();
+        }
+
+        return _Myres ? _Myres->size() : 0;
+    }
+
+    bool monotonic_allocator::is_equal(const allocator& _Other) const noexcept {
+        // stateful allocator, equal only to itself
+        return this == ::std::addressof(_Other);
+    }
+
+    bool monotonic_allocator::contains(const_pointer _Ptr, const size_type _Size) const noexcept {
+        if (_Myres && _Myres->contains(_Ptr, _Size)) { // the block comes from the resource
+            return true;
+        }
+
+        const void* const _End = mjxsdk_impl::_Adjust_address_by_offset(_Ptr, _Size);
+        for (const _Chunk_header* _Chunk = _Mychunks; _Chunk; _Chunk = _Chunk->_Next) {
+            if (mjxsdk_impl::_Is_within_memory_block(
+                _Chunk, mjxsdk_impl::_Adjust_address_by_offset(_Chunk, _Chunk->_Size), _Ptr, _End)) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    allocator* monotonic_allocator::upstream() const noexcept {
+        return _Myupstream;
+    }
+
+    void monotonic_allocator::release() noexcept {
+        while (_Mychunks) { // return each chunk to the upstream allocator
+            _Chunk_header* const _Next = _Mychunks->_Next;
+            _Myupstream->deallocate(_Mychunks, _Mychunks->_Size);
+            _Mychunks = _Next;
+        }
+
+        _Reset_buffer();
+    }
+} // namespace mjx
\ No newline at end of file
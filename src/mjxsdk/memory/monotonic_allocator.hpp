@@ -0,0 +1,82 @@
+// monotonic_allocator.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _MJXSDK_MEMORY_MONOTONIC_ALLOCATOR_HPP_
+#define _MJXSDK_MEMORY_MONOTONIC_ALLOCATOR_HPP_
+#include <mjxsdk/core/export.hpp>
+#include <mjxsdk/memory/allocator.hpp>
+#include <mjxsdk/memory/memory_resource.hpp>
+
+namespace mjx {
+    class _MJXSDK_EXPORT monotonic_allocator final : public allocator { // bump-pointer allocator with bulk release
+    public:
+        using value_type      = allocator::value_type;
+        using size_type       = allocator::size_type;
+        using difference_type = allocator::difference_type;
+        using pointer         = allocator::pointer;
+        using const_pointer   = allocator::const_pointer;
+
+        // the smallest chunk requested from the upstream allocator
+        static constexpr size_type min_chunk_size = 1024;
+
+        explicit monotonic_allocator(memory_resource& _Resource) noexcept;
+        explicit monotonic_allocator(allocator& _Upstream) noexcept;
+        monotonic_allocator(memory_resource& _Resource, allocator& _Upstream) noexcept;
+        ~monotonic_allocator() noexcept override;
+
+        monotonic_allocator(const monotonic_allocator&)            = delete;
+        monotonic_allocator& operator=(const monotonic_allocator&) = delete;
+
+        // allocates uninitialized storage with optional alignment
+        pointer allocate(size_type _Size, size_type _Align = 0) override;
+
+        // does nothing, memory is freed only by release()
+        void deallocate(pointer _Ptr, size_type _Size, size_type _Align = 0) noexcept override;
+
+        // resizes the most recent block in place if the current buffer has enough space left
+        bool try_expand_in_place(
+            pointer _Ptr, size_type _Old_size, size_type _New_size, size_type _Align = 0) noexcept override;
+
+        // returns the tag that identifies the allocator type
+        allocator_tag tag() const noexcept override;
+
+        // returns the largest supported allocation size
+        size_type max_size() const noexcept override;
+
+        // compares for equality with another allocator
+        bool is_equal(const allocator& _Other) const noexcept override;
+
+        // checks whether the memory block comes from the resource or one of the upstream chunks
+        bool contains(const_pointer _Ptr, const size_type _Size) const noexcept;
+
+        // returns the upstream allocator (if any)
+        allocator* upstream() const noexcept;
+
+        // frees all allocated memory, including chunks obtained from the upstream allocator
+        void release() noexcept;
+
+    private:
+        struct _Chunk_header;
+
+        // resets the current buffer to the beginning of the resource
+        void _Reset_buffer() noexcept;
+
+        // tries to allocate from the current buffer, returns null if there is not enough space
+        pointer _Try_allocate(const size_type _Size, const size_type _Align) noexcept;
+
+        // obtains a new chunk from the upstream allocator that can hold at least _Size bytes
+        void _Allocate_chunk(const size_type _Size, const size_type _Align);
+
+        memory_resource* _Myres;
+        allocator* _Myupstream;
+        _Chunk_header* _Mychunks; // chunks obtained from the upstream allocator
+        void* _Mycur; // the next free byte in the current buffer
+        void* _Myend; // the end of the current buffer
+        size_type _Mynext; // the size of the next chunk
+    };
+} // namespace mjx
+
+#endif // _MJXSDK_MEMORY_MONOTONIC_ALLOCATOR_HPP_
\ No newline at end of file
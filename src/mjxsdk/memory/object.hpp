@@ -27,29 +27,115 @@ namespace mjx {
         }
     }
 
+    namespace mjxsdk_impl {
+        template <compatible_allocator _Alloc>
+        inline void* _Allocate_using(_Alloc& _Al, const size_t _Size) {
+            // calls the final allocator directly, otherwise goes through the virtual table
+            if constexpr (static_allocator<_Alloc>) {
+                return _Al._Alloc::allocate(_Size);
+            } else {
+                return _Al.allocate(_Size);
+            }
+        }
+
+        template <compatible_allocator _Alloc>
+        inline void _Deallocate_using(_Alloc& _Al, void* const _Ptr, const size_t _Size) noexcept {
+            // calls the final allocator directly, otherwise goes through the virtual table
+            if constexpr (static_allocator<_Alloc>) {
+                _Al._Alloc::deallocate(_Ptr, _Size);
+            } else {
+                _Al.deallocate(_Ptr, _Size);
+            }
+        }
+
+        template <compatible_allocator _Alloc>
+        inline void _Allocate_bulk_using(_Alloc& _Al, const size_t _Size, const size_t _Count, void** const _Ptrs) {
+            // calls the final allocator directly, otherwise goes through the virtual table
+            if constexpr (static_allocator<_Alloc>) {
+                _Al._Alloc::allocate_bulk(_Size, 0, _Count, _Ptrs);
+            } else {
+                _Al.allocate_bulk(_Size, 0, _Count, _Ptrs);
+            }
+        }
+
+        template <compatible_allocator _Alloc>
+        inline void _Deallocate_bulk_using(
+            _Alloc& _Al, void* const* const _Ptrs, const size_t _Count, const size_t _Size) noexcept {
+            // calls the final allocator directly, otherwise goes through the virtual table
+            if constexpr (static_allocator<_Alloc>) {
+                _Al._Alloc::deallocate_bulk(_Ptrs, _Count, _Size);
+            } else {
+                _Al.deallocate_bulk(_Ptrs, _Count, _Size);
+            }
+        }
+
+        // the number of blocks passed to the allocator at once by the bulk object helpers
+        inline constexpr size_t _Bulk_batch_size = 64;
+
+        constexpr size_t _Next_bulk_batch(const size_t _Remaining) noexcept {
+            return _Remaining < _Bulk_batch_size ? _Remaining : _Bulk_batch_size;
+        }
+    } // namespace mjxsdk_impl
+
     template <class _Ty, compatible_allocator _Alloc>
     [[nodiscard]] inline _Ty* allocate_object_using_allocator(_Alloc& _Al) {
         // allocate memory for an object using the given allocator
-        return static_cast<_Ty*>(_Al.allocate(sizeof(_Ty)));
+        return static_cast<_Ty*>(mjxsdk_impl::_Allocate_using(_Al, sizeof(_Ty)));
     }
     
     template <class _Ty, compatible_allocator _Alloc>
     [[nodiscard]] inline _Ty* allocate_object_array_using_allocator(const size_t _Count, _Alloc& _Al) {
         // allocate memory for an array of objects using the given allocator
-        return static_cast<_Ty*>(_Al.allocate(_Count * sizeof(_Ty)));
+        return static_cast<_Ty*>(mjxsdk_impl::_Allocate_using(_Al, _Count * sizeof(_Ty)));
     }
 
     template <class _Ty, compatible_allocator _Alloc>
     inline void deallocate_object_using_allocator(_Ty* const _Obj, _Alloc& _Al) noexcept {
         // deallocate the object's memory using the given allocator
-        _Al.deallocate(_Obj, sizeof(_Ty));
+        mjxsdk_impl::_Deallocate_using(_Al, _Obj, sizeof(_Ty));
     }
 
     template <class _Ty, compatible_allocator _Alloc>
     inline void deallocate_object_array_using_allocator(
         _Ty* const _Array, const size_t _Count, _Alloc& _Al) noexcept {
         // deallocate the array's memory using the given allocator
-        _Al.deallocate(_Array, _Count * sizeof(_Ty));
+        mjxsdk_impl::_Deallocate_using(_Al, _Array, _Count * sizeof(_Ty));
+    }
+
+    template <class _Ty, compatible_allocator _Alloc>
+    inline void deallocate_objects_using_allocator(
+        _Ty* const* const _Objs, const size_t _Count, _Alloc& _Al) noexcept {
+        // deallocate the memory of separately allocated objects using the given allocator, in batches
+        void* _Blocks[mjxsdk_impl::_Bulk_batch_size];
+        for (size_t _Off = 0; _Off < _Count; _Off += mjxsdk_impl::_Bulk_batch_size) {
+            const size_t _Batch = mjxsdk_impl::_Next_bulk_batch(_Count - _Off);
+            for (size_t _Idx = 0; _Idx < _Batch; ++_Idx) {
+                _Blocks[_Idx] = _Objs[_Off + _Idx];
+            }
+
+            mjxsdk_impl::_Deallocate_bulk_using(_Al, _Blocks, _Batch, sizeof(_Ty));
+        }
+    }
+
+    template <class _Ty, compatible_allocator _Alloc>
+    inline void allocate_objects_using_allocator(_Ty** const _Objs, const size_t _Count, _Alloc& _Al) {
+        // allocate memory for separate objects using the given allocator, in batches, either all or none
+        void* _Blocks[mjxsdk_impl::_Bulk_batch_size];
+        size_t _Off = 0;
+        try {
+            while (_Off < _Count) {
+                const size_t _Batch = mjxsdk_impl::_Next_bulk_batch(_Count - _Off);
+                mjxsdk_impl::_Allocate_bulk_using(_Al, sizeof(_Ty), _Batch, _Blocks);
+                for (size_t _Idx = 0; _Idx < _Batch; ++_Idx) {
+                    _Objs[_Off + _Idx] = static_cast<_Ty*>(_Blocks[_Idx]);
+                }
+
+                _Off += _Batch;
+            }
+        } catch (...) {
+            ::mjx::deallocate_objects_using_allocator(_Objs, _Off, _Al); // return the batches allocated so far
+            throw;
+        }
     }
 
     template <class _Ty, compatible_allocator _Alloc, class... _Types>
@@ -71,6 +157,27 @@ namespace mjx {
         return _Ptr;
     }
 
+    template <class _Ty, compatible_allocator _Alloc, class... _Types>
+    inline void create_objects_using_allocator(
+        _Ty** const _Objs, const size_t _Count, _Alloc& _Al, const _Types&... _Args) {
+        // allocate memory for separate objects using the given allocator, in batches,
+        // then construct each object in-place from the same arguments
+        ::mjx::allocate_objects_using_allocator(_Objs, _Count, _Al);
+        size_t _Idx = 0;
+        try {
+            for (; _Idx < _Count; ++_Idx) {
+                ::mjx::construct_object(_Objs[_Idx], _Args...);
+            }
+        } catch (...) {
+            while (_Idx > 0) { // destroy the objects constructed so far
+                ::mjx::destroy_object(_Objs[--_Idx]);
+            }
+
+            ::mjx::deallocate_objects_using_allocator(_Objs, _Count, _Al);
+            throw;
+        }
+    }
+
     template <class _Ty, compatible_allocator _Alloc>
     inline void delete_object_using_allocator(_Ty* const _Obj, _Alloc& _Al)
         noexcept(::std::is_nothrow_destructible_v<_Ty>) {
@@ -98,6 +205,20 @@ namespace mjx {
         }
     }
 
+    template <class _Ty, compatible_allocator _Alloc>
+    inline void delete_objects_using_allocator(_Ty* const* const _Objs, const size_t _Count, _Alloc& _Al)
+        noexcept(::std::is_nothrow_destructible_v<_Ty>) {
+        // destroy each object (if they have non-trivial destructors)
+        // and deallocate their memory using the given allocator, in batches
+        if constexpr (!::std::is_trivially_destructible_v<_Ty>) {
+            for (size_t _Idx = 0; _Idx < _Count; ++_Idx) { // destroy each object separately
+                ::mjx::destroy_object(_Objs[_Idx]);
+            }
+        }
+
+        ::mjx::deallocate_objects_using_allocator(_Objs, _Count, _Al);
+    }
+
     template <class _Ty>
     [[nodiscard]] inline _Ty* allocate_object() {
         // allocate memory for an object using the global allocator
@@ -122,6 +243,18 @@ namespace mjx {
         ::mjx::deallocate_object_array_using_allocator(_Array, _Count, ::mjx::get_global_allocator());
     }
 
+    template <class _Ty>
+    inline void allocate_objects(_Ty** const _Objs, const size_t _Count) {
+        // allocate memory for separate objects using the global allocator, in batches, either all or none
+        ::mjx::allocate_objects_using_allocator(_Objs, _Count, ::mjx::get_global_allocator());
+    }
+
+    template <class _Ty>
+    inline void deallocate_objects(_Ty* const* const _Objs, const size_t _Count) noexcept {
+        // deallocate the memory of separately allocated objects using the global allocator, in batches
+        ::mjx::deallocate_objects_using_allocator(_Objs, _Count, ::mjx::get_global_allocator());
+    }
+
     template <class _Ty, class... _Types>
     [[nodiscard]] inline _Ty* create_object(_Types&&... _Args) {
         // allocate memory for an object using the global allocator, then construct the object in-place
@@ -136,6 +269,13 @@ namespace mjx {
         return ::mjx::create_object_array_using_allocator<_Ty>(_Count, ::mjx::get_global_allocator());
     }
 
+    template <class _Ty, class... _Types>
+    inline void create_objects(_Ty** const _Objs, const size_t _Count, const _Types&... _Args) {
+        // allocate memory for separate objects using the global allocator, in batches,
+        // then construct each object in-place from the same arguments
+        ::mjx::create_objects_using_allocator(_Objs, _Count, ::mjx::get_global_allocator(), _Args...);
+    }
+
     template <class _Ty>
     inline void delete_object(_Ty* const _Obj) noexcept(::std::is_nothrow_destructible_v<_Ty>) {
         // destroy the object (if it has a non-trivial destructor)
@@ -150,6 +290,14 @@ namespace mjx {
         // and deallocate the array's memory using the global allocator
         ::mjx::delete_object_array_using_allocator(_Array, _Count, ::mjx::get_global_allocator());
     }
+
+    template <class _Ty>
+    inline void delete_objects(_Ty* const* const _Objs, const size_t _Count)
+        noexcept(::std::is_nothrow_destructible_v<_Ty>) {
+        // destroy each object (if they have non-trivial destructors)
+        // and deallocate their memory using the global allocator, in batches
+        ::mjx::delete_objects_using_allocator(_Objs, _Count, ::mjx::get_global_allocator());
+    }
 } // namespace mjx
 
 #endif // _MJXSDK_MEMORY_OBJECT_HPP_
\ No newline at end of file
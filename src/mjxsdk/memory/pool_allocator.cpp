@@ -0,0 +1,247 @@
+// pool_allocator.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <algorithm>
+#include <mjxsdk/core/impl/utils.hpp>
+#include <mjxsdk/core/macros.hpp>
+#include <mjxsdk/memory/exception.hpp>
+#include <mjxsdk/memory/impl/allocation_hooks.hpp>
+#include <mjxsdk/memory/impl/utils.hpp>
+#include <mjxsdk/memory/pool_allocator.hpp>
+#include <utility>
+
+namespace mjx {
+    struct pool_allocator::_Free_block { // free block that stores the link to the next free block in-place
+        _Free_block* _Next;
+    };
+
+    struct pool_allocator::_Chunk_header { // header placed at the beginning of each upstream chunk
+        _Chunk_header* _Next;
+        size_type _Size;
+    };
+
+    namespace mjxsdk_impl {
+        constexpr size_t _Calculate_block_stride(const size_t _Size, const size_t _Align) noexcept {
+            // each block must be able to hold a free list link and start at an aligned address
+            const size_t _Min_size = _Size > sizeof(void*) ? _Size : sizeof(void*);
+            return _Align_value(_Min_size, _Align);
+        }
+    } // namespace mjxsdk_impl
+
+    pool_allocator::pool_allocator(
+        const size_type _Block_size, memory_resource& _Resource, const size_type _Block_align) noexcept
+        : _Myres(::std::addressof(_Resource)), _Myupstream(nullptr), _Mychunks(nullptr), _Myfree(nullptr),
+        _Mycur(nullptr), _Myend(nullptr), _Mysize(_Block_size),
+        _Myalign(mjxsdk_impl::_Get_effective_alignment(_Block_align)),
+        _Mystride(mjxsdk_impl::_Calculate_block_stride(_Mysize, _Myalign)) {
+        _Reset_region();
+    }
+
+    pool_allocator::pool_allocator(
+        const size_type _Block_size, allocator& _Upstream, const size_type _Block_align) noexcept
+        : _Myres(nullptr), _Myupstream(::std::addressof(_Upstream)), _Mychunks(nullptr), _Myfree(nullptr),
+        _Mycur(nullptr), _Myend(nullptr), _Mysize(_Block_size),
+        _Myalign(mjxsdk_impl::_Get_effective_alignment(_Block_align)),
+        _Mystride(mjxsdk_impl::_Calculate_block_stride(_Mysize, _Myalign)) {}
+
+    pool_allocator::pool_allocator(const size_type _Block_size, memory_resource& _Resource,
+        allocator& _Upstream, const size_type _Block_align) noexcept
+        : _Myres(::std::addressof(_Resource)), _Myupstream(::std::addressof(_Upstream)), _Mychunks(nullptr),
+        _Myfree(nullptr), _Mycur(nullptr), _Myend(nullptr), _Mysize(_Block_size),
+        _Myalign(mjxsdk_impl::_Get_effective_alignment(_Block_align)),
+        _Mystride(mjxsdk_impl::_Calculate_block_stride(_Mysize, _Myalign)) {
+        _Reset_region();
+    }
+
+    pool_allocator::~pool_allocator() noexcept {
+        release();
+    }
+
+    void pool_allocator::_Reset_region() noexcept {
+        if (_Myres && !_Myres->empty()) { // carve blocks from the resource
+            _Mycur = mjxsdk_impl::_Align_address(_Myres->data(), _Myalign);
+            _Myend = mjxsdk_impl::_Adjust_address_by_offset(_Myres->data(), _Myres->size());
+            if (_Mycur > _Myend) { // the resource is too small to hold even an aligned address
+                _Mycur = _Myend;
+            }
+        } else { // no resource, wait for the first upstream chunk
+            _Mycur = nullptr;
+            _Myend = nullptr;
+        }
+    }
+
+    void pool_allocator::_Allocate_chunk() {
+        // reserve enough space for the header, the alignment padding and all blocks
+        mjxsdk_impl::_Internal_allocation_scope _Scope; // the blocks are reported, not the chunk
+        constexpr size_type _Header_size = sizeof(_Chunk_header);
+        const size_type _Chunk_size      = _Header_size + _Myalign + _Mystride * blocks_per_chunk;
+        _Chunk_header* const _Chunk      = static_cast<_Chunk_header*>(_Myupstream->allocate(_Chunk_size));
+        _Chunk->_Next                    = _Mychunks;
+        _Chunk->_Size                    = _Chunk_size;
+        _Mychunks                        = _Chunk;
+        _Mycur = mjxsdk_impl::_Align_address(
+            mjxsdk_impl::_Adjust_address_by_offset(_Chunk, _Header_size), _Myalign);
+        _Myend = mjxsdk_impl::_Adjust_address_by_offset(_Chunk, _Chunk_size);
+    }
+
+    void pool_allocator::_Check_request(const size_type _Size, const size_type _Align) const {
+        if (_Size > _Mysize) { // the block cannot hold the requested size, raise an exception
+            allocation_limit_exceeded::raise();
+        }
+
+        if (mjxsdk_impl::_Get_effective_alignment(_Align) > _Myalign) { // unsupported alignment
+            allocation_failure::raise();
+        }
+    }
+
+    pool_allocator::pointer pool_allocator::_Allocate_block() {
+        if (_Myfree) { // reuse the most recently freed block
+            _Free_block* const _Block = _Myfree;
+            _Myfree                   = _Block->_Next;
+            return _Block;
+        }
+
+        if (mjxsdk_impl::_Distance_between(_Mycur, _Myend) < _Mystride) { // the region is exhausted
+            if (!_Myupstream) { // no upstream allocator, raise an exception
+                allocation_limit_exceeded::raise();
+            }
+
+            _Allocate_chunk();
+        }
+
+        void* const _Block = _Mycur;
+        _Mycur             = mjxsdk_impl::_Adjust_address_by_offset(_Mycur, _Mystride);
+        return _Block;
+    }
+
+    pool_allocator::pointer pool_allocator::allocate(size_type _Size, size_type _Align) {
+        if (_Size == 0) { // no allocation, do nothing
+            return nullptr;
+        }
+
+        _Check_request(_Size, _Align);
+        void* const _Ptr = _Allocate_block();
+        mjxsdk_impl::_Report_allocation(_Ptr, _Size, _Align, allocator_tag::pool, _MJX_RETURN_ADDRESS());
+        return _Ptr;
+    }
+
+    void pool_allocator::deallocate(pointer _Ptr, size_type _Size, size_type _Align) noexcept {
+        if (!_Ptr) { // invalid block, break
+            return;
+        }
+
+        mjxsdk_impl::_Report_deallocation(_Ptr, _Size, _Align, allocator_tag::pool);
+        _Free_block* const _Block = static_cast<_Free_block*>(_Ptr);
+        _Block->_Next             = _Myfree;
+        _Myfree                   = _Block;
+    }
+
+    void pool_allocator::allocate_bulk(size_type _Size, size_type _Align, size_type _Count, pointer* _Ptrs) {
+        if (_Size == 0) { // no allocation, fill with null pointers
+            ::std::fill_n(_Ptrs, _Count, nullptr);
+            return;
+        }
+
+        _Check_request(_Size, _Align); // check once for the whole batch
+        const void* const _Return_address = _MJX_RETURN_ADDRESS();
+        size_type _Idx                    = 0;
+        try {
+            for (; _Idx < _Count; ++_Idx) {
+                _Ptrs[_Idx] = _Allocate_block();
+                mjxsdk_impl::_Report_allocation(_Ptrs[_Idx], _Size, _Align, allocator_tag::pool, _Return_address);
+            }
+        } catch (...) {
+            deallocate_bulk(_Ptrs, _Idx, _Size, _Align); // return the blocks allocated so far
+            throw;
+        }
+    }
+
+    void pool_allocator::deallocate_bulk(
+        const pointer* _Ptrs, size_type _Count, size_type _Size, size_type _Align) noexcept {
+        // link the blocks in order, then splice the whole chain onto the free list
+        if (_Count == 0 || _Size == 0) { // no blocks, do nothing
+            return;
+        }
+
+        if (mjxsdk_impl::_Is_reporting_allocations()) { // let the diagnostic tools observe each block
+            for (size_type _Idx = 0; _Idx < _Count; ++_Idx) {
+                mjxsdk_impl::_Invoke_deallocation_hooks(_Ptrs[_Idx], _Size, _Align, allocator_tag::pool);
+            }
+        }
+
+        for (size_type _Idx = 0; _Idx < _Count - 1; ++_Idx) {
+            static_cast<_Free_block*>(_Ptrs[_Idx])->_Next = static_cast<_Free_block*>(_Ptrs[_Idx + 1]);
+        }
+
+        static_cast<_Free_block*>(_Ptrs[_Count - 1])->_Next = _Myfree;
+        _Myfree                                             = static_cast<_Free_block*>(_Ptrs[0]);
+    }
+
+    bool pool_allocator::try_expand_in_place(
+        pointer _Ptr, size_type, size_type _New_size, size_type) noexcept {
+        if (mjxsdk_impl::_Is_reporting_allocations()) { // let the caller reallocate, so that the hooks see the block
+            return false;
+        }
+
+        return _Ptr && _New_size > 0 && _New_size <= _Mysize;
+    }
+
+    pool_allocator::size_type pool_allocator::good_size(size_type _Size, size_type) const noexcept {
+        return _Size == 0 || _Size > _Mysize ? _Size : _Mysize;
+    }
+
+    allocator_tag pool_allocator::tag() const noexcept {
+        return allocator_tag::pool;
+    }
+
+    pool_allocator::size_type pool_allocator::max_size() const noexcept {
+        return _Mysize;
+    }
+
+    bool pool_allocator::is_equal(const allocator& _Other) const noexcept {
+        // stateful allocator, equal only to itself
+        return this == ::std::addressof(_Other);
+    }
+
+    bool pool_allocator::contains(const_pointer _Ptr, const size_type _Size) const noexcept {
+        if (_Myres && _Myres->contains(_Ptr, _Size)) { // the block comes from the resource
+            return true;
+        }
+
+        const void* const _End = mjxsdk_impl::_Adjust_address_by_offset(_Ptr, _Size);
+        for (const _Chunk_header* _Chunk = _Mychunks; _Chunk; _Chunk = _Chunk->_Next) {
+            if (mjxsdk_impl::_Is_within_memory_block(
+                _Chunk, mjxsdk_impl::_Adjust_address_by_offset(_Chunk, _Chunk->_Size), _Ptr, _End)) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    pool_allocator::size_type pool_allocator::block_size() const noexcept {
+        return _Mysize;
+    }
+
+    pool_allocator::size_type pool_allocator::block_align() const noexcept {
+        return _Myalign;
+    }
+
+    allocator* pool_allocator::upstream() const noexcept {
+        return _Myupstream;
+    }
+
+    void pool_allocator::release() noexcept {
+        mjxsdk_impl::_Internal_allocation_scope _Scope; // the chunks were never reported
+        while (_Mychunks) { // return each chunk to the upstream allocator
+            _Chunk_header* const _Next = _Mychunks->_Next;
+            _Myupstream->deallocate(_Mychunks, _Mychunks->_Size);
+            _Mychunks = _Next;
+        }
+
+        _Myfree = nullptr;
+        _Reset_region();
+    }
+} // namespace mjx
\ No newline at end of file
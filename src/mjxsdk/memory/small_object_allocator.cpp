@@ -0,0 +1,152 @@
+// small_object_allocator.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <mjxsdk/core/macros.hpp>
+#include <mjxsdk/memory/impl/allocation_hooks.hpp>
+#include <mjxsdk/memory/impl/global_allocator.hpp>
+#include <mjxsdk/memory/impl/size_class.hpp>
+#include <mjxsdk/memory/impl/slab_pool.hpp>
+#include <mjxsdk/memory/object.hpp>
+#include <mjxsdk/memory/small_object_allocator.hpp>
+#include <utility>
+
+namespace mjx {
+    static_assert(small_object_allocator::max_small_size == mjxsdk_impl::_Size_class_limit,
+        "the size class table must cover all small sizes");
+
+    small_object_allocator::small_object_allocator()
+        : _Mypools(::mjx::create_object_array_using_allocator<mjxsdk_impl::_Slab_pool>(
+            mjxsdk_impl::_Size_class_count, mjxsdk_impl::_Get_internal_allocator())) {
+        for (size_t _Idx = 0; _Idx < mjxsdk_impl::_Size_class_count; ++_Idx) {
+            _Mypools[_Idx]._Set_block_size(mjxsdk_impl::_Size_class_table[_Idx]);
+        }
+    }
+
+    small_object_allocator::~small_object_allocator() noexcept {
+        ::mjx::delete_object_array_using_allocator(
+            _Mypools, mjxsdk_impl::_Size_class_count, mjxsdk_impl::_Get_internal_allocator());
+    }
+
+    small_object_allocator::pointer small_object_allocator::allocate(size_type _Size, size_type _Align) {
+        if (_Size == 0) { // no allocation, do nothing
+            return nullptr;
+        }
+
+        void* _Ptr;
+        if (mjxsdk_impl::_Fits_size_class(_Size, _Align)) { // small block, use the size class pool
+            _Ptr = _Mypools[mjxsdk_impl::_Size_class_index(_Size)]._Allocate();
+        } else { // large block, use the system allocator
+            mjxsdk_impl::_Internal_allocation_scope _Scope;
+            _Ptr = mjxsdk_impl::_Get_internal_allocator().allocate(_Size, _Align);
+        }
+
+        mjxsdk_impl::_Report_allocation(_Ptr, _Size, _Align, allocator_tag::small_object, _MJX_RETURN_ADDRESS());
+        return _Ptr;
+    }
+
+    void small_object_allocator::deallocate(pointer _Ptr, size_type _Size, size_type _Align) noexcept {
+        if (!_Ptr || _Size == 0) { // invalid block, break
+            return;
+        }
+
+        mjxsdk_impl::_Report_deallocation(_Ptr, _Size, _Align, allocator_tag::small_object);
+        if (!mjxsdk_impl::_Fits_size_class(_Size, _Align)) { // large block, use the system allocator
+            mjxsdk_impl::_Internal_allocation_scope _Scope;
+            mjxsdk_impl::_Get_internal_allocator().deallocate(_Ptr, _Size, _Align);
+            return;
+        }
+
+        _Mypools[mjxsdk_impl::_Size_class_index(_Size)]._Deallocate(_Ptr);
+    }
+
+    void small_object_allocator::allocate_bulk(
+        size_type _Size, size_type _Align, size_type _Count, pointer* _Ptrs) {
+        if (_Size == 0 || !mjxsdk_impl::_Fits_size_class(_Size, _Align)
+            || mjxsdk_impl::_Is_reporting_allocations()) { // allocate each block separately
+            allocator::allocate_bulk(_Size, _Align, _Count, _Ptrs);
+            return;
+        }
+
+        _Mypools[mjxsdk_impl::_Size_class_index(_Size)]._Allocate_batch(_Ptrs, _Count);
+    }
+
+    void small_object_allocator::deallocate_bulk(
+        const pointer* _Ptrs, size_type _Count, size_type _Size, size_type _Align) noexcept {
+        if (_Size == 0 || !mjxsdk_impl::_Fits_size_class(_Size, _Align)
+            || mjxsdk_impl::_Is_reporting_allocations()) { // deallocate each block separately
+            allocator::deallocate_bulk(_Ptrs, _Count, _Size, _Align);
+            return;
+        }
+
+        _Mypools[mjxsdk_impl::_Size_class_index(_Size)]._Deallocate_batch(_Ptrs, _Count);
+    }
+
+    bool small_object_allocator::try_expand_in_place(
+        pointer _Ptr, size_type _Old_size, size_type _New_size, size_type _Align) noexcept {
+        if (!_Ptr || _Old_size == 0 || _New_size == 0) { // invalid block, break
+            return false;
+        }
+
+        if (mjxsdk_impl::_Is_reporting_allocations()) { // let the caller reallocate, so that the hooks see the block
+            return false;
+        }
+
+        const bool _Old_small = mjxsdk_impl::_Fits_size_class(_Old_size, _Align);
+        if (_Old_small != mjxsdk_impl::_Fits_size_class(_New_size, _Align)) { // the block would change its owner
+            return false;
+        }
+
+        if (!_Old_small) { // large block, served by the system allocator
+            return mjxsdk_impl::_Get_internal_allocator().try_expand_in_place(_Ptr, _Old_size, _New_size, _Align);
+        }
+
+        return mjxsdk_impl::_Size_class_index(_Old_size) == mjxsdk_impl::_Size_class_index(_New_size);
+    }
+
+    small_object_allocator::pointer small_object_allocator::reallocate(
+        pointer _Ptr, size_type _Old_size, size_type _New_size, size_type _Align) {
+        if (_Ptr && !mjxsdk_impl::_Fits_size_class(_Old_size, _Align)
+            && !mjxsdk_impl::_Fits_size_class(_New_size, _Align)
+            && !mjxsdk_impl::_Is_reporting_allocations()) { // large block, let the system allocator move it
+            return mjxsdk_impl::_Get_internal_allocator().reallocate(_Ptr, _Old_size, _New_size, _Align);
+        }
+
+        return allocator::reallocate(_Ptr, _Old_size, _New_size, _Align);
+    }
+
+    allocation_result small_object_allocator::allocate_at_least(size_type _Size, size_type _Align) {
+        if (_Size != 0 && !mjxsdk_impl::_Fits_size_class(_Size, _Align)
+            && !mjxsdk_impl::_Is_reporting_allocations()) { // large block, use the system allocator
+            return mjxsdk_impl::_Get_internal_allocator().allocate_at_least(_Size, _Align);
+        }
+
+        return allocator::allocate_at_least(_Size, _Align);
+    }
+
+    small_object_allocator::size_type small_object_allocator::good_size(size_type _Size, size_type _Align) const noexcept {
+        if (_Size == 0) { // no allocation, no rounding
+            return 0;
+        }
+
+        if (!mjxsdk_impl::_Fits_size_class(_Size, _Align)) { // large block, use the system allocator
+            return mjxsdk_impl::_Get_internal_allocator().good_size(_Size, _Align);
+        }
+
+        return mjxsdk_impl::_Size_class_size(mjxsdk_impl::_Size_class_index(_Size));
+    }
+
+    allocator_tag small_object_allocator::tag() const noexcept {
+        return allocator_tag::small_object;
+    }
+
+    small_object_allocator::size_type small_object_allocator::max_size() const noexcept {
+        return mjxsdk_impl::_Get_internal_allocator().max_size();
+    }
+
+    bool small_object_allocator::is_equal(const allocator& _Other) const noexcept {
+        // stateful allocator, equal only to itself
+        return this == ::std::addressof(_Other);
+    }
+} // namespace mjx
\ No newline at end of file
@@ -0,0 +1,74 @@
+// small_object_allocator.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _MJXSDK_MEMORY_SMALL_OBJECT_ALLOCATOR_HPP_
+#define _MJXSDK_MEMORY_SMALL_OBJECT_ALLOCATOR_HPP_
+#include <mjxsdk/core/export.hpp>
+#include <mjxsdk/memory/allocator.hpp>
+
+namespace mjx {
+    namespace mjxsdk_impl {
+        class _Slab_pool;
+    } // namespace mjxsdk_impl
+
+    class _MJXSDK_EXPORT small_object_allocator final : public allocator { // thread-safe size-class allocator
+    public:
+        using value_type      = allocator::value_type;
+        using size_type       = allocator::size_type;
+        using difference_type = allocator::difference_type;
+        using pointer         = allocator::pointer;
+        using const_pointer   = allocator::const_pointer;
+
+        // the largest size served from the size classes, larger blocks come from the system allocator
+        static constexpr size_type max_small_size = 1024;
+
+        small_object_allocator();
+        ~small_object_allocator() noexcept override;
+
+        small_object_allocator(const small_object_allocator&)            = delete;
+        small_object_allocator& operator=(const small_object_allocator&) = delete;
+
+        // allocates uninitialized storage with optional alignment
+        pointer allocate(size_type _Size, size_type _Align = 0) override;
+
+        // deallocates storage with optional alignment
+        void deallocate(pointer _Ptr, size_type _Size, size_type _Align = 0) noexcept override;
+
+        // allocates _Count blocks of the same size class under a single lock, either all or none
+        void allocate_bulk(size_type _Size, size_type _Align, size_type _Count, pointer* _Ptrs) override;
+
+        // deallocates _Count blocks of the same size class under a single lock
+        void deallocate_bulk(
+            const pointer* _Ptrs, size_type _Count, size_type _Size, size_type _Align = 0) noexcept override;
+
+        // succeeds as long as the new size belongs to the same size class
+        bool try_expand_in_place(
+            pointer _Ptr, size_type _Old_size, size_type _New_size, size_type _Align = 0) noexcept override;
+
+        // resizes the block, large blocks are resized by the system allocator
+        pointer reallocate(pointer _Ptr, size_type _Old_size, size_type _New_size, size_type _Align = 0) override;
+
+        // allocates at least _Size bytes, large blocks report the usable size given by the system allocator
+        allocation_result allocate_at_least(size_type _Size, size_type _Align = 0) override;
+
+        // returns the size of the size class that serves the request
+        size_type good_size(size_type _Size, size_type _Align = 0) const noexcept override;
+
+        // returns the tag that identifies the allocator type
+        allocator_tag tag() const noexcept override;
+
+        // returns the largest supported allocation size
+        size_type max_size() const noexcept override;
+
+        // compares for equality with another allocator
+        bool is_equal(const allocator& _Other) const noexcept override;
+
+    private:
+        mjxsdk_impl::_Slab_pool* _Mypools; // one pool per size class
+    };
+} // namespace mjx
+
+#endif // _MJXSDK_MEMORY_SMALL_OBJECT_ALLOCATOR_HPP_
\ No newline at end of file
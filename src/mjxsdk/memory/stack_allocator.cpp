@@ -0,0 +1,168 @@
+// stack_allocator.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <mjxsdk/core/impl/assert.hpp>
+#include <mjxsdk/core/impl/utils.hpp>
+#include <mjxsdk/memory/exception.hpp>
+#include <mjxsdk/memory/impl/utils.hpp>
+#include <mjxsdk/memory/stack_allocator.hpp>
+#include <utility>
+
+namespace mjx {
+    namespace mjxsdk_impl {
+#ifdef _DEBUG
+        struct _Stack_link { // precedes each block in debug mode to verify the deallocation order
+            void* _Prev_top;
+            void* _Prev_last;
+        };
+
+        inline constexpr size_t _Stack_link_size = sizeof(_Stack_link);
+#else // ^^^ _DEBUG ^^^ / vvv NDEBUG vvv
+        inline constexpr size_t _Stack_link_size = 0;
+#endif // _DEBUG
+
+        inline void* _Align_stack_top(void* const _Top) noexcept {
+            // keeps the top aligned, so that a popped block ends exactly at the top
+            return _Align_address(_Top, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+        }
+    } // namespace mjxsdk_impl
+
+    stack_allocator::marker::marker(void* const _Top, void* const _Last) noexcept
+        : _Mytop(_Top), _Mylast(_Last) {}
+
+    stack_allocator::stack_allocator(memory_resource& _Resource) noexcept
+        : _Myres(::std::addressof(_Resource)), _Mytop(nullptr), _Myend(nullptr), _Mylast(nullptr) {
+        release();
+    }
+
+    stack_allocator::~stack_allocator() noexcept {}
+
+    stack_allocator::pointer stack_allocator::allocate(size_type _Size, size_type _Align) {
+        if (_Size == 0) { // no allocation, do nothing
+            return nullptr;
+        }
+
+        if (!_Mytop) { // empty resource, raise an exception
+            allocation_limit_exceeded::raise();
+        }
+
+        void* const _Block = mjxsdk_impl::_Align_address(
+            mjxsdk_impl::_Adjust_address_by_offset(_Mytop, mjxsdk_impl::_Stack_link_size),
+            mjxsdk_impl::_Get_effective_alignment(_Align));
+        if (_Block > _Myend || mjxsdk_impl::_Distance_between(_Block, _Myend) < _Size) {
+            allocation_limit_exceeded::raise(); // not enough space left, raise an exception
+        }
+
+#ifdef _DEBUG
+        mjxsdk_impl::_Stack_link* const _Link = static_cast<mjxsdk_impl::_Stack_link*>(
+            mjxsdk_impl::_Adjust_address_by_offset(_Block, -static_cast<ptrdiff_t>(mjxsdk_impl::_Stack_link_size)));
+        _Link->_Prev_top  = _Mytop;
+        _Link->_Prev_last = _Mylast;
+        _Mylast           = _Block;
+#endif // _DEBUG
+        _Mytop = mjxsdk_impl::_Align_stack_top(mjxsdk_impl::_Adjust_address_by_offset(_Block, _Size));
+        if (_Mytop > _Myend) { // the last block ends at an unaligned end of the resource
+            _Mytop = _Myend;
+        }
+
+        return _Block;
+    }
+
+    void stack_allocator::deallocate(pointer _Ptr, size_type _Size, size_type) noexcept {
+        if (!_Ptr || _Size == 0) { // invalid block, break
+            return;
+        }
+
+#ifdef _DEBUG
+        // the LIFO order is verified, so the block is always on top and the previous top is restored exactly
+        static_cast<void>(_Size);
+        _INTERNAL_ASSERT(_Ptr == _Mylast, "Block at 0x%p was not deallocated in LIFO order.", _Ptr);
+        const mjxsdk_impl::_Stack_link* const _Link = static_cast<const mjxsdk_impl::_Stack_link*>(
+            mjxsdk_impl::_Adjust_address_by_offset(_Ptr, -static_cast<ptrdiff_t>(mjxsdk_impl::_Stack_link_size)));
+        _Mytop  = _Link->_Prev_top;
+        _Mylast = _Link->_Prev_last;
+#else // ^^^ _DEBUG ^^^ / vvv NDEBUG vvv
+        // Note: Only the top block is popped. The padding in front of an over-aligned block, and any block
+        //       deallocated out of order, stay in use until the stack is rewound.
+        void* const _End = mjxsdk_impl::_Adjust_address_by_offset(_Ptr, _Size);
+        if (_End == _Mytop || mjxsdk_impl::_Align_stack_top(_End) == _Mytop) {
+            _Mytop = _Ptr;
+        }
+#endif // _DEBUG
+    }
+
+    bool stack_allocator::try_expand_in_place(
+        pointer _Ptr, size_type _Old_size, size_type _New_size, size_type) noexcept {
+        if (!_Ptr || _Old_size == 0) { // invalid block, break
+            return false;
+        }
+
+#ifdef _DEBUG
+        const bool _Is_top = _Ptr == _Mylast;
+#else // ^^^ _DEBUG ^^^ / vvv NDEBUG vvv
+        void* const _End   = mjxsdk_impl::_Adjust_address_by_offset(_Ptr, _Old_size);
+        const bool _Is_top = _End == _Mytop || mjxsdk_impl::_Align_stack_top(_End) == _Mytop;
+#endif // _DEBUG
+        if (!_Is_top) { // only the top block can change its size
+            return _Old_size == _New_size;
+        }
+
+        if (_New_size == 0 || _New_size > mjxsdk_impl::_Distance_between(_Ptr, _Myend)) { // invalid size
+            return false;
+        }
+
+        _Mytop = mjxsdk_impl::_Align_stack_top(mjxsdk_impl::_Adjust_address_by_offset(_Ptr, _New_size));
+        if (_Mytop > _Myend) { // the block ends at an unaligned end of the resource
+            _Mytop = _Myend;
+        }
+
+        return true;
+    }
+
+    allocator_tag stack_allocator::tag() const noexcept {
+        return allocator_tag::stack;
+    }
+
+    stack_allocator::size_type stack_allocator::max_size() const noexcept {
+        return _Myres->size();
+    }
+
+    bool stack_allocator::is_equal(const allocator& _Other) const noexcept {
+        // stateful allocator, equal only to itself
+        return this == ::std::addressof(_Other);
+    }
+
+    bool stack_allocator::contains(const_pointer _Ptr, const size_type _Size) const noexcept {
+        return _Myres->contains(_Ptr, _Size);
+    }
+
+    stack_allocator::marker stack_allocator::mark() const noexcept {
+        return marker{_Mytop, _Mylast};
+    }
+
+    void stack_allocator::rewind(const marker _Marker) noexcept {
+#ifdef _DEBUG
+        _INTERNAL_ASSERT(_Marker._Mytop <= _Mytop, "Marker 0x%p is above the top of the stack.", _Marker._Mytop);
+#endif // _DEBUG
+        _Mytop  = _Marker._Mytop;
+        _Mylast = _Marker._Mylast;
+    }
+
+    stack_allocator::size_type stack_allocator::used() const noexcept {
+        return _Mytop ? mjxsdk_impl::_Distance_between(_Myres->data(), _Mytop) : 0;
+    }
+
+    void stack_allocator::release() noexcept {
+        if (_Myres->empty()) { // nothing to allocate from
+            _Mytop = nullptr;
+            _Myend = nullptr;
+        } else {
+            _Mytop = _Myres->data();
+            _Myend = mjxsdk_impl::_Adjust_address_by_offset(_Mytop, _Myres->size());
+        }
+
+        _Mylast = nullptr;
+    }
+} // namespace mjx
\ No newline at end of file
@@ -0,0 +1,80 @@
+// stack_allocator.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _MJXSDK_MEMORY_STACK_ALLOCATOR_HPP_
+#define _MJXSDK_MEMORY_STACK_ALLOCATOR_HPP_
+#include <mjxsdk/core/export.hpp>
+#include <mjxsdk/memory/allocator.hpp>
+#include <mjxsdk/memory/memory_resource.hpp>
+
+namespace mjx {
+    class _MJXSDK_EXPORT stack_allocator final : public allocator { // LIFO allocator with markers over a resource
+    public:
+        using value_type      = allocator::value_type;
+        using size_type       = allocator::size_type;
+        using difference_type = allocator::difference_type;
+        using pointer         = allocator::pointer;
+        using const_pointer   = allocator::const_pointer;
+
+        class marker { // position in the stack that can be restored with rewind()
+        private:
+            friend stack_allocator;
+
+            marker(void* const _Top, void* const _Last) noexcept;
+
+            void* _Mytop;
+            void* _Mylast; // the most recent block, used only in debug mode
+        };
+
+        explicit stack_allocator(memory_resource& _Resource) noexcept;
+        ~stack_allocator() noexcept override;
+
+        stack_allocator(const stack_allocator&)            = delete;
+        stack_allocator& operator=(const stack_allocator&) = delete;
+
+        // allocates uninitialized storage on top of the stack
+        pointer allocate(size_type _Size, size_type _Align = 0) override;
+
+        // pops the block if it is on top of the stack, blocks must be deallocated in LIFO order
+        void deallocate(pointer _Ptr, size_type _Size, size_type _Align = 0) noexcept override;
+
+        // resizes the top block in place if the resource has enough space left
+        bool try_expand_in_place(
+            pointer _Ptr, size_type _Old_size, size_type _New_size, size_type _Align = 0) noexcept override;
+
+        // returns the tag that identifies the allocator type
+        allocator_tag tag() const noexcept override;
+
+        // returns the largest supported allocation size
+        size_type max_size() const noexcept override;
+
+        // compares for equality with another allocator
+        bool is_equal(const allocator& _Other) const noexcept override;
+
+        // checks whether the memory block comes from the managed resource
+        bool contains(const_pointer _Ptr, const size_type _Size) const noexcept;
+
+        // returns the current top of the stack
+        marker mark() const noexcept;
+
+        // frees all blocks allocated since the marker was taken
+        void rewind(const marker _Marker) noexcept;
+
+        // returns the number of bytes in use, including the alignment padding
+        size_type used() const noexcept;
+
+        // frees all blocks at once
+        void release() noexcept;
+
+    private:
+        memory_resource* _Myres;
+        void* _Mytop; // the first free byte
+        void* _Myend; // the end of the resource
+        void* _Mylast; // the most recent block, used only in debug mode
+    };
+} // namespace mjx
+
+#endif // _MJXSDK_MEMORY_STACK_ALLOCATOR_HPP_
\ No newline at end of file
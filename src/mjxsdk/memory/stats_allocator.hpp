@@ -0,0 +1,267 @@
+// stats_allocator.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _MJXSDK_MEMORY_STATS_ALLOCATOR_HPP_
+#define _MJXSDK_MEMORY_STATS_ALLOCATOR_HPP_
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mjxsdk/memory/allocator.hpp>
+#include <mjxsdk/memory/impl/utils.hpp>
+#include <type_traits>
+#include <utility>
+
+namespace mjx {
+    // the number of histogram buckets, bucket 0 counts sizes up to 16 bytes, each next bucket doubles
+    // the limit, and the last one counts everything above 4 MiB
+    inline constexpr size_t allocation_histogram_size = 20;
+
+    struct allocation_stats { // snapshot of the statistics collected by stats_allocator
+        uint64_t allocations; // the number of successful allocations
+        uint64_t deallocations; // the number of deallocations
+        uint64_t reallocations; // the number of successful reallocations and in-place resizes
+        uint64_t allocated_bytes; // the total number of bytes allocated
+        uint64_t deallocated_bytes; // the total number of bytes deallocated
+        uint64_t live_bytes; // the number of bytes that are currently allocated
+        uint64_t peak_bytes; // the highest observed number of live bytes
+        ::std::array<uint64_t, allocation_histogram_size> histogram; // allocations per size bucket
+    };
+
+    namespace mjxsdk_impl {
+        inline constexpr size_t _Stats_slot_count = 32;
+
+        // live bytes are published to the shared counter once a slot accumulates this many
+        inline constexpr int64_t _Stats_publish_threshold = 64 * 1024;
+
+        inline size_t _Get_stats_slot_index() noexcept {
+            // assigns consecutive slots to threads in the order in which they first record an event
+            static ::std::atomic<size_t> _Next_slot{0};
+            static thread_local const size_t _Slot =
+                _Next_slot.fetch_add(1, ::std::memory_order_relaxed) % _Stats_slot_count;
+            return _Slot;
+        }
+
+        constexpr size_t _Get_histogram_bucket(const size_t _Size) noexcept {
+            constexpr size_t _Min_bucket_log2 = 4; // the limit of the first bucket is 16 bytes
+            const size_t _Log2                = _Size <= 1 ? 0 : static_cast<size_t>(::std::bit_width(_Size - 1));
+            const size_t _Bucket              = _Log2 > _Min_bucket_log2 ? _Log2 - _Min_bucket_log2 : 0;
+            return _Bucket < allocation_histogram_size ? _Bucket : allocation_histogram_size - 1;
+        }
+
+        struct alignas(_Cache_line_size) _Stats_slot { // counters updated by the threads mapped to this slot
+            ::std::atomic<uint64_t> _Allocations{0};
+            ::std::atomic<uint64_t> _Deallocations{0};
+            ::std::atomic<uint64_t> _Reallocations{0};
+            ::std::atomic<uint64_t> _Allocated_bytes{0};
+            ::std::atomic<uint64_t> _Deallocated_bytes{0};
+            ::std::atomic<int64_t> _Live_delta{0}; // live bytes not published to the shared counter yet
+            ::std::array<::std::atomic<uint64_t>, allocation_histogram_size> _Histogram{};
+        };
+    } // namespace mjxsdk_impl
+
+    // Note: Each thread updates the counters of its own cache-line aligned slot with relaxed atomics, so the
+    //       hot path never touches a shared cache line. Counters are summed only when a snapshot is taken.
+    //       Live bytes are published to a shared counter in batches, so the peak is exact only up to
+    //       the number of slots multiplied by the publish threshold.
+    template <compatible_allocator _Upstream>
+    class stats_allocator final : public allocator { // records statistics of the upstream allocator
+    public:
+        using value_type      = allocator::value_type;
+        using size_type       = allocator::size_type;
+        using difference_type = allocator::difference_type;
+        using pointer         = allocator::pointer;
+        using const_pointer   = allocator::const_pointer;
+        using upstream_type   = _Upstream;
+
+        // a stats_allocator is not an argument, the copy constructor stays deleted
+        template <class... _Types>
+            requires (!::std::is_same_v<::std::remove_cvref_t<_Types>, stats_allocator> && ...)
+        explicit stats_allocator(_Types&&... _Args)
+            : _Myupstream(::std::forward<_Types>(_Args)...), _Myslots(), _Mylive(0), _Mypeak(0) {}
+
+        stats_allocator(const stats_allocator&)            = delete;
+        stats_allocator& operator=(const stats_allocator&) = delete;
+
+        // allocates from the upstream allocator and records the allocation
+        pointer allocate(size_type _Size, size_type _Align = 0) override {
+            pointer _Ptr = _Myupstream._Upstream::allocate(_Size, _Align);
+            if (_Ptr) {
+                _Record_allocations(_Size, 1);
+            }
+
+            return _Ptr;
+        }
+
+        // records the deallocation and returns the block to the upstream allocator
+        void deallocate(pointer _Ptr, size_type _Size, size_type _Align = 0) noexcept override {
+            if (_Ptr) {
+                _Record_deallocations(_Size, 1);
+            }
+
+            _Myupstream._Upstream::deallocate(_Ptr, _Size, _Align);
+        }
+
+        // allocates the whole batch from the upstream allocator and records it at once
+        void allocate_bulk(size_type _Size, size_type _Align, size_type _Count, pointer* _Ptrs) override {
+            _Myupstream._Upstream::allocate_bulk(_Size, _Align, _Count, _Ptrs);
+            if (_Size != 0 && _Count != 0) {
+                _Record_allocations(_Size, _Count);
+            }
+        }
+
+        // records the whole batch at once and returns it to the upstream allocator
+        void deallocate_bulk(
+            const pointer* _Ptrs, size_type _Count, size_type _Size, size_type _Align = 0) noexcept override {
+            if (_Size != 0 && _Count != 0) {
+                _Record_deallocations(_Size, _Count);
+            }
+
+            _Myupstream._Upstream::deallocate_bulk(_Ptrs, _Count, _Size, _Align);
+        }
+
+        // resizes the block in the upstream allocator, records the change in size on success
+        bool try_expand_in_place(
+            pointer _Ptr, size_type _Old_size, size_type _New_size, size_type _Align = 0) noexcept override {
+            const bool _Result = _Myupstream._Upstream::try_expand_in_place(_Ptr, _Old_size, _New_size, _Align);
+            if (_Result) {
+                _Record_reallocation(_Old_size, _New_size);
+            }
+
+            return _Result;
+        }
+
+        // resizes the block in the upstream allocator and records the change in size
+        pointer reallocate(pointer _Ptr, size_type _Old_size, size_type _New_size, size_type _Align = 0) override {
+            pointer _New_ptr = _Myupstream._Upstream::reallocate(_Ptr, _Old_size, _New_size, _Align);
+            if (!_Ptr) { // nothing was resized, a new block was allocated
+                if (_New_ptr) {
+                    _Record_allocations(_New_size, 1);
+                }
+            } else if (_New_size == 0) { // nothing was resized, the block was deallocated
+                _Record_deallocations(_Old_size, 1);
+            } else {
+                _Record_reallocation(_Old_size, _New_size);
+            }
+
+            return _New_ptr;
+        }
+
+        // allocates from the upstream allocator and records the usable size
+        allocation_result allocate_at_least(size_type _Size, size_type _Align = 0) override {
+            const allocation_result _Result = _Myupstream._Upstream::allocate_at_least(_Size, _Align);
+            if (_Result.ptr) {
+                _Record_allocations(_Result.count, 1);
+            }
+
+            return _Result;
+        }
+
+        // returns the usable size reported by the upstream allocator
+        size_type good_size(size_type _Size, size_type _Align = 0) const noexcept override {
+            return _Myupstream._Upstream::good_size(_Size, _Align);
+        }
+
+        // returns the tag that identifies the allocator type
+        allocator_tag tag() const noexcept override {
+            return allocator_tag::stats;
+        }
+
+        // returns the largest supported allocation size
+        size_type max_size() const noexcept override {
+            return _Myupstream._Upstream::max_size();
+        }
+
+        // compares for equality with another allocator
+        bool is_equal(const allocator& _Other) const noexcept override {
+            // stateful allocator, equal only to itself
+            return this == ::std::addressof(_Other);
+        }
+
+        // sums the counters of all slots, may run concurrently with allocations
+        allocation_stats snapshot() const noexcept {
+            allocation_stats _Stats{};
+            int64_t _Live = _Mylive.load(::std::memory_order_relaxed);
+            for (const mjxsdk_impl::_Stats_slot& _Slot : _Myslots) {
+                _Stats.allocations += _Slot._Allocations.load(::std::memory_order_relaxed);
+                _Stats.deallocations += _Slot._Deallocations.load(::std::memory_order_relaxed);
+                _Stats.reallocations += _Slot._Reallocations.load(::std::memory_order_relaxed);
+                _Stats.allocated_bytes += _Slot._Allocated_bytes.load(::std::memory_order_relaxed);
+                _Stats.deallocated_bytes += _Slot._Deallocated_bytes.load(::std::memory_order_relaxed);
+                _Live += _Slot._Live_delta.load(::std::memory_order_relaxed);
+                for (size_t _Idx = 0; _Idx < allocation_histogram_size; ++_Idx) {
+                    _Stats.histogram[_Idx] += _Slot._Histogram[_Idx].load(::std::memory_order_relaxed);
+                }
+            }
+
+            // the slots are read one by one, so a block freed by another thread may be seen as negative
+            _Stats.live_bytes = _Live > 0 ? static_cast<uint64_t>(_Live) : 0;
+            const int64_t _Peak = _Mypeak.load(::std::memory_order_relaxed);
+            _Stats.peak_bytes   = _Peak > _Live ? static_cast<uint64_t>(_Peak) : _Stats.live_bytes;
+            return _Stats;
+        }
+
+        // returns the upstream allocator
+        _Upstream& upstream() noexcept {
+            return _Myupstream;
+        }
+
+        const _Upstream& upstream() const noexcept {
+            return _Myupstream;
+        }
+
+    private:
+        mjxsdk_impl::_Stats_slot& _Get_slot() noexcept {
+            return _Myslots[mjxsdk_impl::_Get_stats_slot_index()];
+        }
+
+        void _Add_live_bytes(mjxsdk_impl::_Stats_slot& _Slot, const int64_t _Bytes) noexcept {
+            // publishes the slot's live bytes once they grow large enough to matter for the peak
+            const int64_t _Delta = _Slot._Live_delta.fetch_add(_Bytes, ::std::memory_order_relaxed) + _Bytes;
+            if (_Delta < mjxsdk_impl::_Stats_publish_threshold && _Delta > -mjxsdk_impl::_Stats_publish_threshold) {
+                return;
+            }
+
+            _Slot._Live_delta.fetch_sub(_Delta, ::std::memory_order_relaxed);
+            const int64_t _Live = _Mylive.fetch_add(_Delta, ::std::memory_order_relaxed) + _Delta;
+            int64_t _Peak       = _Mypeak.load(::std::memory_order_relaxed);
+            while (_Live > _Peak && !_Mypeak.compare_exchange_weak(_Peak, _Live, ::std::memory_order_relaxed)) {}
+        }
+
+        void _Record_allocations(const size_type _Size, const size_type _Count) noexcept {
+            mjxsdk_impl::_Stats_slot& _Slot = _Get_slot();
+            _Slot._Allocations.fetch_add(_Count, ::std::memory_order_relaxed);
+            _Slot._Allocated_bytes.fetch_add(_Size * _Count, ::std::memory_order_relaxed);
+            _Slot._Histogram[mjxsdk_impl::_Get_histogram_bucket(_Size)].fetch_add(
+                _Count, ::std::memory_order_relaxed);
+            _Add_live_bytes(_Slot, static_cast<int64_t>(_Size * _Count));
+        }
+
+        void _Record_deallocations(const size_type _Size, const size_type _Count) noexcept {
+            mjxsdk_impl::_Stats_slot& _Slot = _Get_slot();
+            _Slot._Deallocations.fetch_add(_Count, ::std::memory_order_relaxed);
+            _Slot._Deallocated_bytes.fetch_add(_Size * _Count, ::std::memory_order_relaxed);
+            _Add_live_bytes(_Slot, -static_cast<int64_t>(_Size * _Count));
+        }
+
+        void _Record_reallocation(const size_type _Old_size, const size_type _New_size) noexcept {
+            mjxsdk_impl::_Stats_slot& _Slot = _Get_slot();
+            _Slot._Reallocations.fetch_add(1, ::std::memory_order_relaxed);
+            _Slot._Allocated_bytes.fetch_add(_New_size, ::std::memory_order_relaxed);
+            _Slot._Deallocated_bytes.fetch_add(_Old_size, ::std::memory_order_relaxed);
+            _Add_live_bytes(_Slot, static_cast<int64_t>(_New_size) - static_cast<int64_t>(_Old_size));
+        }
+
+        _Upstream _Myupstream;
+        ::std::array<mjxsdk_impl::_Stats_slot, mjxsdk_impl::_Stats_slot_count> _Myslots;
+        alignas(mjxsdk_impl::_Cache_line_size) ::std::atomic<int64_t> _Mylive; // published live bytes
+        ::std::atomic<int64_t> _Mypeak; // the highest number of published live bytes
+    };
+} // namespace mjx
+
+#endif // _MJXSDK_MEMORY_STATS_ALLOCATOR_HPP_
\ No newline at end of file
@@ -5,15 +5,54 @@
 
 #include <mjxsdk/core/impl/assert.hpp>
 #include <mjxsdk/core/impl/utils.hpp>
+#include <mjxsdk/core/macros.hpp>
 #include <mjxsdk/memory/exception.hpp>
+#include <mjxsdk/memory/impl/allocation_hooks.hpp>
+#include <mjxsdk/memory/impl/debug_block.hpp>
 #include <mjxsdk/memory/system_allocator.hpp>
 #include <new>
 #include <utility>
-#ifdef _DEBUG
-#include <mjxsdk/memory/impl/debug_block.hpp>
-#endif // _DEBUG
+
+// Note: On Linux, blocks come from the C heap, so that their usable size can be queried, and large blocks
+//       are mapped directly, so that they can be remapped. Debug blocks are surrounded by guards,
+//       so they always come from the global operator new. Release builds use debug blocks only
+//       in the checked mode selected at runtime, see debug_allocation.hpp.
+#if defined(_MJX_LINUX) && !defined(_DEBUG)
+#define _MJXSDK_NATIVE_SYSTEM_HEAP 1
+#include <cstddef>
+#include <cstdlib>
+#include <malloc.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#else // ^^^ _MJX_LINUX && NDEBUG ^^^ / vvv _MJX_WINDOWS || _DEBUG vvv
+#define _MJXSDK_NATIVE_SYSTEM_HEAP 0
+#endif // defined(_MJX_LINUX) && !defined(_DEBUG)
 
 namespace mjx {
+#if _MJXSDK_NATIVE_SYSTEM_HEAP
+    namespace mjxsdk_impl {
+        inline size_t _Get_page_size() noexcept {
+            static const size_t _Page_size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+            return _Page_size;
+        }
+
+        inline bool _Is_mapped_block(const size_t _Size, const size_t _Align) noexcept {
+            // the decision depends only on the size and alignment, which are passed again on deallocation
+            return _Size >= system_allocator::mapping_threshold && _Align <= _Get_page_size();
+        }
+
+        inline size_t _Get_mapping_size(const size_t _Size) noexcept {
+            return _Align_value(_Size, _Get_page_size());
+        }
+
+        inline size_t _Get_heap_usable_size(void* const _Ptr) noexcept {
+            // a heap block must never report a size that would be treated as a mapped block
+            const size_t _Usable = ::malloc_usable_size(_Ptr);
+            return _Usable < system_allocator::mapping_threshold ? _Usable : system_allocator::mapping_threshold - 1;
+        }
+    } // namespace mjxsdk_impl
+#endif // _MJXSDK_NATIVE_SYSTEM_HEAP
+
     system_allocator::system_allocator() noexcept {}
 
     system_allocator::system_allocator(const system_allocator&) noexcept {}
@@ -30,13 +69,15 @@ namespace mjx {
         return *this;
     }
 
-#ifdef _DEBUG
     system_allocator::pointer
         system_allocator::_Allocate_debug(const size_type _Size, const size_type _Align) {
         _INTERNAL_ASSERT(mjxsdk_impl::_Is_zero_or_pow_of_2(_Align), "alignment must be a power of 2");
         void* const _Ptr = mjxsdk_impl::_Allocate_debug_block(_Size, _Align, allocator_tag::system,
             [](const size_type _Size, const size_type _Align) noexcept {
                 return ::operator new(_Size, ::std::align_val_t{_Align}, ::std::nothrow);
+            },
+            [](pointer _Ptr, const size_type _Size, const size_type _Align) noexcept {
+                ::operator delete(_Ptr, _Size, ::std::align_val_t{_Align});
             }
         );
         if (!_Ptr) { // allocation failed, raise an exception
@@ -51,26 +92,43 @@ namespace mjx {
         _INTERNAL_ASSERT(mjxsdk_impl::_Is_zero_or_pow_of_2(_Align), "alignment must be a power of 2");
         mjxsdk_impl::_Deallocate_debug_block(_Ptr, _Size, _Align, allocator_tag::system,
             [](pointer _Ptr, const size_type _Size, const size_type _Align) noexcept {
-                ::operator delete(_Ptr, _Size, ::std::align_val_t{_Align});
+                mjxsdk_impl::_Quarantine_debug_block(_Ptr, _Size, _Align);
             }
         );
     }
-#endif // _DEBUG
-
-    system_allocator::pointer system_allocator::allocate(size_type _Size, size_type _Align) {
-        if (_Size == 0) { // no allocation, do nothing
-            return nullptr;
-        }
 
+    system_allocator::pointer
+        system_allocator::_Allocate_block(const size_type _Size, const size_type _Align) {
 #ifdef _DEBUG
         return _Allocate_debug(_Size, _Align);
 #else // ^^^ _DEBUG ^^^ / vvv NDEBUG vvv
+#if _MJXSDK_NATIVE_SYSTEM_HEAP
+        void* _Ptr = nullptr;
+        if (mjxsdk_impl::_Is_mapped_block(_Size, _Align)) { // large block, map it directly
+            _Ptr = ::mmap(nullptr, mjxsdk_impl::_Get_mapping_size(_Size),
+                PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (_Ptr == MAP_FAILED) { // mapping failed, raise an exception
+                allocation_failure::raise();
+            }
+
+            return _Ptr;
+        }
+
+        if (_Align > alignof(::max_align_t)) { // use the given alignment
+            if (::posix_memalign(&_Ptr, _Align, _Size) != 0) {
+                _Ptr = nullptr;
+            }
+        } else { // use the default alignment
+            _Ptr = ::malloc(_Size);
+        }
+#else // ^^^ _MJXSDK_NATIVE_SYSTEM_HEAP ^^^ / vvv !_MJXSDK_NATIVE_SYSTEM_HEAP vvv
         void* _Ptr = nullptr;
         if (_Align != 0) { // use the given alignment
             _Ptr = ::operator new(_Size, ::std::align_val_t{_Align}, ::std::nothrow);
         } else { // use the default alignment
             _Ptr = ::operator new(_Size, ::std::nothrow);
         }
+#endif // _MJXSDK_NATIVE_SYSTEM_HEAP
 
         if (!_Ptr) { // allocation failed, raise an exception
             allocation_failure::raise();
@@ -80,22 +138,175 @@ namespace mjx {
 #endif // _DEBUG
     }
 
-    void system_allocator::deallocate(pointer _Ptr, size_type _Size, size_type _Align) noexcept {
-        if (!_Ptr || _Size == 0) { // invalid block, break
-            return;
-        }
-
+    void system_allocator::_Deallocate_block(
+        pointer _Ptr, const size_type _Size, const size_type _Align) noexcept {
 #ifdef _DEBUG
         _Deallocate_debug(_Ptr, _Size, _Align);
 #else // ^^^ _DEBUG ^^^ / vvv NDEBUG vvv
+#if _MJXSDK_NATIVE_SYSTEM_HEAP
+        if (mjxsdk_impl::_Is_mapped_block(_Size, _Align)) { // large block, unmap it
+            ::munmap(_Ptr, mjxsdk_impl::_Get_mapping_size(_Size));
+        } else {
+            ::free(_Ptr);
+        }
+#else // ^^^ _MJXSDK_NATIVE_SYSTEM_HEAP ^^^ / vvv !_MJXSDK_NATIVE_SYSTEM_HEAP vvv
         if (_Align != 0) { // use the given alignment
             ::operator delete(_Ptr, _Size, ::std::align_val_t{_Align});
         } else { // use the default alignment
             ::operator delete(_Ptr, _Size);
         }
+#endif // _MJXSDK_NATIVE_SYSTEM_HEAP
 #endif // _DEBUG
     }
 
+    system_allocator::pointer system_allocator::allocate(size_type _Size, size_type _Align) {
+        if (_Size == 0) { // no allocation, do nothing
+            return nullptr;
+        }
+
+        if (!mjxsdk_impl::_Has_allocation_hooks()) { // no diagnostic tool is enabled
+            return _Allocate_block(_Size, _Align);
+        }
+
+        void* _Ptr = nullptr;
+        if (mjxsdk_impl::_Is_allocation_hook_enabled(mjxsdk_impl::_Guarded_sampling_hook)) { // may be sampled
+            _Ptr = mjxsdk_impl::_Try_allocate_guarded(_Size, _Align);
+        }
+
+        if (!_Ptr && mjxsdk_impl::_Is_allocation_hook_enabled(mjxsdk_impl::_Debug_allocation_hook)) {
+            // checked mode, remember the block, so that it is recognized after the mode is disabled
+            _Ptr = _Allocate_debug(_Size, _Align);
+            if (!mjxsdk_impl::_Register_debug_block(_Ptr)) { // cannot remember the block, raise an exception
+                _Deallocate_debug(_Ptr, _Size, _Align);
+                allocation_failure::raise();
+            }
+        }
+
+        if (!_Ptr) { // neither sampled nor checked, allocate a regular block
+            _Ptr = _Allocate_block(_Size, _Align);
+        }
+
+        mjxsdk_impl::_Invoke_allocation_hooks(_Ptr, _Size, _Align, allocator_tag::system, _MJX_RETURN_ADDRESS());
+        return _Ptr;
+    }
+
+    void system_allocator::deallocate(pointer _Ptr, size_type _Size, size_type _Align) noexcept {
+        if (!_Ptr || _Size == 0) { // invalid block, break
+            return;
+        }
+
+        if (mjxsdk_impl::_Has_allocation_hooks()) { // a diagnostic tool is enabled, let it observe the block
+            mjxsdk_impl::_Invoke_deallocation_hooks(_Ptr, _Size, _Align, allocator_tag::system);
+            if (mjxsdk_impl::_Is_allocation_hook_enabled(mjxsdk_impl::_Debug_block_hook)
+                && mjxsdk_impl::_Unregister_debug_block(_Ptr)) { // the block was allocated in checked mode
+                _Deallocate_debug(_Ptr, _Size, _Align);
+                return;
+            }
+        }
+
+        // guarded blocks outlive stop_guarded_sampling(), so the pool is checked even without any hook
+        if (mjxsdk_impl::_Is_guarded_address(_Ptr) && mjxsdk_impl::_Try_deallocate_guarded(_Ptr)) {
+            return;
+        }
+
+        _Deallocate_block(_Ptr, _Size, _Align);
+    }
+
+    bool system_allocator::try_expand_in_place(
+        pointer _Ptr, size_type _Old_size, size_type _New_size, size_type _Align) noexcept {
+#if _MJXSDK_NATIVE_SYSTEM_HEAP
+        if (!_Ptr || _Old_size == 0 || _New_size == 0) { // invalid block, break
+            return false;
+        }
+
+        if (mjxsdk_impl::_Has_allocation_hooks()
+            || mjxsdk_impl::_Is_guarded_address(_Ptr)) { // let the caller reallocate, so that the hooks see the block
+            return false;
+        }
+
+        const bool _Old_mapped = mjxsdk_impl::_Is_mapped_block(_Old_size, _Align);
+        if (_Old_mapped != mjxsdk_impl::_Is_mapped_block(_New_size, _Align)) { // the block would change its owner
+            return false;
+        }
+
+        if (_Old_mapped) { // mapped block, try to remap it in place
+            const size_type _Old_pages = mjxsdk_impl::_Get_mapping_size(_Old_size);
+            const size_type _New_pages = mjxsdk_impl::_Get_mapping_size(_New_size);
+            return _Old_pages == _New_pages || ::mremap(_Ptr, _Old_pages, _New_pages, 0) != MAP_FAILED;
+        }
+
+        return _New_size <= mjxsdk_impl::_Get_heap_usable_size(_Ptr); // the heap block may have spare bytes
+#else // ^^^ _MJXSDK_NATIVE_SYSTEM_HEAP ^^^ / vvv !_MJXSDK_NATIVE_SYSTEM_HEAP vvv
+        return allocator::try_expand_in_place(_Ptr, _Old_size, _New_size, _Align);
+#endif // _MJXSDK_NATIVE_SYSTEM_HEAP
+    }
+
+    system_allocator::pointer system_allocator::reallocate(
+        pointer _Ptr, size_type _Old_size, size_type _New_size, size_type _Align) {
+#if _MJXSDK_NATIVE_SYSTEM_HEAP
+        if (mjxsdk_impl::_Has_allocation_hooks()
+            || mjxsdk_impl::_Is_guarded_address(_Ptr)) { // move the block through allocate() and deallocate()
+            return allocator::reallocate(_Ptr, _Old_size, _New_size, _Align);
+        }
+
+        if (_Ptr && mjxsdk_impl::_Is_mapped_block(_Old_size, _Align)
+            && mjxsdk_impl::_Is_mapped_block(_New_size, _Align)) { // mapped block, let the kernel move the pages
+            void* const _New_ptr = ::mremap(_Ptr, mjxsdk_impl::_Get_mapping_size(_Old_size),
+                mjxsdk_impl::_Get_mapping_size(_New_size), MREMAP_MAYMOVE);
+            if (_New_ptr == MAP_FAILED) { // remapping failed, the old block stays valid
+                allocation_failure::raise();
+            }
+
+            return _New_ptr;
+        }
+
+        if (_Ptr && _New_size > 0 && !mjxsdk_impl::_Is_mapped_block(_Old_size, _Align)
+            && !mjxsdk_impl::_Is_mapped_block(_New_size, _Align) && _Align <= alignof(::max_align_t)) {
+            void* const _New_ptr = ::realloc(_Ptr, _New_size); // heap block, let the heap grow it in place
+            if (!_New_ptr) { // reallocation failed, the old block stays valid
+                allocation_failure::raise();
+            }
+
+            return _New_ptr;
+        }
+#endif // _MJXSDK_NATIVE_SYSTEM_HEAP
+
+        return allocator::reallocate(_Ptr, _Old_size, _New_size, _Align);
+    }
+
+    allocation_result system_allocator::allocate_at_least(size_type _Size, size_type _Align) {
+#if _MJXSDK_NATIVE_SYSTEM_HEAP
+        if (_Size == 0) { // no allocation, do nothing
+            return {nullptr, 0};
+        }
+
+        if (mjxsdk_impl::_Has_allocation_hooks()) { // the block may not come from the heap
+            return allocator::allocate_at_least(_Size, _Align);
+        }
+
+        if (mjxsdk_impl::_Is_mapped_block(_Size, _Align)) { // mapped block, the rest of the last page is usable
+            const size_type _Usable = mjxsdk_impl::_Get_mapping_size(_Size);
+            return {allocate(_Usable, _Align), _Usable};
+        }
+
+        void* const _Ptr = allocate(_Size, _Align);
+        return {_Ptr, mjxsdk_impl::_Get_heap_usable_size(_Ptr)};
+#else // ^^^ _MJXSDK_NATIVE_SYSTEM_HEAP ^^^ / vvv !_MJXSDK_NATIVE_SYSTEM_HEAP vvv
+        return allocator::allocate_at_least(_Size, _Align);
+#endif // _MJXSDK_NATIVE_SYSTEM_HEAP
+    }
+
+    system_allocator::size_type system_allocator::good_size(size_type _Size, size_type _Align) const noexcept {
+#if _MJXSDK_NATIVE_SYSTEM_HEAP
+        if (mjxsdk_impl::_Is_mapped_block(_Size, _Align)) { // mapped block, rounded to whole pages
+            return mjxsdk_impl::_Get_mapping_size(_Size);
+        }
+#else // ^^^ _MJXSDK_NATIVE_SYSTEM_HEAP ^^^ / vvv !_MJXSDK_NATIVE_SYSTEM_HEAP vvv
+        static_cast<void>(_Align);
+#endif // _MJXSDK_NATIVE_SYSTEM_HEAP
+        return _Size; // the heap's rounding is known only after the allocation
+    }
+
     allocator_tag system_allocator::tag() const noexcept {
         return allocator_tag::system;
     }
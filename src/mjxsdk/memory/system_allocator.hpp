@@ -9,8 +9,17 @@
 #include <mjxsdk/core/export.hpp>
 #include <mjxsdk/memory/allocator.hpp>
 
+// Note: Blocks below the mapping threshold come from the C heap, which reuses freed memory and remaps
+//       the large blocks it has mapped itself when they are reallocated. The default equals the largest
+//       threshold up to which 64-bit glibc may still serve blocks from the heap, so that direct mapping never
+//       replaces reusable heap memory. Both the library and its users must see the same value,
+//       it is set by the MJXSDK_MAPPING_THRESHOLD CMake variable.
+#ifndef _MJXSDK_MAPPING_THRESHOLD
+#define _MJXSDK_MAPPING_THRESHOLD (32 * 1024 * 1024)
+#endif // _MJXSDK_MAPPING_THRESHOLD
+
 namespace mjx {
-    class _MJXSDK_EXPORT system_allocator : public allocator { // stateless memory allocator
+    class _MJXSDK_EXPORT system_allocator final : public allocator { // stateless memory allocator
     public:
         using value_type      = allocator::value_type;
         using size_type       = allocator::size_type;
@@ -26,12 +35,28 @@ namespace mjx {
         system_allocator& operator=(const system_allocator& _Other) noexcept;
         system_allocator& operator=(system_allocator&& _Other) noexcept;
 
+        // the smallest block that is mapped directly from the operating system (if supported)
+        static constexpr size_type mapping_threshold = _MJXSDK_MAPPING_THRESHOLD;
+
         // allocates uninitialized storage with optional alignment
         pointer allocate(size_type _Size, size_type _Align = 0) override;
 
         // deallocates storage with optional alignment
         void deallocate(pointer _Ptr, size_type _Size, size_type _Align = 0) noexcept override;
 
+        // resizes the block without moving it, using the spare bytes of heap blocks or remapping mapped blocks
+        bool try_expand_in_place(
+            pointer _Ptr, size_type _Old_size, size_type _New_size, size_type _Align = 0) noexcept override;
+
+        // resizes the block, mapped blocks are remapped instead of copied
+        pointer reallocate(pointer _Ptr, size_type _Old_size, size_type _New_size, size_type _Align = 0) override;
+
+        // allocates at least _Size bytes and reports the usable size of the block
+        allocation_result allocate_at_least(size_type _Size, size_type _Align = 0) override;
+
+        // returns the usable size of a block mapped for _Size bytes, other requests are returned unchanged
+        size_type good_size(size_type _Size, size_type _Align = 0) const noexcept override;
+
         // returns the tag that identifies the allocator type
         allocator_tag tag() const noexcept override;
 
@@ -42,14 +67,18 @@ namespace mjx {
         bool is_equal(const allocator& _Other) const noexcept override;
 
     private:
-#ifdef _DEBUG
+        // allocates a block from the heap or the operating system, without notifying the allocation hooks
+        static pointer _Allocate_block(const size_type _Size, const size_type _Align);
+
+        // deallocates a block obtained from _Allocate_block()
+        static void _Deallocate_block(pointer _Ptr, const size_type _Size, const size_type _Align) noexcept;
+
         // allocates unintialized storage with optional alignment for debug mode
         static pointer _Allocate_debug(const size_type _Size, const size_type _Align);
 
         // deallocates storage with optional alignment for debug mode
         static void _Deallocate_debug(
             pointer _Ptr, const size_type _Size, const size_type _Align) noexcept;
-#endif // _DEBUG
     };
 } // namespace mjx
 
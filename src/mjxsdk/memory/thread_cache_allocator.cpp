@@ -0,0 +1,184 @@
+// thread_cache_allocator.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <mjxsdk/core/macros.hpp>
+#include <mjxsdk/memory/impl/allocation_hooks.hpp>
+#include <mjxsdk/memory/impl/global_allocator.hpp>
+#include <mjxsdk/memory/impl/size_class.hpp>
+#include <mjxsdk/memory/impl/thread_cache.hpp>
+#include <mjxsdk/memory/object.hpp>
+#include <mjxsdk/memory/thread_cache_allocator.hpp>
+#include <utility>
+
+namespace mjx {
+    static_assert(thread_cache_allocator::max_small_size == mjxsdk_impl::_Size_class_limit,
+        "the size class table must cover all small sizes");
+
+    thread_cache_allocator::thread_cache_allocator()
+        : _Mybackend(::mjx::create_object_using_allocator<mjxsdk_impl::_Thread_cache_backend>(
+            mjxsdk_impl::_Get_internal_allocator())) {}
+
+    thread_cache_allocator::~thread_cache_allocator() noexcept {
+        // Note: Caches of other threads still reference the backend, which is destroyed
+        //       once the last of these threads exits.
+        flush_thread_cache();
+        _Mybackend->_Release();
+    }
+
+    thread_cache_allocator::pointer thread_cache_allocator::allocate(size_type _Size, size_type _Align) {
+        if (_Size == 0) { // no allocation, do nothing
+            return nullptr;
+        }
+
+        void* _Ptr;
+        if (mjxsdk_impl::_Fits_size_class(_Size, _Align)) { // small block, use the calling thread's cache
+            const size_t _Idx                                    = mjxsdk_impl::_Size_class_index(_Size);
+            mjxsdk_impl::_Thread_cache_registry* const _Registry = mjxsdk_impl::_Get_thread_cache_registry();
+            if (_Registry) {
+                _Ptr = _Registry->_Find_or_create(_Mybackend)->_Allocate(_Idx);
+            } else { // the thread is being terminated, bypass the cache
+                _Ptr = _Mybackend->_Pool(_Idx)._Allocate();
+            }
+        } else { // large block, use the system allocator
+            mjxsdk_impl::_Internal_allocation_scope _Scope;
+            _Ptr = mjxsdk_impl::_Get_internal_allocator().allocate(_Size, _Align);
+        }
+
+        mjxsdk_impl::_Report_allocation(_Ptr, _Size, _Align, allocator_tag::thread_cache, _MJX_RETURN_ADDRESS());
+        return _Ptr;
+    }
+
+    void thread_cache_allocator::deallocate(pointer _Ptr, size_type _Size, size_type _Align) noexcept {
+        if (!_Ptr || _Size == 0) { // invalid block, break
+            return;
+        }
+
+        mjxsdk_impl::_Report_deallocation(_Ptr, _Size, _Align, allocator_tag::thread_cache);
+        if (!mjxsdk_impl::_Fits_size_class(_Size, _Align)) { // large block, use the system allocator
+            mjxsdk_impl::_Internal_allocation_scope _Scope;
+            mjxsdk_impl::_Get_internal_allocator().deallocate(_Ptr, _Size, _Align);
+            return;
+        }
+
+        const size_t _Idx                                    = mjxsdk_impl::_Size_class_index(_Size);
+        mjxsdk_impl::_Thread_cache_registry* const _Registry = mjxsdk_impl::_Get_thread_cache_registry();
+        mjxsdk_impl::_Thread_cache* const _Cache             = _Registry ? _Registry->_Find(_Mybackend) : nullptr;
+        if (_Cache) { // return the block to the calling thread's cache
+            _Cache->_Deallocate(_Idx, _Ptr);
+        } else { // the thread has no cache, return the block directly
+            _Mybackend->_Pool(_Idx)._Deallocate(_Ptr);
+        }
+    }
+
+    void thread_cache_allocator::allocate_bulk(
+        size_type _Size, size_type _Align, size_type _Count, pointer* _Ptrs) {
+        if (_Size == 0 || !mjxsdk_impl::_Fits_size_class(_Size, _Align)
+            || mjxsdk_impl::_Is_reporting_allocations()) { // allocate each block separately
+            allocator::allocate_bulk(_Size, _Align, _Count, _Ptrs);
+            return;
+        }
+
+        const size_t _Idx                                    = mjxsdk_impl::_Size_class_index(_Size);
+        mjxsdk_impl::_Thread_cache_registry* const _Registry = mjxsdk_impl::_Get_thread_cache_registry();
+        if (!_Registry) { // the thread is being terminated, bypass the cache
+            _Mybackend->_Pool(_Idx)._Allocate_batch(_Ptrs, _Count);
+            return;
+        }
+
+        _Registry->_Find_or_create(_Mybackend)->_Allocate_bulk(_Idx, _Ptrs, _Count);
+    }
+
+    void thread_cache_allocator::deallocate_bulk(
+        const pointer* _Ptrs, size_type _Count, size_type _Size, size_type _Align) noexcept {
+        if (_Size == 0 || !mjxsdk_impl::_Fits_size_class(_Size, _Align)
+            || mjxsdk_impl::_Is_reporting_allocations()) { // deallocate each block separately
+            allocator::deallocate_bulk(_Ptrs, _Count, _Size, _Align);
+            return;
+        }
+
+        const size_t _Idx                                    = mjxsdk_impl::_Size_class_index(_Size);
+        mjxsdk_impl::_Thread_cache_registry* const _Registry = mjxsdk_impl::_Get_thread_cache_registry();
+        mjxsdk_impl::_Thread_cache* const _Cache             = _Registry ? _Registry->_Find(_Mybackend) : nullptr;
+        if (_Cache) { // return the blocks to the calling thread's cache
+            _Cache->_Deallocate_bulk(_Idx, _Ptrs, _Count);
+        } else { // the thread has no cache, return the blocks directly
+            _Mybackend->_Pool(_Idx)._Deallocate_batch(_Ptrs, _Count);
+        }
+    }
+
+    bool thread_cache_allocator::try_expand_in_place(
+        pointer _Ptr, size_type _Old_size, size_type _New_size, size_type _Align) noexcept {
+        if (!_Ptr || _Old_size == 0 || _New_size == 0) { // invalid block, break
+            return false;
+        }
+
+        if (mjxsdk_impl::_Is_reporting_allocations()) { // let the caller reallocate, so that the hooks see the block
+            return false;
+        }
+
+        const bool _Old_small = mjxsdk_impl::_Fits_size_class(_Old_size, _Align);
+        if (_Old_small != mjxsdk_impl::_Fits_size_class(_New_size, _Align)) { // the block would change its owner
+            return false;
+        }
+
+        if (!_Old_small) { // large block, served by the system allocator
+            return mjxsdk_impl::_Get_internal_allocator().try_expand_in_place(_Ptr, _Old_size, _New_size, _Align);
+        }
+
+        return mjxsdk_impl::_Size_class_index(_Old_size) == mjxsdk_impl::_Size_class_index(_New_size);
+    }
+
+    thread_cache_allocator::pointer thread_cache_allocator::reallocate(
+        pointer _Ptr, size_type _Old_size, size_type _New_size, size_type _Align) {
+        if (_Ptr && !mjxsdk_impl::_Fits_size_class(_Old_size, _Align)
+            && !mjxsdk_impl::_Fits_size_class(_New_size, _Align)
+            && !mjxsdk_impl::_Is_reporting_allocations()) { // large block, let the system allocator move it
+            return mjxsdk_impl::_Get_internal_allocator().reallocate(_Ptr, _Old_size, _New_size, _Align);
+        }
+
+        return allocator::reallocate(_Ptr, _Old_size, _New_size, _Align);
+    }
+
+    allocation_result thread_cache_allocator::allocate_at_least(size_type _Size, size_type _Align) {
+        if (_Size != 0 && !mjxsdk_impl::_Fits_size_class(_Size, _Align)
+            && !mjxsdk_impl::_Is_reporting_allocations()) { // large block, use the system allocator
+            return mjxsdk_impl::_Get_internal_allocator().allocate_at_least(_Size, _Align);
+        }
+
+        return allocator::allocate_at_least(_Size, _Align);
+    }
+
+    thread_cache_allocator::size_type thread_cache_allocator::good_size(size_type _Size, size_type _Align) const noexcept {
+        if (_Size == 0) { // no allocation, no rounding
+            return 0;
+        }
+
+        if (!mjxsdk_impl::_Fits_size_class(_Size, _Align)) { // large block, use the system allocator
+            return mjxsdk_impl::_Get_internal_allocator().good_size(_Size, _Align);
+        }
+
+        return mjxsdk_impl::_Size_class_size(mjxsdk_impl::_Size_class_index(_Size));
+    }
+
+    allocator_tag thread_cache_allocator::tag() const noexcept {
+        return allocator_tag::thread_cache;
+    }
+
+    thread_cache_allocator::size_type thread_cache_allocator::max_size() const noexcept {
+        return mjxsdk_impl::_Get_internal_allocator().max_size();
+    }
+
+    bool thread_cache_allocator::is_equal(const allocator& _Other) const noexcept {
+        // stateful allocator, equal only to itself
+        return this == ::std::addressof(_Other);
+    }
+
+    void thread_cache_allocator::flush_thread_cache() noexcept {
+        mjxsdk_impl::_Thread_cache_registry* const _Registry = mjxsdk_impl::_Get_thread_cache_registry();
+        if (_Registry) {
+            _Registry->_Remove(_Mybackend);
+        }
+    }
+} // namespace mjx
\ No newline at end of file
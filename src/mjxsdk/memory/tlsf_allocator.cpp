@@ -0,0 +1,406 @@
+// tlsf_allocator.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <bit>
+#include <cstdint>
+#include <mjxsdk/core/impl/utils.hpp>
+#include <mjxsdk/core/macros.hpp>
+#include <mjxsdk/memory/exception.hpp>
+#include <mjxsdk/memory/impl/allocation_hooks.hpp>
+#include <mjxsdk/memory/impl/spin_lock.hpp>
+#include <mjxsdk/memory/impl/utils.hpp>
+#include <mjxsdk/memory/object.hpp>
+#include <mjxsdk/memory/tlsf_allocator.hpp>
+#include <mutex>
+#include <utility>
+
+namespace mjx {
+    namespace mjxsdk_impl {
+        // Note: The first level splits sizes by powers of two, the second level splits each power of two
+        //       into 32 linear ranges. Sizes below 512 bytes share the first level 0, where each second
+        //       level covers 16 bytes. Both levels are searched with bitmaps, so finding a suitable block
+        //       never depends on the number of free blocks.
+        inline constexpr size_t _Tlsf_align_log2      = 4;
+        inline constexpr size_t _Tlsf_align           = size_t{1} << _Tlsf_align_log2;
+        inline constexpr size_t _Tlsf_sl_count_log2   = 5;
+        inline constexpr size_t _Tlsf_sl_count        = size_t{1} << _Tlsf_sl_count_log2;
+        inline constexpr size_t _Tlsf_fl_shift        = _Tlsf_sl_count_log2 + _Tlsf_align_log2;
+        inline constexpr size_t _Tlsf_fl_max          = sizeof(size_t) == 8 ? 40 : 30;
+        inline constexpr size_t _Tlsf_fl_count        = _Tlsf_fl_max - _Tlsf_fl_shift + 1;
+        inline constexpr size_t _Tlsf_small_size      = size_t{1} << _Tlsf_fl_shift;
+        inline constexpr size_t _Tlsf_max_block_size  = (size_t{1} << _Tlsf_fl_max) - _Tlsf_align;
+        inline constexpr size_t _Tlsf_free_bit        = 0x1; // the block is free
+        inline constexpr size_t _Tlsf_prev_free_bit   = 0x2; // the previous physical block is free
+        inline constexpr size_t _Tlsf_flag_mask       = _Tlsf_free_bit | _Tlsf_prev_free_bit;
+
+        static_assert(_Tlsf_sl_count <= 32, "second level bitmaps must fit in 32 bits");
+        static_assert(_Tlsf_fl_count <= 32, "the first level bitmap must fit in 32 bits");
+
+        struct _Tlsf_block { // boundary tag that precedes each block
+            _Tlsf_block* _Prev_phys; // the previous physical block
+            size_t _Size; // the size of the payload, the lowest bits store the flags
+
+            // the links below are valid only in free blocks and overlap the payload
+            _Tlsf_block* _Next_free;
+            _Tlsf_block* _Prev_free;
+        };
+
+        // the size of the boundary tag, the payload starts right after it
+        inline constexpr size_t _Tlsf_header_size = _Align_value(2 * sizeof(void*), _Tlsf_align);
+
+        // the smallest payload, large enough to hold the free list links
+        inline constexpr size_t _Tlsf_min_payload = _Tlsf_align;
+
+        static_assert(sizeof(_Tlsf_block) <= _Tlsf_header_size + _Tlsf_min_payload,
+            "the free list links must fit in the smallest payload");
+
+        inline size_t _Get_block_size(const _Tlsf_block* const _Block) noexcept {
+            return _Block->_Size & ~_Tlsf_flag_mask;
+        }
+
+        inline bool _Is_block_free(const _Tlsf_block* const _Block) noexcept {
+            return (_Block->_Size & _Tlsf_free_bit) != 0;
+        }
+
+        inline bool _Is_prev_block_free(const _Tlsf_block* const _Block) noexcept {
+            return (_Block->_Size & _Tlsf_prev_free_bit) != 0;
+        }
+
+        inline void _Set_block_flag(_Tlsf_block* const _Block, const size_t _Flag, const bool _Value) noexcept {
+            _Block->_Size = _Value ? _Block->_Size | _Flag : _Block->_Size & ~_Flag;
+        }
+
+        inline void _Set_block_size(_Tlsf_block* const _Block, const size_t _Size) noexcept {
+            _Block->_Size = _Size | (_Block->_Size & _Tlsf_flag_mask);
+        }
+
+        inline void* _Get_block_payload(_Tlsf_block* const _Block) noexcept {
+            return _Adjust_address_by_offset(_Block, _Tlsf_header_size);
+        }
+
+        inline _Tlsf_block* _Get_payload_block(void* const _Payload) noexcept {
+            return static_cast<_Tlsf_block*>(
+                _Adjust_address_by_offset(_Payload, -static_cast<ptrdiff_t>(_Tlsf_header_size)));
+        }
+
+        inline _Tlsf_block* _Get_next_block(_Tlsf_block* const _Block) noexcept {
+            return static_cast<_Tlsf_block*>(
+                _Adjust_address_by_offset(_Block, _Tlsf_header_size + _Get_block_size(_Block)));
+        }
+
+        inline void _Map_block_size(const size_t _Size, size_t& _Fl, size_t& _Sl) noexcept {
+            // returns the indices of the list that holds blocks of the given size
+            if (_Size < _Tlsf_small_size) {
+                _Fl = 0;
+                _Sl = _Size / (_Tlsf_small_size / _Tlsf_sl_count);
+            } else {
+                const size_t _Log2 = static_cast<size_t>(::std::bit_width(_Size)) - 1;
+                _Fl                = _Log2 - (_Tlsf_fl_shift - 1);
+                _Sl                = (_Size >> (_Log2 - _Tlsf_sl_count_log2)) ^ _Tlsf_sl_count;
+            }
+        }
+
+        inline void _Map_requested_size(const size_t _Size, size_t& _Fl, size_t& _Sl) noexcept {
+            // returns the indices of the first list whose blocks are all large enough for the given size
+            if (_Size < _Tlsf_small_size) {
+                _Map_block_size(_Size, _Fl, _Sl);
+            } else {
+                const size_t _Log2 = static_cast<size_t>(::std::bit_width(_Size)) - 1;
+                _Map_block_size(_Size + (size_t{1} << (_Log2 - _Tlsf_sl_count_log2)) - 1, _Fl, _Sl);
+            }
+        }
+
+        struct _Tlsf_control { // the state of the allocator, placed in front of the managed blocks
+            _Spin_lock _Lock;
+            uint32_t _Fl_bitmap;
+            uint32_t _Sl_bitmaps[_Tlsf_fl_count];
+            _Tlsf_block* _Blocks[_Tlsf_fl_count][_Tlsf_sl_count];
+            _Tlsf_block* _First; // the first physical block
+            size_t _Max_size; // the size of the first block when the allocator is reset
+
+            _Tlsf_control() noexcept
+                : _Lock(), _Fl_bitmap(0), _Sl_bitmaps{}, _Blocks{}, _First(nullptr), _Max_size(0) {}
+
+            void _Insert_free_block(_Tlsf_block* const _Block) noexcept {
+                size_t _Fl;
+                size_t _Sl;
+                _Map_block_size(_Get_block_size(_Block), _Fl, _Sl);
+                _Tlsf_block* const _Head = _Blocks[_Fl][_Sl];
+                _Block->_Prev_free       = nullptr;
+                _Block->_Next_free       = _Head;
+                if (_Head) {
+                    _Head->_Prev_free = _Block;
+                }
+
+                _Blocks[_Fl][_Sl] = _Block;
+                _Fl_bitmap |= uint32_t{1} << _Fl;
+                _Sl_bitmaps[_Fl] |= uint32_t{1} << _Sl;
+            }
+
+            void _Remove_free_block(_Tlsf_block* const _Block) noexcept {
+                if (_Block->_Next_free) {
+                    _Block->_Next_free->_Prev_free = _Block->_Prev_free;
+                }
+
+                if (_Block->_Prev_free) {
+                    _Block->_Prev_free->_Next_free = _Block->_Next_free;
+                    return;
+                }
+
+                // the block is the head of its list, update the bitmaps if the list becomes empty
+                size_t _Fl;
+                size_t _Sl;
+                _Map_block_size(_Get_block_size(_Block), _Fl, _Sl);
+                _Blocks[_Fl][_Sl] = _Block->_Next_free;
+                if (!_Blocks[_Fl][_Sl]) {
+                    _Sl_bitmaps[_Fl] &= ~(uint32_t{1} << _Sl);
+                    if (_Sl_bitmaps[_Fl] == 0) {
+                        _Fl_bitmap &= ~(uint32_t{1} << _Fl);
+                    }
+                }
+            }
+
+            _Tlsf_block* _Find_free_block(const size_t _Size) const noexcept {
+                // returns a free block that can hold at least _Size bytes, or null if there is none
+                size_t _Fl;
+                size_t _Sl;
+                _Map_requested_size(_Size, _Fl, _Sl);
+                if (_Fl < _Tlsf_fl_count) {
+                    uint32_t _Sl_map = _Sl_bitmaps[_Fl] & (~uint32_t{0} << _Sl);
+                    if (_Sl_map == 0) { // no suitable block in this range, look at the larger ones
+                        const uint32_t _Fl_map = _Fl + 1 < 32 ? _Fl_bitmap & (~uint32_t{0} << (_Fl + 1)) : 0;
+                        if (_Fl_map != 0) {
+                            _Fl     = static_cast<size_t>(::std::countr_zero(_Fl_map));
+                            _Sl_map = _Sl_bitmaps[_Fl];
+                        }
+                    }
+
+                    if (_Sl_map != 0) {
+                        return _Blocks[_Fl][::std::countr_zero(_Sl_map)];
+                    }
+                }
+
+                // Note: Rounding the size up guarantees that any block of the found list is large enough,
+                //       but skips the list the size itself maps to. Its head is checked as a last resort,
+                //       so that a block that fits exactly (e.g., the whole region) can still be used.
+                _Map_block_size(_Size, _Fl, _Sl);
+                if (_Fl < _Tlsf_fl_count) {
+                    _Tlsf_block* const _Head = _Blocks[_Fl][_Sl];
+                    if (_Head && _Get_block_size(_Head) >= _Size) {
+                        return _Head;
+                    }
+                }
+
+                return nullptr;
+            }
+
+            void _Split_block(_Tlsf_block* const _Block, const size_t _Size) noexcept {
+                // returns the tail of the block to the free lists if it is large enough to form a block
+                const size_t _Block_size = _Get_block_size(_Block);
+                if (_Block_size < _Size + _Tlsf_header_size + _Tlsf_min_payload) {
+                    return;
+                }
+
+                _Tlsf_block* const _Rest = static_cast<_Tlsf_block*>(
+                    _Adjust_address_by_offset(_Get_block_payload(_Block), _Size));
+                _Rest->_Prev_phys = _Block;
+                _Rest->_Size      = (_Block_size - _Size - _Tlsf_header_size) | _Tlsf_free_bit;
+                _Set_block_size(_Block, _Size);
+
+                // the block after the rest was not free, otherwise it would have been merged with the block
+                _Tlsf_block* const _Next = _Get_next_block(_Rest);
+                _Next->_Prev_phys        = _Rest;
+                _Set_block_flag(_Next, _Tlsf_prev_free_bit, true);
+                _Insert_free_block(_Rest);
+            }
+
+            _Tlsf_block* _Split_leading_gap(_Tlsf_block* const _Block, const size_t _Gap) noexcept {
+                // returns the first _Gap bytes of the block to the free lists, the rest is a new block
+                _Tlsf_block* const _Aligned =
+                    static_cast<_Tlsf_block*>(_Adjust_address_by_offset(_Block, _Gap));
+                _Aligned->_Prev_phys = _Block;
+                _Aligned->_Size      = (_Get_block_size(_Block) - _Gap) | _Tlsf_prev_free_bit;
+                _Set_block_size(_Block, _Gap - _Tlsf_header_size);
+                _Set_block_flag(_Block, _Tlsf_free_bit, true);
+                _Get_next_block(_Aligned)->_Prev_phys = _Aligned;
+                _Insert_free_block(_Block);
+                return _Aligned;
+            }
+
+            void _Reset(void* const _First_address, const size_t _Region_size) noexcept {
+                // creates a single free block followed by a zero-sized sentinel that is never free
+                for (size_t _Fl = 0; _Fl < _Tlsf_fl_count; ++_Fl) {
+                    _Sl_bitmaps[_Fl] = 0;
+                    for (size_t _Sl = 0; _Sl < _Tlsf_sl_count; ++_Sl) {
+                        _Blocks[_Fl][_Sl] = nullptr;
+                    }
+                }
+
+                _Fl_bitmap = 0;
+                _Max_size  = _Region_size - 2 * _Tlsf_header_size;
+                if (_Max_size > _Tlsf_max_block_size) {
+                    _Max_size = _Tlsf_max_block_size;
+                }
+
+                _First             = static_cast<_Tlsf_block*>(_First_address);
+                _First->_Prev_phys = nullptr;
+                _First->_Size      = _Max_size | _Tlsf_free_bit;
+
+                _Tlsf_block* const _Sentinel = _Get_next_block(_First);
+                _Sentinel->_Prev_phys        = _First;
+                _Sentinel->_Size             = _Tlsf_prev_free_bit;
+                _Insert_free_block(_First);
+            }
+        };
+
+        inline size_t _Adjust_tlsf_request(const size_t _Size) noexcept {
+            // rounds the requested size to a valid payload size
+            return _Size > _Tlsf_min_payload ? _Align_value(_Size, _Tlsf_align) : _Tlsf_min_payload;
+        }
+    } // namespace mjxsdk_impl
+
+    tlsf_allocator::tlsf_allocator(memory_resource& _Resource) noexcept
+        : _Myres(::std::addressof(_Resource)), _Mycontrol(nullptr) {
+        release();
+    }
+
+    tlsf_allocator::~tlsf_allocator() noexcept {
+        if (_Mycontrol) {
+            ::mjx::destroy_object(_Mycontrol);
+        }
+    }
+
+    tlsf_allocator::pointer tlsf_allocator::allocate(size_type _Size, size_type _Align) {
+        if (_Size == 0) { // no allocation, do nothing
+            return nullptr;
+        }
+
+        if (!_Mycontrol || _Size > _Mycontrol->_Max_size || _Align > _Mycontrol->_Max_size) {
+            // no block can hold the requested size
+            allocation_limit_exceeded::raise();
+        }
+
+        // Note: Blocks are aligned to 16 bytes. A stricter alignment is met by searching for a block that
+        //       leaves room for the payload to be moved forward, the bytes in front of it form a new
+        //       free block, which must be able to hold at least the boundary tag and the free list links.
+        _Align                  = mjxsdk_impl::_Get_effective_alignment(_Align);
+        const size_type _Needed = mjxsdk_impl::_Adjust_tlsf_request(_Size);
+        constexpr size_type _Min_gap = mjxsdk_impl::_Tlsf_header_size + mjxsdk_impl::_Tlsf_min_payload;
+        const size_type _Search_size = _Align > mjxsdk_impl::_Tlsf_align ? _Needed + _Align + _Min_gap : _Needed;
+        if (_Search_size > _Mycontrol->_Max_size) { // the alignment padding exceeds every block
+            allocation_limit_exceeded::raise();
+        }
+
+        ::std::lock_guard _Guard(_Mycontrol->_Lock);
+        mjxsdk_impl::_Tlsf_block* _Block = _Mycontrol->_Find_free_block(_Search_size);
+        if (!_Block) { // no free block is large enough, raise an exception
+            allocation_limit_exceeded::raise();
+        }
+
+        _Mycontrol->_Remove_free_block(_Block);
+        if (_Align > mjxsdk_impl::_Tlsf_align) { // move the payload to an aligned address
+            void* const _Payload = mjxsdk_impl::_Get_block_payload(_Block);
+            size_type _Gap       = mjxsdk_impl::_Distance_between(
+                _Payload, mjxsdk_impl::_Align_address(_Payload, _Align));
+            if (_Gap != 0 && _Gap < _Min_gap) { // too small to form a block, use the next aligned address
+                _Gap = mjxsdk_impl::_Distance_between(_Payload, mjxsdk_impl::_Align_address(
+                    mjxsdk_impl::_Adjust_address_by_offset(_Payload, _Min_gap), _Align));
+            }
+
+            if (_Gap != 0) {
+                _Block = _Mycontrol->_Split_leading_gap(_Block, _Gap);
+            }
+        }
+
+        _Mycontrol->_Split_block(_Block, _Needed);
+        mjxsdk_impl::_Set_block_flag(_Block, mjxsdk_impl::_Tlsf_free_bit, false);
+        mjxsdk_impl::_Set_block_flag(mjxsdk_impl::_Get_next_block(_Block), mjxsdk_impl::_Tlsf_prev_free_bit, false);
+        void* const _Ptr = mjxsdk_impl::_Get_block_payload(_Block);
+        mjxsdk_impl::_Report_allocation(_Ptr, _Size, _Align, allocator_tag::tlsf, _MJX_RETURN_ADDRESS());
+        return _Ptr;
+    }
+
+    void tlsf_allocator::deallocate(pointer _Ptr, size_type _Size, size_type _Align) noexcept {
+        if (!_Ptr) { // invalid block, break
+            return;
+        }
+
+        mjxsdk_impl::_Report_deallocation(_Ptr, _Size, _Align, allocator_tag::tlsf);
+        ::std::lock_guard _Guard(_Mycontrol->_Lock);
+        mjxsdk_impl::_Tlsf_block* _Block = mjxsdk_impl::_Get_payload_block(_Ptr);
+        mjxsdk_impl::_Tlsf_block* _Next  = mjxsdk_impl::_Get_next_block(_Block);
+        if (mjxsdk_impl::_Is_prev_block_free(_Block)) { // merge with the previous block
+            mjxsdk_impl::_Tlsf_block* const _Prev = _Block->_Prev_phys;
+            _Mycontrol->_Remove_free_block(_Prev);
+            mjxsdk_impl::_Set_block_size(_Prev, mjxsdk_impl::_Get_block_size(_Prev)
+                + mjxsdk_impl::_Tlsf_header_size + mjxsdk_impl::_Get_block_size(_Block));
+            _Block = _Prev;
+        }
+
+        if (mjxsdk_impl::_Is_block_free(_Next)) { // merge with the next block
+            _Mycontrol->_Remove_free_block(_Next);
+            mjxsdk_impl::_Set_block_size(_Block, mjxsdk_impl::_Get_block_size(_Block)
+                + mjxsdk_impl::_Tlsf_header_size + mjxsdk_impl::_Get_block_size(_Next));
+            _Next = mjxsdk_impl::_Get_next_block(_Block);
+        }
+
+        mjxsdk_impl::_Set_block_flag(_Block, mjxsdk_impl::_Tlsf_free_bit, true);
+        _Next->_Prev_phys = _Block;
+        mjxsdk_impl::_Set_block_flag(_Next, mjxsdk_impl::_Tlsf_prev_free_bit, true);
+        _Mycontrol->_Insert_free_block(_Block);
+    }
+
+    tlsf_allocator::size_type tlsf_allocator::good_size(size_type _Size, size_type) const noexcept {
+        if (_Size == 0 || _Size > mjxsdk_impl::_Tlsf_max_block_size) { // no rounding applies
+            return _Size;
+        }
+
+        return mjxsdk_impl::_Adjust_tlsf_request(_Size);
+    }
+
+    allocator_tag tlsf_allocator::tag() const noexcept {
+        return allocator_tag::tlsf;
+    }
+
+    tlsf_allocator::size_type tlsf_allocator::max_size() const noexcept {
+        return _Mycontrol ? _Mycontrol->_Max_size : 0;
+    }
+
+    bool tlsf_allocator::is_equal(const allocator& _Other) const noexcept {
+        // stateful allocator, equal only to itself
+        return this == ::std::addressof(_Other);
+    }
+
+    bool tlsf_allocator::contains(const_pointer _Ptr, const size_type _Size) const noexcept {
+        return _Myres->contains(_Ptr, _Size);
+    }
+
+    void tlsf_allocator::release() noexcept {
+        if (_Mycontrol) { // the control structure is rebuilt from scratch
+            ::mjx::destroy_object(_Mycontrol);
+            _Mycontrol = nullptr;
+        }
+
+        // place the control structure at the beginning of the resource, followed by the blocks
+        if (_Myres->empty()) {
+            return;
+        }
+
+        void* const _Begin = _Myres->data();
+        void* const _End   = mjxsdk_impl::_Adjust_address_by_offset(_Begin, _Myres->size());
+        void* const _Control_address = mjxsdk_impl::_Align_address(_Begin, alignof(mjxsdk_impl::_Tlsf_control));
+        void* const _First_address   = mjxsdk_impl::_Align_address(mjxsdk_impl::_Adjust_address_by_offset(
+            _Control_address, sizeof(mjxsdk_impl::_Tlsf_control)), mjxsdk_impl::_Tlsf_align);
+        constexpr size_type _Min_region = 2 * mjxsdk_impl::_Tlsf_header_size + mjxsdk_impl::_Tlsf_min_payload;
+        if (_First_address >= _End || mjxsdk_impl::_Distance_between(_First_address, _End) < _Min_region) {
+            return; // the resource is too small to hold the control structure and a single block
+        }
+
+        const size_type _Region_size = mjxsdk_impl::_Distance_between(_First_address, _End)
+                                     & ~(mjxsdk_impl::_Tlsf_align - 1);
+        _Mycontrol = ::mjx::construct_object(static_cast<mjxsdk_impl::_Tlsf_control*>(_Control_address));
+        _Mycontrol->_Reset(_First_address, _Region_size);
+    }
+} // namespace mjx
\ No newline at end of file
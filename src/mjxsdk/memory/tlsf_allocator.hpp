@@ -0,0 +1,62 @@
+// tlsf_allocator.hpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+#ifndef _MJXSDK_MEMORY_TLSF_ALLOCATOR_HPP_
+#define _MJXSDK_MEMORY_TLSF_ALLOCATOR_HPP_
+#include <mjxsdk/core/export.hpp>
+#include <mjxsdk/memory/allocator.hpp>
+#include <mjxsdk/memory/memory_resource.hpp>
+
+namespace mjx {
+    namespace mjxsdk_impl {
+        struct _Tlsf_control;
+    } // namespace mjxsdk_impl
+
+    class _MJXSDK_EXPORT tlsf_allocator final : public allocator { // two-level segregated fit allocator
+    public:
+        using value_type      = allocator::value_type;
+        using size_type       = allocator::size_type;
+        using difference_type = allocator::difference_type;
+        using pointer         = allocator::pointer;
+        using const_pointer   = allocator::const_pointer;
+
+        explicit tlsf_allocator(memory_resource& _Resource) noexcept;
+        ~tlsf_allocator() noexcept override;
+
+        tlsf_allocator(const tlsf_allocator&)            = delete;
+        tlsf_allocator& operator=(const tlsf_allocator&) = delete;
+
+        // allocates uninitialized storage with optional alignment in bounded time
+        pointer allocate(size_type _Size, size_type _Align = 0) override;
+
+        // deallocates storage and merges it with free neighbours in bounded time
+        void deallocate(pointer _Ptr, size_type _Size, size_type _Align = 0) noexcept override;
+
+        // returns the payload size that serves the request
+        size_type good_size(size_type _Size, size_type _Align = 0) const noexcept override;
+
+        // returns the tag that identifies the allocator type
+        allocator_tag tag() const noexcept override;
+
+        // returns the largest supported allocation size
+        size_type max_size() const noexcept override;
+
+        // compares for equality with another allocator
+        bool is_equal(const allocator& _Other) const noexcept override;
+
+        // checks whether the memory block comes from the managed resource
+        bool contains(const_pointer _Ptr, const size_type _Size) const noexcept;
+
+        // frees all blocks at once, must not be called while other threads use the allocator
+        void release() noexcept;
+
+    private:
+        memory_resource* _Myres;
+        mjxsdk_impl::_Tlsf_control* _Mycontrol; // placed at the beginning of the resource
+    };
+} // namespace mjx
+
+#endif // _MJXSDK_MEMORY_TLSF_ALLOCATOR_HPP_
\ No newline at end of file
@@ -0,0 +1,139 @@
+// test.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <mjxsdk/memory/allocation_trace.hpp>
+#include <mjxsdk/memory/pool_allocator.hpp>
+#include <mjxsdk/memory/system_allocator.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace mjx {
+    struct _Trace_contents {
+        trace_file_header _Header;
+        ::std::vector<trace_event> _Events;
+    };
+
+    _Trace_contents _Read_trace(const ::std::string& _Path) {
+        // reads the whole trace file
+        _Trace_contents _Contents;
+        ::std::ifstream _File(_Path, ::std::ios::binary);
+        _File.read(reinterpret_cast<char*>(&_Contents._Header), sizeof(trace_file_header));
+        _Contents._Events.resize(static_cast<size_t>(_Contents._Header.event_count));
+        _File.read(reinterpret_cast<char*>(_Contents._Events.data()),
+            static_cast<::std::streamsize>(_Contents._Events.size() * sizeof(trace_event)));
+        EXPECT_TRUE(_File.good());
+        return _Contents;
+    }
+
+    ::std::string _Get_trace_path() {
+        return (::std::filesystem::temp_directory_path() / "mjxsdk_allocation_trace").string();
+    }
+
+    TEST(allocation_trace, record_events) {
+        const ::std::string _Path = _Get_trace_path();
+        system_allocator _Al;
+        ASSERT_TRUE(::mjx::start_allocation_trace(_Path.c_str(), 1024 * 1024));
+        EXPECT_TRUE(::mjx::is_allocation_trace_active());
+        EXPECT_FALSE(::mjx::start_allocation_trace(_Path.c_str())); // already recording
+        void* const _Ptr = _Al.allocate(48, 64);
+        _Al.deallocate(_Ptr, 48, 64);
+        ::std::thread _Thread([&_Al] {
+            for (size_t _Idx = 0; _Idx < 1000; ++_Idx) { // fill the thread's buffer a few times
+                _Al.deallocate(_Al.allocate(16), 16);
+            }
+        });
+        _Thread.join();
+        ::mjx::stop_allocation_trace();
+        EXPECT_FALSE(::mjx::is_allocation_trace_active());
+
+        const _Trace_contents _Contents = _Read_trace(_Path);
+        EXPECT_EQ(::memcmp(_Contents._Header.magic, "MJXTRACE", 8), 0);
+        EXPECT_EQ(_Contents._Header.version, trace_format_version);
+        EXPECT_EQ(_Contents._Header.event_size, sizeof(trace_event));
+        EXPECT_EQ(_Contents._Header.event_count, 2002);
+        EXPECT_EQ(_Contents._Header.dropped_count, 0);
+        EXPECT_EQ(::std::filesystem::file_size(_Path), sizeof(trace_file_header) + 2002 * sizeof(trace_event));
+
+        const uint64_t _Address = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(_Ptr));
+        size_t _Main_events     = 0;
+        for (const trace_event& _Event : _Contents._Events) {
+            if (_Event.size == 48) { // the events of the main thread
+                EXPECT_EQ(_Event.address, _Address);
+                EXPECT_EQ(_Event.align_log2, 6);
+                EXPECT_EQ(_Event.tag, allocator_tag::system);
+                EXPECT_EQ(_Event.kind, _Main_events == 0 ? trace_event_kind::allocation
+                                                         : trace_event_kind::deallocation);
+                ++_Main_events;
+            } else {
+                EXPECT_EQ(_Event.size, 16);
+                EXPECT_EQ(_Event.align_log2, 0);
+            }
+        }
+
+        EXPECT_EQ(_Main_events, 2);
+        ::std::filesystem::remove(_Path);
+    }
+
+    TEST(allocation_trace, owning_allocator_tag) {
+        // the events carry the tag of the allocator that hands out the block, its chunks are not recorded
+        const ::std::string _Path = _Get_trace_path();
+        system_allocator _Upstream;
+        pool_allocator _Pool(64, _Upstream);
+        ASSERT_TRUE(::mjx::start_allocation_trace(_Path.c_str(), 1024 * 1024));
+        void* const _Ptr = _Pool.allocate(32);
+        _Pool.deallocate(_Ptr, 32);
+        ::mjx::stop_allocation_trace();
+
+        const _Trace_contents _Contents = _Read_trace(_Path);
+        ASSERT_EQ(_Contents._Header.event_count, 2);
+        EXPECT_EQ(_Contents._Events[0].kind, trace_event_kind::allocation);
+        EXPECT_EQ(_Contents._Events[1].kind, trace_event_kind::deallocation);
+        for (const trace_event& _Event : _Contents._Events) {
+            EXPECT_EQ(_Event.address, static_cast<uint64_t>(reinterpret_cast<uintptr_t>(_Ptr)));
+            EXPECT_EQ(_Event.size, 32);
+            EXPECT_EQ(_Event.tag, allocator_tag::pool);
+        }
+
+        ::std::filesystem::remove(_Path);
+    }
+
+    TEST(allocation_trace, dropped_events) {
+        const ::std::string _Path = _Get_trace_path();
+        const size_t _File_size   = sizeof(trace_file_header) + 4 * sizeof(trace_event);
+        system_allocator _Al;
+        ASSERT_TRUE(::mjx::start_allocation_trace(_Path.c_str(), _File_size));
+        for (size_t _Idx = 0; _Idx < 100; ++_Idx) {
+            _Al.deallocate(_Al.allocate(32), 32);
+        }
+
+        ::mjx::stop_allocation_trace();
+        const _Trace_contents _Contents = _Read_trace(_Path);
+        EXPECT_EQ(_Contents._Header.event_count, 4);
+        EXPECT_EQ(_Contents._Header.dropped_count, 196);
+        uint64_t _Last_timestamp = 0;
+        for (const trace_event& _Event : _Contents._Events) { // a single thread records in order
+            EXPECT_GE(_Event.timestamp, _Last_timestamp);
+            _Last_timestamp = _Event.timestamp;
+        }
+
+        ::std::filesystem::remove(_Path);
+    }
+
+    TEST(allocation_trace, stopped_trace) {
+        const ::std::string _Path = _Get_trace_path();
+        system_allocator _Al;
+        ASSERT_TRUE(::mjx::start_allocation_trace(_Path.c_str(), 1024 * 1024));
+        ::mjx::stop_allocation_trace();
+        _Al.deallocate(_Al.allocate(32), 32);
+        EXPECT_EQ(_Read_trace(_Path)._Header.event_count, 0);
+        ::std::filesystem::remove(_Path);
+    }
+} // namespace mjx
\ No newline at end of file
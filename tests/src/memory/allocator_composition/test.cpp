@@ -0,0 +1,130 @@
+// test.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <mjxsdk/memory/allocator_composition.hpp>
+#include <mjxsdk/memory/object.hpp>
+#include <mjxsdk/memory/pool_allocator.hpp>
+#include <mjxsdk/memory/stack_allocator.hpp>
+#include <mjxsdk/memory/system_allocator.hpp>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace mjx {
+    using _Stack_with_fallback = fallback_allocator<stack_allocator, system_allocator>;
+    using _Pool_buckets        = bucketizer<pool_allocator, 0, 128, 32>;
+    using _Tiered_allocator    = segregator<128, _Pool_buckets, system_allocator>;
+
+    TEST(allocator_composition, compatible_allocators) {
+        EXPECT_TRUE(is_compatible_allocator_v<_Stack_with_fallback>);
+        EXPECT_TRUE(is_compatible_allocator_v<_Pool_buckets>);
+        EXPECT_TRUE(is_compatible_allocator_v<_Tiered_allocator>);
+        EXPECT_TRUE(owning_allocator<stack_allocator>);
+        EXPECT_FALSE(owning_allocator<system_allocator>);
+    }
+
+    TEST(allocator_composition, fallback_allocator) {
+        memory_resource _Res(256);
+        _Stack_with_fallback _Al(::std::piecewise_construct, ::std::forward_as_tuple(_Res), ::std::tuple<>{});
+        void* const _Ptr0 = _Al.allocate(128);
+        EXPECT_TRUE(_Al.primary().contains(_Ptr0, 128));
+
+        // the stack is exhausted, the block comes from the fallback allocator
+        void* const _Ptr1 = _Al.allocate(512);
+        EXPECT_FALSE(_Al.primary().contains(_Ptr1, 512));
+        EXPECT_EQ(_Al.tag(), allocator_tag::fallback);
+        EXPECT_EQ(_Al.max_size(), system_allocator{}.max_size());
+
+        // each block is returned to the allocator that owns it
+        _Al.deallocate(_Ptr1, 512);
+        _Al.deallocate(_Ptr0, 128);
+        EXPECT_EQ(_Al.primary().used(), 0);
+    }
+
+    TEST(allocator_composition, segregator) {
+        memory_resource _Small_res(1024);
+        memory_resource _Large_res(4096);
+        segregator<64, stack_allocator, stack_allocator> _Al(::std::piecewise_construct,
+            ::std::forward_as_tuple(_Small_res), ::std::forward_as_tuple(_Large_res));
+        EXPECT_EQ(_Al.tag(), allocator_tag::segregator);
+        EXPECT_EQ(_Al.max_size(), 4096);
+
+        // the requested size selects the allocator
+        void* const _Small_ptr = _Al.allocate(64);
+        void* const _Large_ptr = _Al.allocate(65);
+        EXPECT_TRUE(_Small_res.contains(_Small_ptr, 64));
+        EXPECT_TRUE(_Large_res.contains(_Large_ptr, 65));
+        EXPECT_TRUE(_Al.contains(_Small_ptr, 64));
+        EXPECT_TRUE(_Al.contains(_Large_ptr, 65));
+        _Al.deallocate(_Large_ptr, 65);
+        _Al.deallocate(_Small_ptr, 64);
+        EXPECT_EQ(_Al.small().used(), 0);
+        EXPECT_EQ(_Al.large().used(), 0);
+    }
+
+    TEST(allocator_composition, bucketizer) {
+        // each pool serves the largest size of its bucket
+        system_allocator _Upstream;
+        _Pool_buckets _Al(_Upstream);
+        EXPECT_EQ(_Al.tag(), allocator_tag::bucketizer);
+        EXPECT_EQ(_Al.max_size(), 128);
+        static_assert(_Pool_buckets::bucket_count == 4, "unexpected number of buckets");
+        for (size_t _Idx = 0; _Idx < _Pool_buckets::bucket_count; ++_Idx) {
+            EXPECT_EQ(_Al.bucket(_Idx).block_size(), 32 * (_Idx + 1));
+        }
+
+        ::std::vector<void*> _Blocks;
+        for (size_t _Size = 1; _Size <= 128; ++_Size) {
+            void* const _Ptr = _Al.allocate(_Size);
+            EXPECT_TRUE(_Al.contains(_Ptr, _Size));
+            _Blocks.push_back(_Ptr);
+        }
+
+        EXPECT_THROW(static_cast<void>(_Al.allocate(129)), allocation_limit_exceeded);
+        for (size_t _Size = 1; _Size <= 128; ++_Size) {
+            _Al.deallocate(_Blocks[_Size - 1], _Size);
+        }
+    }
+
+    TEST(allocator_composition, bucketizer_arguments) {
+        // temporary arguments are accepted, a bucketizer is never taken as one
+        static_assert(!::std::is_constructible_v<_Pool_buckets, _Pool_buckets&>, "bucketizer must not be copyable");
+        static_assert(!::std::is_constructible_v<_Pool_buckets, const _Pool_buckets&>,
+            "bucketizer must not be copyable");
+        system_allocator _Upstream;
+        _Pool_buckets _Al(_Upstream, 64);
+        for (size_t _Idx = 0; _Idx < _Pool_buckets::bucket_count; ++_Idx) {
+            EXPECT_EQ(_Al.bucket(_Idx).block_align(), 64);
+        }
+
+        void* const _Ptr = _Al.allocate(100);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(_Ptr) % 64, 0);
+        _Al.deallocate(_Ptr, 100);
+    }
+
+    TEST(allocator_composition, nested_composition) {
+        // small sizes come from the pools, large ones from the system allocator
+        system_allocator _Upstream;
+        _Tiered_allocator _Al(
+            ::std::piecewise_construct, ::std::forward_as_tuple(_Upstream), ::std::tuple<>{});
+        int* const _Small_obj = ::mjx::create_object_using_allocator<int>(_Al, 42);
+        EXPECT_EQ(*_Small_obj, 42);
+        EXPECT_TRUE(_Al.small().contains(_Small_obj, sizeof(int)));
+        double* const _Large_array = ::mjx::create_object_array_using_allocator<double>(100, _Al);
+        EXPECT_NE(_Large_array, nullptr);
+        ::mjx::delete_object_array_using_allocator(_Large_array, 100, _Al);
+        ::mjx::delete_object_using_allocator(_Small_obj, _Al);
+    }
+
+    TEST(allocator_composition, is_equal) {
+        system_allocator _Upstream;
+        _Pool_buckets _Al0(_Upstream);
+        _Pool_buckets _Al1(_Upstream);
+        EXPECT_EQ(_Al0, _Al0);
+        EXPECT_FALSE(_Al0 == _Al1);
+    }
+} // namespace mjx
\ No newline at end of file
@@ -5,7 +5,16 @@
 
 #include <gtest/gtest.h>
 #include <mjxsdk/memory/allocator.hpp>
+#include <mjxsdk/memory/buddy_allocator.hpp>
+#include <mjxsdk/memory/concurrent_pool_allocator.hpp>
+#include <mjxsdk/memory/monotonic_allocator.hpp>
+#include <mjxsdk/memory/pool_allocator.hpp>
+#include <mjxsdk/memory/small_object_allocator.hpp>
+#include <mjxsdk/memory/stack_allocator.hpp>
+#include <mjxsdk/memory/stats_allocator.hpp>
 #include <mjxsdk/memory/system_allocator.hpp>
+#include <mjxsdk/memory/thread_cache_allocator.hpp>
+#include <mjxsdk/memory/tlsf_allocator.hpp>
 
 namespace mjx {
     class comp_allocator : public allocator { // allocator that is compatible with the built-in allocators
@@ -89,7 +98,31 @@ namespace mjx {
     };
 
     TEST(allocators_compatibility, builtin_allocators) {
+        EXPECT_TRUE(is_compatible_allocator_v<buddy_allocator>);
+        EXPECT_TRUE(is_compatible_allocator_v<concurrent_pool_allocator>);
+        EXPECT_TRUE(is_compatible_allocator_v<monotonic_allocator>);
+        EXPECT_TRUE(is_compatible_allocator_v<pool_allocator>);
+        EXPECT_TRUE(is_compatible_allocator_v<small_object_allocator>);
+        EXPECT_TRUE(is_compatible_allocator_v<stack_allocator>);
+        EXPECT_TRUE(is_compatible_allocator_v<stats_allocator<system_allocator>>);
         EXPECT_TRUE(is_compatible_allocator_v<system_allocator>);
+        EXPECT_TRUE(is_compatible_allocator_v<thread_cache_allocator>);
+        EXPECT_TRUE(is_compatible_allocator_v<tlsf_allocator>);
+    }
+
+    TEST(allocators_compatibility, static_allocators) {
+        EXPECT_TRUE(is_static_allocator_v<buddy_allocator>);
+        EXPECT_TRUE(is_static_allocator_v<concurrent_pool_allocator>);
+        EXPECT_TRUE(is_static_allocator_v<monotonic_allocator>);
+        EXPECT_TRUE(is_static_allocator_v<pool_allocator>);
+        EXPECT_TRUE(is_static_allocator_v<small_object_allocator>);
+        EXPECT_TRUE(is_static_allocator_v<stack_allocator>);
+        EXPECT_TRUE(is_static_allocator_v<stats_allocator<system_allocator>>);
+        EXPECT_TRUE(is_static_allocator_v<system_allocator>);
+        EXPECT_TRUE(is_static_allocator_v<thread_cache_allocator>);
+        EXPECT_TRUE(is_static_allocator_v<tlsf_allocator>);
+        EXPECT_FALSE(is_static_allocator_v<allocator>); // the base class is dispatched virtually
+        EXPECT_FALSE(is_static_allocator_v<comp_allocator>); // not final, may be further derived
     }
 
     TEST(allocators_compatibility, custom_allocators) {
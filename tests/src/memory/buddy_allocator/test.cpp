@@ -0,0 +1,144 @@
+// test.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+#include <mjxsdk/memory/buddy_allocator.hpp>
+#include <mjxsdk/memory/exception.hpp>
+#include <vector>
+
+namespace mjx {
+    alignas(4096) unsigned char _Buddy_buffer[64 * 1024];
+
+    TEST(buddy_allocator, capacity) {
+        // the managed region is the largest power of two that fits in the resource
+        memory_resource _Res(_Buddy_buffer, 48 * 1024);
+        buddy_allocator _Al(_Res, 256);
+        EXPECT_EQ(_Al.capacity(), 32 * 1024);
+        EXPECT_EQ(_Al.min_block_size(), 256);
+        EXPECT_EQ(_Al.max_size(), 32 * 1024);
+
+        // the smallest block is rounded up to a power of two
+        buddy_allocator _Rounded_al(_Res, 100);
+        EXPECT_EQ(_Rounded_al.min_block_size(), 128);
+    }
+
+    TEST(buddy_allocator, split_and_merge) {
+        memory_resource _Res(_Buddy_buffer, sizeof(_Buddy_buffer));
+        buddy_allocator _Al(_Res, 1024);
+
+        // split the whole region into the smallest blocks
+        ::std::vector<void*> _Blocks;
+        for (size_t _Idx = 0; _Idx < _Al.capacity() / 1024; ++_Idx) {
+            void* const _Ptr = _Al.allocate(1000);
+            EXPECT_TRUE(_Res.contains(_Ptr, 1024)); // block should come from the resource
+            _Blocks.push_back(_Ptr);
+        }
+
+        EXPECT_THROW(static_cast<void>(_Al.allocate(1)), allocation_limit_exceeded);
+
+        // free the blocks in an interleaved order, buddies must merge back into a single block
+        for (size_t _Idx = 0; _Idx < _Blocks.size(); _Idx += 2) {
+            _Al.deallocate(_Blocks[_Idx], 1000);
+        }
+
+        EXPECT_THROW(static_cast<void>(_Al.allocate(2048)), allocation_limit_exceeded);
+        for (size_t _Idx = 1; _Idx < _Blocks.size(); _Idx += 2) {
+            _Al.deallocate(_Blocks[_Idx], 1000);
+        }
+
+        EXPECT_EQ(_Al.allocate(_Al.capacity()), _Res.data());
+    }
+
+    TEST(buddy_allocator, mixed_sizes) {
+        // fill each block with a pattern to detect overlapping blocks
+        memory_resource _Res(_Buddy_buffer, sizeof(_Buddy_buffer));
+        buddy_allocator _Al(_Res);
+        struct _Block {
+            unsigned char* _Ptr;
+            size_t _Size;
+        };
+
+        ::std::vector<_Block> _Blocks;
+        for (size_t _Size = 1; _Size <= 4096; _Size = _Size * 3 + 1) {
+            for (size_t _Idx = 0; _Idx < 3; ++_Idx) {
+                unsigned char* const _Ptr = static_cast<unsigned char*>(_Al.allocate(_Size));
+                EXPECT_EQ(reinterpret_cast<uintptr_t>(_Ptr) % __STDCPP_DEFAULT_NEW_ALIGNMENT__, 0);
+                ::memset(_Ptr, static_cast<int>(_Blocks.size()), _Size);
+                _Blocks.push_back({_Ptr, _Size});
+            }
+        }
+
+        for (size_t _Idx = 0; _Idx < _Blocks.size(); ++_Idx) {
+            for (size_t _Off = 0; _Off < _Blocks[_Idx]._Size; ++_Off) {
+                ASSERT_EQ(_Blocks[_Idx]._Ptr[_Off], static_cast<unsigned char>(_Idx));
+            }
+
+            _Al.deallocate(_Blocks[_Idx]._Ptr, _Blocks[_Idx]._Size);
+        }
+
+        // all blocks were freed, the whole region must be available again
+        EXPECT_EQ(_Al.allocate(_Al.capacity()), _Res.data());
+    }
+
+    TEST(buddy_allocator, aligned_allocation) {
+        memory_resource _Res(_Buddy_buffer, sizeof(_Buddy_buffer));
+        buddy_allocator _Al(_Res);
+        for (size_t _Align = 1; _Align <= 4096; _Align <<= 1) {
+            void* const _Ptr = _Al.allocate(24, _Align);
+            EXPECT_EQ(reinterpret_cast<uintptr_t>(_Ptr) % _Align, 0); // address should be aligned
+        }
+    }
+
+    TEST(buddy_allocator, unsupported_alignment) {
+        // the region starts at an address that is aligned only to the smallest block
+        memory_resource _Res(_Buddy_buffer + 64, sizeof(_Buddy_buffer) - 64);
+        buddy_allocator _Al(_Res, 64);
+        EXPECT_NE(_Al.allocate(64, 64), nullptr);
+        EXPECT_THROW(static_cast<void>(_Al.allocate(64, 128)), allocation_failure);
+    }
+
+    TEST(buddy_allocator, small_resource) {
+        // a resource smaller than the smallest block cannot serve any request
+        memory_resource _Res(_Buddy_buffer, 8);
+        buddy_allocator _Al(_Res);
+        EXPECT_EQ(_Al.capacity(), 0);
+        EXPECT_THROW(static_cast<void>(_Al.allocate(1)), allocation_limit_exceeded);
+    }
+
+    TEST(buddy_allocator, release) {
+        memory_resource _Res(_Buddy_buffer, sizeof(_Buddy_buffer));
+        buddy_allocator _Al(_Res, 4096);
+        void* const _Ptr = _Al.allocate(4096);
+        static_cast<void>(_Al.allocate(8192));
+        _Al.release();
+        EXPECT_EQ(_Al.allocate(4096), _Ptr);
+    }
+
+    TEST(buddy_allocator, good_size) {
+        // requests are rounded up to a power of two, but never below the smallest block
+        memory_resource _Res(_Buddy_buffer, sizeof(_Buddy_buffer));
+        buddy_allocator _Al(_Res, 64);
+        EXPECT_EQ(_Al.good_size(1), 64);
+        EXPECT_EQ(_Al.good_size(100), 128);
+        EXPECT_EQ(_Al.good_size(4096), 4096);
+        const allocation_result _Result = _Al.allocate_at_least(3000);
+        EXPECT_EQ(_Result.count, 4096);
+        _Al.deallocate(_Result.ptr, _Result.count);
+    }
+
+    TEST(buddy_allocator, tag) {
+        memory_resource _Res(_Buddy_buffer, 1024);
+        buddy_allocator _Al(_Res);
+        EXPECT_EQ(_Al.tag(), allocator_tag::buddy);
+    }
+
+    TEST(buddy_allocator, is_equal) {
+        memory_resource _Res(_Buddy_buffer, 1024);
+        buddy_allocator _Al0(_Res);
+        buddy_allocator _Al1(_Res);
+        EXPECT_EQ(_Al0, _Al0);
+        EXPECT_FALSE(_Al0 == _Al1);
+    }
+} // namespace mjx
\ No newline at end of file
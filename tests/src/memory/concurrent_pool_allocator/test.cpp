@@ -0,0 +1,265 @@
+// test.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <atomic>
+#include <gtest/gtest.h>
+#include <mjxsdk/memory/concurrent_pool_allocator.hpp>
+#include <mjxsdk/memory/exception.hpp>
+#include <mjxsdk/memory/system_allocator.hpp>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace mjx {
+    struct _Message_node { // a message passed between threads
+        size_t _Owner;
+        size_t _Sequence;
+    };
+
+    TEST(concurrent_pool_allocator, aligned_blocks) {
+        memory_resource _Res(4096);
+        concurrent_pool_allocator _Al(24, _Res, 64);
+        EXPECT_EQ(_Al.block_size(), 24);
+        EXPECT_EQ(_Al.block_align(), 64);
+        for (size_t _Idx = 0; _Idx < 8; ++_Idx) {
+            void* const _Ptr = _Al.allocate(24, 64);
+            EXPECT_EQ(reinterpret_cast<uintptr_t>(_Ptr) % 64, 0); // address should be aligned
+            EXPECT_TRUE(_Res.contains(_Ptr, 24)); // block should come from the resource
+        }
+    }
+
+    TEST(concurrent_pool_allocator, reuse_freed_blocks) {
+        memory_resource _Res(1024);
+        concurrent_pool_allocator _Al(32, _Res);
+        void* const _Ptr0 = _Al.allocate(32);
+        void* const _Ptr1 = _Al.allocate(32);
+        EXPECT_NE(_Ptr0, _Ptr1);
+
+        // freed blocks are reused in LIFO order
+        _Al.deallocate(_Ptr0, 32);
+        _Al.deallocate(_Ptr1, 32);
+        EXPECT_EQ(_Al.allocate(32), _Ptr1);
+        EXPECT_EQ(_Al.allocate(32), _Ptr0);
+    }
+
+    TEST(concurrent_pool_allocator, invalid_requests) {
+        memory_resource _Res(1024);
+        concurrent_pool_allocator _Al(16, _Res);
+        EXPECT_THROW(static_cast<void>(_Al.allocate(17)), allocation_limit_exceeded);
+        EXPECT_THROW(static_cast<void>(_Al.allocate(16, 64)), allocation_failure);
+    }
+
+    TEST(concurrent_pool_allocator, allocation_limit) {
+        // the resource holds exactly eight blocks, no matter how many threads compete for them
+        memory_resource _Res(8 * 64 + 64);
+        concurrent_pool_allocator _Al(64, _Res, 64);
+        const size_t _Padding  = (64 - reinterpret_cast<uintptr_t>(_Res.data()) % 64) % 64;
+        const size_t _Expected = (_Res.size() - _Padding) / 64;
+        ::std::atomic<size_t> _Count = 0;
+        ::std::vector<::std::thread> _Threads;
+        for (size_t _Thread = 0; _Thread < 4; ++_Thread) {
+            _Threads.emplace_back([&] {
+                try {
+                    for (;;) {
+                        static_cast<void>(_Al.allocate(64, 64));
+                        ++_Count;
+                    }
+                } catch (const allocation_limit_exceeded&) {
+                }
+            });
+        }
+
+        for (::std::thread& _Thread : _Threads) {
+            _Thread.join();
+        }
+
+        EXPECT_EQ(_Count.load(), _Expected);
+    }
+
+    TEST(concurrent_pool_allocator, release) {
+        memory_resource _Res(256);
+        concurrent_pool_allocator _Al(32, _Res);
+        void* const _Ptr = _Al.allocate(32);
+        _Al.allocate(32);
+        _Al.release();
+        EXPECT_EQ(_Al.allocate(32), _Ptr);
+    }
+
+    TEST(concurrent_pool_allocator, unique_blocks) {
+        // each thread stamps its blocks and verifies that no other thread received the same block
+        constexpr size_t _Thread_count = 8;
+        constexpr size_t _Iterations   = 50'000;
+        system_allocator _Upstream;
+        concurrent_pool_allocator _Al(sizeof(_Message_node), _Upstream);
+        ::std::atomic<bool> _Failed = false;
+        ::std::vector<::std::thread> _Threads;
+        for (size_t _Thread = 0; _Thread < _Thread_count; ++_Thread) {
+            _Threads.emplace_back([&, _Thread] {
+                ::std::vector<_Message_node*> _Nodes;
+                for (size_t _Idx = 0; _Idx < _Iterations; ++_Idx) {
+                    _Message_node* const _Node = static_cast<_Message_node*>(_Al.allocate(sizeof(_Message_node)));
+                    _Node->_Owner              = _Thread;
+                    _Node->_Sequence           = _Idx;
+                    _Nodes.push_back(_Node);
+                    if (_Nodes.size() == 16) { // verify the stamps, then free the whole batch
+                        for (_Message_node* const _Owned : _Nodes) {
+                            if (_Owned->_Owner != _Thread) {
+                                _Failed = true;
+                            }
+
+                            _Al.deallocate(_Owned, sizeof(_Message_node));
+                        }
+
+                        _Nodes.clear();
+                    }
+                }
+
+                for (_Message_node* const _Owned : _Nodes) {
+                    _Al.deallocate(_Owned, sizeof(_Message_node));
+                }
+            });
+        }
+
+        for (::std::thread& _Thread : _Threads) {
+            _Thread.join();
+        }
+
+        EXPECT_FALSE(_Failed.load());
+    }
+
+    TEST(concurrent_pool_allocator, producer_consumer) {
+        // producers allocate message nodes and consumers free them on other threads
+        constexpr size_t _Producer_count = 4;
+        constexpr size_t _Consumer_count = 4;
+        constexpr size_t _Messages       = 25'000; // per producer
+        system_allocator _Upstream;
+        concurrent_pool_allocator _Al(sizeof(_Message_node), _Upstream);
+        ::std::mutex _Mtx;
+        ::std::queue<_Message_node*> _Queue;
+        ::std::atomic<size_t> _Consumed = 0;
+        ::std::vector<size_t> _Last_sequence(_Producer_count, 0);
+        bool _Out_of_order              = false;
+        ::std::vector<::std::thread> _Threads;
+        for (size_t _Producer = 0; _Producer < _Producer_count; ++_Producer) {
+            _Threads.emplace_back([&, _Producer] {
+                for (size_t _Idx = 1; _Idx <= _Messages; ++_Idx) {
+                    _Message_node* const _Node = static_cast<_Message_node*>(_Al.allocate(sizeof(_Message_node)));
+                    _Node->_Owner              = _Producer;
+                    _Node->_Sequence           = _Idx;
+                    ::std::lock_guard _Guard(_Mtx);
+                    _Queue.push(_Node);
+                }
+            });
+        }
+
+        for (size_t _Consumer = 0; _Consumer < _Consumer_count; ++_Consumer) {
+            _Threads.emplace_back([&] {
+                while (_Consumed.load() < _Producer_count * _Messages) {
+                    _Message_node* _Node = nullptr;
+                    {
+                        ::std::lock_guard _Guard(_Mtx);
+                        if (_Queue.empty()) {
+                            continue;
+                        }
+
+                        _Node = _Queue.front();
+                        _Queue.pop();
+
+                        // messages from one producer are queued in order, a mismatch means a corrupted node
+                        if (_Node->_Sequence != _Last_sequence[_Node->_Owner] + 1) {
+                            _Out_of_order = true;
+                        }
+
+                        _Last_sequence[_Node->_Owner] = _Node->_Sequence;
+                    }
+
+                    _Al.deallocate(_Node, sizeof(_Message_node));
+                    ++_Consumed;
+                }
+            });
+        }
+
+        for (::std::thread& _Thread : _Threads) {
+            _Thread.join();
+        }
+
+        EXPECT_EQ(_Consumed.load(), _Producer_count * _Messages);
+        EXPECT_FALSE(_Out_of_order);
+    }
+
+    TEST(concurrent_pool_allocator, upstream_chunks) {
+        system_allocator _Upstream;
+        memory_resource _Res(64);
+        concurrent_pool_allocator _Al(16, _Res, _Upstream);
+        EXPECT_EQ(_Al.upstream(), &_Upstream);
+        EXPECT_TRUE(_Res.contains(_Al.allocate(16), 16));
+
+        // continue allocating until the blocks come from upstream chunks
+        bool _Used_upstream = false;
+        for (size_t _Idx = 0; _Idx < 2 * concurrent_pool_allocator::blocks_per_chunk; ++_Idx) {
+            if (!_Res.contains(_Al.allocate(16), 16)) {
+                _Used_upstream = true;
+            }
+        }
+
+        EXPECT_TRUE(_Used_upstream);
+    }
+
+    TEST(concurrent_pool_allocator, concurrent_bulk_allocation) {
+        // each thread allocates and frees whole batches, the blocks must never be shared
+        constexpr size_t _Thread_count = 4;
+        constexpr size_t _Batch_size   = 100;
+        system_allocator _Upstream;
+        concurrent_pool_allocator _Al(sizeof(size_t), _Upstream);
+        ::std::vector<::std::thread> _Threads;
+        ::std::atomic<bool> _Corrupted = false;
+        for (size_t _Thread = 0; _Thread < _Thread_count; ++_Thread) {
+            _Threads.emplace_back([&, _Thread] {
+                void* _Ptrs[_Batch_size];
+                for (size_t _Round = 0; _Round < 200; ++_Round) {
+                    _Al.allocate_bulk(sizeof(size_t), 0, _Batch_size, _Ptrs);
+                    for (void* const _Ptr : _Ptrs) {
+                        *static_cast<size_t*>(_Ptr) = _Thread;
+                    }
+
+                    for (void* const _Ptr : _Ptrs) {
+                        if (*static_cast<size_t*>(_Ptr) != _Thread) { // another thread owns the block
+                            _Corrupted = true;
+                        }
+                    }
+
+                    _Al.deallocate_bulk(_Ptrs, _Batch_size, sizeof(size_t));
+                }
+            });
+        }
+
+        for (::std::thread& _Thread : _Threads) {
+            _Thread.join();
+        }
+
+        EXPECT_FALSE(_Corrupted.load());
+    }
+
+    TEST(concurrent_pool_allocator, tag) {
+        memory_resource _Res(64);
+        concurrent_pool_allocator _Al(16, _Res);
+        EXPECT_EQ(_Al.tag(), allocator_tag::concurrent_pool);
+    }
+
+    TEST(concurrent_pool_allocator, max_size) {
+        memory_resource _Res(64);
+        concurrent_pool_allocator _Al(48, _Res);
+        EXPECT_EQ(_Al.max_size(), 48);
+    }
+
+    TEST(concurrent_pool_allocator, is_equal) {
+        memory_resource _Res(64);
+        concurrent_pool_allocator _Al0(16, _Res);
+        concurrent_pool_allocator _Al1(16, _Res);
+        EXPECT_EQ(_Al0, _Al0);
+        EXPECT_FALSE(_Al0 == _Al1);
+    }
+} // namespace mjx
\ No newline at end of file
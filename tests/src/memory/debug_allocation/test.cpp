@@ -0,0 +1,83 @@
+// test.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <cstdint>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <mjxsdk/memory/debug_allocation.hpp>
+#include <mjxsdk/memory/system_allocator.hpp>
+
+namespace mjx {
+    TEST(debug_allocation, enable_and_disable) {
+        ::mjx::enable_debug_allocation();
+        EXPECT_TRUE(::mjx::is_debug_allocation_enabled());
+        ::mjx::disable_debug_allocation();
+#ifdef _DEBUG
+        EXPECT_TRUE(::mjx::is_debug_allocation_enabled()); // debug builds are always in checked mode
+#else // ^^^ _DEBUG ^^^ / vvv NDEBUG vvv
+        EXPECT_FALSE(::mjx::is_debug_allocation_enabled());
+#endif // _DEBUG
+    }
+
+    TEST(debug_allocation, checked_blocks) {
+        system_allocator _Al;
+        ::mjx::enable_debug_allocation();
+        void* const _Ptr = _Al.allocate(100, 32);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(_Ptr) % 32, 0);
+        ::memset(_Ptr, 0xAB, 100);
+        _Al.deallocate(_Ptr, 100, 32);
+        ::mjx::disable_debug_allocation();
+    }
+
+    TEST(debug_allocation, buffer_overrun) {
+        system_allocator _Al;
+        ::mjx::enable_debug_allocation();
+        EXPECT_DEATH(
+            {
+                unsigned char* const _Ptr = static_cast<unsigned char*>(_Al.allocate(64));
+                _Ptr[64]                  = 0x11;
+                _Al.deallocate(_Ptr, 64);
+            },
+            "after the end of the block");
+        ::mjx::disable_debug_allocation();
+    }
+
+    TEST(debug_allocation, page_aligned_overrun) {
+        // page-aligned blocks keep their header out of band, the overrun sentinel is still inline
+        system_allocator _Al;
+        ::mjx::enable_debug_allocation();
+        void* const _Ptr = _Al.allocate(4096, 4096);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(_Ptr) % 4096, 0);
+        ::memset(_Ptr, 0xAB, 4096);
+        _Al.deallocate(_Ptr, 4096, 4096);
+        EXPECT_DEATH(
+            {
+                unsigned char* const _Ptr = static_cast<unsigned char*>(_Al.allocate(100, 4096));
+                _Ptr[100]                 = 0x11;
+                _Al.deallocate(_Ptr, 100, 4096);
+            },
+            "after the end of the block");
+        ::mjx::disable_debug_allocation();
+    }
+
+    TEST(debug_allocation, deallocation_after_disable) {
+        // blocks allocated in checked mode are still verified once the mode is disabled
+        system_allocator _Al;
+        ::mjx::enable_debug_allocation();
+        void* const _Checked            = _Al.allocate(64);
+        unsigned char* const _Corrupted = static_cast<unsigned char*>(_Al.allocate(64));
+        ::mjx::disable_debug_allocation();
+        void* const _Regular = _Al.allocate(64);
+        _Al.deallocate(_Checked, 64);
+        _Al.deallocate(_Regular, 64);
+        EXPECT_DEATH(
+            {
+                _Corrupted[-1] = 0x11;
+                _Al.deallocate(_Corrupted, 64);
+            },
+            "before the begin of the block");
+        _Al.deallocate(_Corrupted, 64);
+    }
+} // namespace mjx
\ No newline at end of file
@@ -41,6 +41,10 @@ namespace mjx {
         _Test_block_size(0x0000'FFFF, 32, 0x0001'0040);
         _Test_block_size(0x1000'0000, 128, 0x1000'0100);
         _Test_block_size(0xFFFF'0000, 512, 0xFFFF'0400);
+
+        // large alignments keep the header out of band, only the overrun sentinel is inline
+        _Test_block_size(4096, 4096, 4100);
+        _Test_block_size(0x0020'0000, 0x0020'0000, 0x0020'0004);
     }
 
     TEST(debug_block, prepare_block) {
@@ -50,5 +54,26 @@ namespace mjx {
         _Test_prepare_block(4033, 512, allocator_tag{212});
         _Test_prepare_block(16384, 2048, allocator_tag{255});
     }
+
+    TEST(debug_block, out_of_band_header) {
+        constexpr size_t _Size   = 8192;
+        constexpr size_t _Align  = 4096;
+        const size_t _Block_size = mjxsdk_impl::_Calculate_block_size(_Size, _Align);
+        auto _Block              = ::mjx::make_unique_array<unsigned char>(_Block_size);
+        void* const _Ptr         =
+            mjxsdk_impl::_Prepare_block(_Block.get(), _Block_size, _Size, _Align, allocator_tag{7});
+        EXPECT_EQ(_Ptr, _Block.get()); // the block begins with the user block
+
+        mjxsdk_impl::_Block_header _Header;
+        ASSERT_TRUE(mjxsdk_impl::_Get_out_of_band_headers()._Find(_Ptr, &_Header));
+        EXPECT_EQ(_Header._Size, _Size);
+        EXPECT_EQ(_Header._Align, _Align);
+        EXPECT_EQ(_Header._Tag, allocator_tag{7});
+        EXPECT_EQ(_Header._State, mjxsdk_impl::_Block_state::_Allocated);
+
+        EXPECT_EQ(mjxsdk_impl::_Extract_and_validate_block(_Ptr, _Size, _Align, allocator_tag{7}), _Block.get());
+        ASSERT_TRUE(mjxsdk_impl::_Get_out_of_band_headers()._Erase(_Ptr, &_Header));
+        EXPECT_EQ(_Header._State, mjxsdk_impl::_Block_state::_Deallocated);
+    }
 } // namespace mjx
 #endif // _DEBUG
\ No newline at end of file
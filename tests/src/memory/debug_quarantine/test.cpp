@@ -0,0 +1,72 @@
+// test.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+#include <mjxsdk/memory/debug_quarantine.hpp>
+#include <mjxsdk/memory/system_allocator.hpp>
+
+namespace mjx {
+    TEST(debug_quarantine, quarantine_size) {
+        EXPECT_EQ(::mjx::debug_quarantine_size(), default_debug_quarantine_size);
+        ::mjx::set_debug_quarantine_size(1024);
+        EXPECT_EQ(::mjx::debug_quarantine_size(), 1024);
+        ::mjx::set_debug_quarantine_size(default_debug_quarantine_size);
+    }
+
+    TEST(debug_quarantine, intact_blocks) {
+        // blocks that were not written after deallocation leave the quarantine silently
+        system_allocator _Al;
+        ::mjx::set_debug_quarantine_size(4096);
+        for (size_t _Size = 1; _Size <= 1024; _Size *= 2) {
+            void* const _Ptr = _Al.allocate(_Size, 16);
+            _Al.deallocate(_Ptr, _Size, 16);
+        }
+
+        ::mjx::flush_debug_quarantine();
+        ::mjx::set_debug_quarantine_size(default_debug_quarantine_size);
+    }
+
+#ifdef _DEBUG
+    TEST(debug_quarantine, write_after_free) {
+        system_allocator _Al;
+        EXPECT_DEATH(
+            {
+                unsigned char* const _Ptr = static_cast<unsigned char*>(_Al.allocate(256));
+                _Al.deallocate(_Ptr, 256);
+                _Ptr[200] = 0x11;
+                ::mjx::flush_debug_quarantine();
+            },
+            "after the block was deallocated");
+    }
+
+    TEST(debug_quarantine, eviction_check) {
+        // the oldest block is verified once newer blocks push it out of the quarantine
+        system_allocator _Al;
+        ::mjx::set_debug_quarantine_size(1024);
+        EXPECT_DEATH(
+            {
+                unsigned char* const _Ptr = static_cast<unsigned char*>(_Al.allocate(64));
+                _Al.deallocate(_Ptr, 64);
+                _Ptr[0] = 0x11;
+                for (int _Idx = 0; _Idx < 32; ++_Idx) {
+                    _Al.deallocate(_Al.allocate(64), 64);
+                }
+            },
+            "after the block was deallocated");
+        ::mjx::set_debug_quarantine_size(default_debug_quarantine_size);
+    }
+
+    TEST(debug_quarantine, double_deallocation) {
+        system_allocator _Al;
+        EXPECT_DEATH(
+            {
+                void* const _Ptr = _Al.allocate(64);
+                _Al.deallocate(_Ptr, 64);
+                _Al.deallocate(_Ptr, 64);
+            },
+            "already deallocated");
+    }
+#endif // _DEBUG
+} // namespace mjx
\ No newline at end of file
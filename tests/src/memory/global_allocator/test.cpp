@@ -5,6 +5,9 @@
 
 #include <gtest/gtest.h>
 #include <mjxsdk/memory/allocator.hpp>
+#include <mjxsdk/memory/monotonic_allocator.hpp>
+#include <mjxsdk/memory/smart_pointer.hpp>
+#include <thread>
 
 namespace mjx {
     class custom_allocator : public allocator {
@@ -87,4 +90,47 @@ namespace mjx {
         _Global_al.is_equal(_Al);
         EXPECT_EQ(_Counter, _Expected_counter);
     }
+
+    TEST(global_allocator, scoped_override) {
+        custom_allocator _Al0;
+        custom_allocator _Al1;
+        allocator& _Default_al = ::mjx::get_global_allocator();
+        {
+            scoped_allocator_override _Override0(_Al0);
+            EXPECT_EQ(&::mjx::get_global_allocator(), &_Al0);
+            {
+                // the most recent override wins until it ends
+                scoped_allocator_override _Override1(_Al1);
+                EXPECT_EQ(&::mjx::get_global_allocator(), &_Al1);
+            }
+
+            EXPECT_EQ(&::mjx::get_global_allocator(), &_Al0);
+        }
+
+        EXPECT_EQ(&::mjx::get_global_allocator(), &_Default_al);
+    }
+
+    TEST(global_allocator, scoped_override_per_thread) {
+        // an override affects only the thread that created it
+        custom_allocator _Al;
+        allocator& _Default_al = ::mjx::get_global_allocator();
+        scoped_allocator_override _Override(_Al);
+        allocator* _Other_al = nullptr;
+        ::std::thread _Thread([&] { _Other_al = &::mjx::get_global_allocator(); });
+        _Thread.join();
+        EXPECT_EQ(_Other_al, &_Default_al);
+        EXPECT_EQ(&::mjx::get_global_allocator(), &_Al);
+    }
+
+    TEST(global_allocator, scoped_override_arena) {
+        // smart pointers created within the scope come from the arena
+        memory_resource _Res(1024);
+        monotonic_allocator _Arena(_Res);
+        scoped_allocator_override _Override(_Arena);
+        auto _Ptr   = ::mjx::make_unique<int>(42);
+        auto _Array = ::mjx::make_unique_array<double>(16, 1.5);
+        EXPECT_TRUE(_Arena.contains(_Ptr.get(), sizeof(int)));
+        EXPECT_TRUE(_Arena.contains(_Array.get(), 16 * sizeof(double)));
+        EXPECT_EQ(*_Ptr, 42);
+    }
 } // namespace mjx
\ No newline at end of file
@@ -0,0 +1,138 @@
+// test.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <cstdint>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <mjxsdk/memory/guarded_sampling.hpp>
+#include <mjxsdk/memory/system_allocator.hpp>
+
+namespace mjx {
+    TEST(guarded_sampling, guarded_allocation) {
+        // a sample rate of 1 guards every block that fits in a page
+        system_allocator _Al;
+        ASSERT_TRUE(::mjx::start_guarded_sampling(1, 16));
+        EXPECT_TRUE(::mjx::is_guarded_sampling_active());
+        void* const _Ptr = _Al.allocate(100);
+        EXPECT_TRUE(::mjx::is_guarded_block(_Ptr));
+        ::memset(_Ptr, 0xAB, 100);
+        EXPECT_EQ(static_cast<unsigned char*>(_Ptr)[99], 0xAB);
+        _Al.deallocate(_Ptr, 100);
+        ::mjx::stop_guarded_sampling();
+    }
+
+    TEST(guarded_sampling, aligned_allocation) {
+        system_allocator _Al;
+        ASSERT_TRUE(::mjx::start_guarded_sampling(1, 16));
+        for (int _Idx = 0; _Idx < 4; ++_Idx) { // blocks alternate between both ends of their pages
+            void* const _Ptr = _Al.allocate(40, 64);
+            EXPECT_TRUE(::mjx::is_guarded_block(_Ptr));
+            EXPECT_EQ(reinterpret_cast<uintptr_t>(_Ptr) % 64, 0);
+            _Al.deallocate(_Ptr, 40, 64);
+        }
+
+        ::mjx::stop_guarded_sampling();
+    }
+
+    TEST(guarded_sampling, large_allocation) {
+        system_allocator _Al;
+        ASSERT_TRUE(::mjx::start_guarded_sampling(1, 16));
+        void* const _Ptr = _Al.allocate(1024 * 1024);
+        EXPECT_FALSE(::mjx::is_guarded_block(_Ptr));
+        _Al.deallocate(_Ptr, 1024 * 1024);
+        ::mjx::stop_guarded_sampling();
+    }
+
+    TEST(guarded_sampling, deallocation_after_stop) {
+        system_allocator _Al;
+        ASSERT_TRUE(::mjx::start_guarded_sampling(1, 16));
+        void* const _Ptr = _Al.allocate(32);
+        ::mjx::stop_guarded_sampling();
+        EXPECT_FALSE(::mjx::is_guarded_sampling_active());
+        EXPECT_TRUE(::mjx::is_guarded_block(_Ptr));
+        _Al.deallocate(_Ptr, 32);
+        void* const _Other = _Al.allocate(32);
+        EXPECT_FALSE(::mjx::is_guarded_block(_Other));
+        _Al.deallocate(_Other, 32);
+    }
+
+    TEST(guarded_sampling, reallocation_after_stop) {
+        // the heap must never see a guarded block, even once no diagnostic tool is enabled
+        system_allocator _Al;
+        ASSERT_TRUE(::mjx::start_guarded_sampling(1, 16));
+        void* const _Ptr = _Al.allocate(32);
+        ::mjx::stop_guarded_sampling();
+        ASSERT_TRUE(::mjx::is_guarded_block(_Ptr));
+        ::memset(_Ptr, 0xCD, 32);
+        EXPECT_FALSE(_Al.try_expand_in_place(_Ptr, 32, 48));
+        void* const _New_ptr = _Al.reallocate(_Ptr, 32, 64);
+        EXPECT_FALSE(::mjx::is_guarded_block(_New_ptr));
+        EXPECT_EQ(static_cast<unsigned char*>(_New_ptr)[31], 0xCD);
+        _Al.deallocate(_New_ptr, 64);
+    }
+
+    TEST(guarded_sampling, slot_exhaustion) {
+        // once every slot is taken, blocks come from the heap
+        system_allocator _Al;
+        ASSERT_TRUE(::mjx::start_guarded_sampling(1, 16));
+        void* _Ptrs[32];
+        size_t _Guarded = 0;
+        for (void*& _Ptr : _Ptrs) {
+            _Ptr = _Al.allocate(8);
+            if (::mjx::is_guarded_block(_Ptr)) {
+                ++_Guarded;
+            }
+        }
+
+        EXPECT_EQ(_Guarded, 16); // the pool keeps the slot count of the first start
+        for (void* const _Ptr : _Ptrs) {
+            _Al.deallocate(_Ptr, 8);
+        }
+
+        ::mjx::stop_guarded_sampling();
+    }
+
+    TEST(guarded_sampling, use_after_free) {
+        system_allocator _Al;
+        ASSERT_TRUE(::mjx::start_guarded_sampling(1, 16));
+        EXPECT_DEATH(
+            {
+                volatile unsigned char* const _Ptr = static_cast<unsigned char*>(_Al.allocate(64));
+                _Al.deallocate(const_cast<unsigned char*>(_Ptr), 64);
+                _Ptr[0] = 1;
+            },
+            "Use-after-free");
+        ::mjx::stop_guarded_sampling();
+    }
+
+    TEST(guarded_sampling, buffer_overrun) {
+        system_allocator _Al;
+        ASSERT_TRUE(::mjx::start_guarded_sampling(1, 16));
+        EXPECT_DEATH(
+            {
+                volatile unsigned char* _Ptr = static_cast<unsigned char*>(_Al.allocate(64));
+                if (reinterpret_cast<uintptr_t>(_Ptr + 64) % 4096 != 0) { // placed at the beginning of the page
+                    _Ptr = static_cast<unsigned char*>(_Al.allocate(64));
+                }
+
+                _Ptr[64] = 1;
+            },
+            "overrun");
+        ::mjx::stop_guarded_sampling();
+    }
+
+    TEST(guarded_sampling, double_deallocation) {
+        system_allocator _Al;
+        ASSERT_TRUE(::mjx::start_guarded_sampling(1, 16));
+        EXPECT_DEATH(
+            {
+                void* const _Ptr = _Al.allocate(64);
+                _Al.deallocate(_Ptr, 64);
+                _Al.deallocate(_Ptr, 64);
+            },
+            "Double deallocation");
+        ::mjx::stop_guarded_sampling();
+    }
+} // namespace mjx
\ No newline at end of file
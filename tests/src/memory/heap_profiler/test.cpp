@@ -0,0 +1,118 @@
+// test.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <mjxsdk/memory/heap_profiler.hpp>
+#include <mjxsdk/memory/system_allocator.hpp>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace mjx {
+    struct _Profile_totals { // totals from the header of a heap profile
+        unsigned long long _Live_count  = 0;
+        unsigned long long _Live_bytes  = 0;
+        unsigned long long _Total_count = 0;
+        unsigned long long _Total_bytes = 0;
+        size_t _Interval                = 0;
+    };
+
+    inline ::std::string _Read_heap_profile() {
+        const ::std::string _Path = (::std::filesystem::temp_directory_path() / "mjxsdk_heap_profile").string();
+        EXPECT_TRUE(::mjx::write_heap_profile(_Path.c_str()));
+        ::std::ifstream _File(_Path);
+        ::std::stringstream _Stream;
+        _Stream << _File.rdbuf();
+        ::std::filesystem::remove(_Path);
+        return _Stream.str();
+    }
+
+    inline _Profile_totals _Read_profile_totals() {
+        const ::std::string _Profile = _Read_heap_profile();
+        _Profile_totals _Totals;
+        EXPECT_EQ(::sscanf(_Profile.c_str(), "heap profile: %llu: %llu [%llu: %llu] @ heap_v2/%zu",
+                      &_Totals._Live_count, &_Totals._Live_bytes, &_Totals._Total_count, &_Totals._Total_bytes,
+                      &_Totals._Interval),
+            5);
+        EXPECT_NE(_Profile.find("\nMAPPED_LIBRARIES:\n"), ::std::string::npos);
+        return _Totals;
+    }
+
+    TEST(heap_profiler, sample_every_block) {
+        // with a one-byte interval every allocation is sampled
+        system_allocator _Al;
+        ::mjx::start_heap_profiler(1);
+        EXPECT_TRUE(::mjx::is_heap_profiler_active());
+        ::std::vector<void*> _Blocks;
+        for (size_t _Idx = 0; _Idx < 10; ++_Idx) {
+            _Blocks.push_back(_Al.allocate(256));
+        }
+
+        _Profile_totals _Totals = _Read_profile_totals();
+        EXPECT_EQ(_Totals._Live_count, 10);
+        EXPECT_EQ(_Totals._Live_bytes, 10 * 256);
+        EXPECT_EQ(_Totals._Interval, 1);
+
+        for (void* const _Block : _Blocks) {
+            _Al.deallocate(_Block, 256);
+        }
+
+        _Totals = _Read_profile_totals();
+        EXPECT_EQ(_Totals._Live_count, 0);
+        EXPECT_EQ(_Totals._Live_bytes, 0);
+        EXPECT_EQ(_Totals._Total_count, 10);
+        EXPECT_EQ(_Totals._Total_bytes, 10 * 256);
+        ::mjx::stop_heap_profiler();
+    }
+
+    TEST(heap_profiler, sampling_interval) {
+        // the number of samples is close to the number of allocated bytes divided by the interval
+        constexpr size_t _Count    = 100'000;
+        constexpr size_t _Interval = 4096;
+        system_allocator _Al;
+        ::mjx::start_heap_profiler(_Interval);
+        ::std::vector<void*> _Blocks;
+        for (size_t _Idx = 0; _Idx < _Count; ++_Idx) {
+            _Blocks.push_back(_Al.allocate(64));
+        }
+
+        const _Profile_totals _Totals = _Read_profile_totals();
+        EXPECT_GT(_Totals._Live_count, _Count * 64 / _Interval * 3 / 4);
+        EXPECT_LT(_Totals._Live_count, _Count * 64 / _Interval * 5 / 4);
+        for (void* const _Block : _Blocks) {
+            _Al.deallocate(_Block, 64);
+        }
+
+        EXPECT_EQ(_Read_profile_totals()._Live_count, 0);
+        ::mjx::stop_heap_profiler();
+    }
+
+    TEST(heap_profiler, reallocation) {
+        // a moved block is tracked at its new address
+        system_allocator _Al;
+        ::mjx::start_heap_profiler(1);
+        void* _Ptr = _Al.allocate(64);
+        _Ptr       = _Al.reallocate(_Ptr, 64, 1024 * 1024);
+        _Profile_totals _Totals = _Read_profile_totals();
+        EXPECT_EQ(_Totals._Live_count, 1);
+        EXPECT_EQ(_Totals._Live_bytes, 1024 * 1024);
+
+        _Al.deallocate(_Ptr, 1024 * 1024);
+        EXPECT_EQ(_Read_profile_totals()._Live_count, 0);
+        ::mjx::stop_heap_profiler();
+    }
+
+    TEST(heap_profiler, stopped_profiler) {
+        system_allocator _Al;
+        ::mjx::start_heap_profiler(1);
+        ::mjx::stop_heap_profiler();
+        EXPECT_FALSE(::mjx::is_heap_profiler_active());
+        _Al.deallocate(_Al.allocate(64), 64);
+        EXPECT_EQ(_Read_profile_totals()._Total_count, 0);
+    }
+} // namespace mjx
\ No newline at end of file
@@ -0,0 +1,145 @@
+// test.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <mjxsdk/core/macros.hpp>
+#include <mjxsdk/memory/leak_registry.hpp>
+#include <mjxsdk/memory/pool_allocator.hpp>
+#include <mjxsdk/memory/small_object_allocator.hpp>
+#include <mjxsdk/memory/system_allocator.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace mjx {
+    _MJX_NOINLINE void _Allocate_from_first_site(allocator& _Al, void*& _Ptr) {
+        // the result is stored after the call, so that the call cannot become a tail call
+        _Ptr = _Al.allocate(1024);
+    }
+
+    _MJX_NOINLINE void _Allocate_from_second_site(allocator& _Al, void*& _Ptr) {
+        _Ptr = _Al.allocate(16);
+    }
+
+    TEST(leak_registry, group_by_call_site) {
+        system_allocator _Al;
+        ::mjx::start_leak_registry();
+        EXPECT_TRUE(::mjx::is_leak_registry_active());
+        void* _Ptrs[3];
+        _Allocate_from_first_site(_Al, _Ptrs[0]);
+        _Allocate_from_first_site(_Al, _Ptrs[1]);
+        _Allocate_from_second_site(_Al, _Ptrs[2]);
+        EXPECT_EQ(::mjx::live_allocation_count(), 3);
+
+        allocation_site _Sites[4];
+        ASSERT_EQ(::mjx::get_live_allocation_sites(_Sites, 4), 2);
+        EXPECT_EQ(_Sites[0].count, 2); // the site with the most bytes comes first
+        EXPECT_EQ(_Sites[0].bytes, 2 * 1024);
+        EXPECT_EQ(_Sites[0].tag, allocator_tag::system);
+        EXPECT_EQ(_Sites[1].count, 1);
+        EXPECT_EQ(_Sites[1].bytes, 16);
+        EXPECT_NE(_Sites[0].return_address, _Sites[1].return_address);
+
+        _Al.deallocate(_Ptrs[0], 1024);
+        _Al.deallocate(_Ptrs[1], 1024);
+        _Al.deallocate(_Ptrs[2], 16);
+        EXPECT_EQ(::mjx::live_allocation_count(), 0);
+        EXPECT_EQ(::mjx::get_live_allocation_sites(_Sites, 4), 0);
+        ::mjx::stop_leak_registry();
+    }
+
+    TEST(leak_registry, owning_allocator_tag) {
+        // blocks are registered with the tag of the allocator that hands them out, its chunks are not registered
+        system_allocator _Upstream;
+        pool_allocator _Pool(64, _Upstream);
+        small_object_allocator _Small;
+        ::mjx::start_leak_registry();
+        void* _Ptrs[3];
+        _Allocate_from_second_site(_Pool, _Ptrs[0]);
+        _Allocate_from_second_site(_Pool, _Ptrs[1]);
+        _Allocate_from_first_site(_Small, _Ptrs[2]);
+        EXPECT_EQ(::mjx::live_allocation_count(), 3);
+
+        allocation_site _Sites[4];
+        ASSERT_EQ(::mjx::get_live_allocation_sites(_Sites, 4), 2);
+        EXPECT_EQ(_Sites[0].tag, allocator_tag::small_object);
+        EXPECT_EQ(_Sites[0].count, 1);
+        EXPECT_EQ(_Sites[0].bytes, 1024);
+        EXPECT_EQ(_Sites[1].tag, allocator_tag::pool);
+        EXPECT_EQ(_Sites[1].count, 2);
+        EXPECT_EQ(_Sites[1].bytes, 2 * 16);
+
+        _Pool.deallocate(_Ptrs[0], 16);
+        _Pool.deallocate(_Ptrs[1], 16);
+        _Small.deallocate(_Ptrs[2], 1024);
+        EXPECT_EQ(::mjx::live_allocation_count(), 0);
+        ::mjx::stop_leak_registry();
+    }
+
+    TEST(leak_registry, leak_report) {
+        system_allocator _Al;
+        ::mjx::start_leak_registry();
+        void* _Ptr;
+        _Allocate_from_first_site(_Al, _Ptr);
+        const ::std::string _Path = (::std::filesystem::temp_directory_path() / "mjxsdk_leak_report").string();
+        EXPECT_TRUE(::mjx::write_leak_report(_Path.c_str()));
+        _Al.deallocate(_Ptr, 1024);
+        ::mjx::stop_leak_registry();
+
+        ::std::ifstream _File(_Path);
+        ::std::string _Line;
+        ::std::getline(_File, _Line);
+        EXPECT_EQ(_Line, "leak report: 1024 bytes in 1 blocks from 1 call sites");
+        ::std::getline(_File, _Line);
+        EXPECT_NE(_Line.find("1024 bytes in        1 blocks"), ::std::string::npos);
+        _File.close();
+        ::std::filesystem::remove(_Path);
+    }
+
+    TEST(leak_registry, concurrent_allocation) {
+        // every thread keeps many blocks alive to make the shards grow and shrink
+        constexpr size_t _Thread_count = 8;
+        constexpr size_t _Iterations   = 20'000;
+        system_allocator _Al;
+        ::mjx::start_leak_registry();
+        ::std::vector<::std::thread> _Threads;
+        for (size_t _Thread = 0; _Thread < _Thread_count; ++_Thread) {
+            _Threads.emplace_back([&_Al] {
+                ::std::vector<void*> _Blocks;
+                for (size_t _Idx = 0; _Idx < _Iterations; ++_Idx) {
+                    _Blocks.push_back(_Al.allocate(32));
+                    if (_Idx % 3 == 0) { // free some of the blocks on the way
+                        _Al.deallocate(_Blocks[_Blocks.size() / 2], 32);
+                        _Blocks[_Blocks.size() / 2] = _Blocks.back();
+                        _Blocks.pop_back();
+                    }
+                }
+
+                for (void* const _Block : _Blocks) {
+                    _Al.deallocate(_Block, 32);
+                }
+            });
+        }
+
+        for (::std::thread& _Thread : _Threads) {
+            _Thread.join();
+        }
+
+        EXPECT_EQ(::mjx::live_allocation_count(), 0);
+        ::mjx::stop_leak_registry();
+    }
+
+    TEST(leak_registry, stopped_registry) {
+        system_allocator _Al;
+        ::mjx::start_leak_registry();
+        ::mjx::stop_leak_registry();
+        EXPECT_FALSE(::mjx::is_leak_registry_active());
+        void* const _Ptr = _Al.allocate(64);
+        EXPECT_EQ(::mjx::live_allocation_count(), 0);
+        _Al.deallocate(_Ptr, 64);
+    }
+} // namespace mjx
\ No newline at end of file
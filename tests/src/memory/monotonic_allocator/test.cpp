@@ -0,0 +1,118 @@
+// test.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+#include <mjxsdk/memory/exception.hpp>
+#include <mjxsdk/memory/monotonic_allocator.hpp>
+#include <mjxsdk/memory/system_allocator.hpp>
+
+namespace mjx {
+    TEST(monotonic_allocator, aligned_allocation) {
+        memory_resource _Res(4096);
+        monotonic_allocator _Al(_Res);
+        for (size_t _Align = 1; _Align <= 256; _Align <<= 1) {
+            void* const _Ptr = _Al.allocate(24, _Align);
+            EXPECT_EQ(reinterpret_cast<uintptr_t>(_Ptr) % _Align, 0); // address should be aligned
+            EXPECT_TRUE(_Res.contains(_Ptr, 24)); // block should come from the resource
+        }
+    }
+
+    TEST(monotonic_allocator, default_alignment) {
+        // blocks without explicit alignment must be suitable for any fundamental type
+        memory_resource _Res(1024);
+        monotonic_allocator _Al(_Res);
+        for (size_t _Size = 1; _Size < 32; ++_Size) {
+            void* const _Ptr = _Al.allocate(_Size);
+            EXPECT_EQ(reinterpret_cast<uintptr_t>(_Ptr) % __STDCPP_DEFAULT_NEW_ALIGNMENT__, 0);
+        }
+    }
+
+    TEST(monotonic_allocator, allocation_limit) {
+        memory_resource _Res(256);
+        monotonic_allocator _Al(_Res);
+        EXPECT_NE(_Al.allocate(128), nullptr);
+        EXPECT_NE(_Al.allocate(128), nullptr);
+        EXPECT_THROW(static_cast<void>(_Al.allocate(1)), allocation_limit_exceeded);
+    }
+
+    TEST(monotonic_allocator, release) {
+        memory_resource _Res(512);
+        monotonic_allocator _Al(_Res);
+        void* const _Ptr = _Al.allocate(512);
+        EXPECT_EQ(_Ptr, _Res.data());
+        EXPECT_THROW(static_cast<void>(_Al.allocate(1)), allocation_limit_exceeded);
+
+        // releasing makes the whole resource available again
+        _Al.release();
+        EXPECT_EQ(_Al.allocate(512), _Ptr);
+    }
+
+    TEST(monotonic_allocator, upstream_chunks) {
+        memory_resource _Res(128);
+        system_allocator _Upstream;
+        monotonic_allocator _Al(_Res, _Upstream);
+        EXPECT_EQ(_Al.upstream(), &_Upstream);
+        EXPECT_TRUE(_Res.contains(_Al.allocate(128), 128));
+
+        // the resource is exhausted, further blocks come from upstream chunks
+        void* const _Ptr = _Al.allocate(64);
+        EXPECT_NE(_Ptr, nullptr);
+        EXPECT_FALSE(_Res.contains(_Ptr, 64));
+
+        // a block larger than the default chunk size must still be served
+        void* const _Large_ptr = _Al.allocate(4 * monotonic_allocator::min_chunk_size, 64);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(_Large_ptr) % 64, 0);
+        ::memset(_Large_ptr, 0xFF, 4 * monotonic_allocator::min_chunk_size);
+        _Al.release();
+    }
+
+    TEST(monotonic_allocator, upstream_only) {
+        system_allocator _Upstream;
+        monotonic_allocator _Al(_Upstream);
+        for (size_t _Idx = 0; _Idx < 1000; ++_Idx) {
+            ::memset(_Al.allocate(100), 0xFF, 100);
+        }
+    }
+
+    TEST(monotonic_allocator, try_expand_in_place) {
+        memory_resource _Res(512);
+        monotonic_allocator _Al(_Res);
+        void* const _Ptr0 = _Al.allocate(64);
+        void* const _Ptr1 = _Al.allocate(64);
+        EXPECT_FALSE(_Al.try_expand_in_place(_Ptr0, 64, 128)); // only the most recent block can grow
+        EXPECT_TRUE(_Al.try_expand_in_place(_Ptr1, 64, 256));
+        EXPECT_FALSE(_Al.try_expand_in_place(_Ptr1, 256, 1024)); // exceeds the resource
+
+        // the contents of the older block are copied to a new one
+        ::memset(_Ptr0, 0xAB, 64);
+        unsigned char* const _Ptr2 = static_cast<unsigned char*>(_Al.reallocate(_Ptr0, 64, 96));
+        EXPECT_NE(_Ptr2, _Ptr0);
+        EXPECT_EQ(_Ptr2[63], 0xAB);
+    }
+
+    TEST(monotonic_allocator, tag) {
+        memory_resource _Res(64);
+        monotonic_allocator _Al(_Res);
+        EXPECT_EQ(_Al.tag(), allocator_tag::monotonic);
+    }
+
+    TEST(monotonic_allocator, max_size) {
+        memory_resource _Res(64);
+        monotonic_allocator _Al0(_Res);
+        EXPECT_EQ(_Al0.max_size(), 64);
+
+        system_allocator _Upstream;
+        monotonic_allocator _Al1(_Res, _Upstream);
+        EXPECT_EQ(_Al1.max_size(), _Upstream.max_size());
+    }
+
+    TEST(monotonic_allocator, is_equal) {
+        memory_resource _Res(64);
+        monotonic_allocator _Al0(_Res);
+        monotonic_allocator _Al1(_Res);
+        EXPECT_EQ(_Al0, _Al0);
+        EXPECT_FALSE(_Al0 == _Al1);
+    }
+} // namespace mjx
\ No newline at end of file
@@ -88,4 +88,30 @@ namespace mjx {
 
         ::mjx::delete_object_array(_Array, _Array_size);
     }
+
+    TEST(object_management, create_and_delete_objects) {
+        // test creation and deletion of separately allocated objects, which are allocated in batches
+        constexpr size_t _Count = 200;
+        _Object_state _States[_Count];
+        _Object_with_state* _Objs[_Count];
+        ::mjx::allocate_objects(_Objs, _Count);
+        for (size_t _Idx = 0; _Idx < _Count; ++_Idx) {
+            ::mjx::construct_object(_Objs[_Idx], &_States[_Idx]);
+        }
+
+        ::mjx::delete_objects(_Objs, _Count);
+        for (const _Object_state _State : _States) {
+            EXPECT_EQ(_State, _Object_state::_Destroyed);
+        }
+
+        _Object_with_members* _Members[_Count];
+        ::mjx::create_objects(_Members, _Count, true, 'X', 1024);
+        for (_Object_with_members* const _Obj : _Members) {
+            EXPECT_EQ(_Obj->_Mem0, true);
+            EXPECT_EQ(_Obj->_Mem1, 'X');
+            EXPECT_EQ(_Obj->_Mem2, 1024);
+        }
+
+        ::mjx::delete_objects(_Members, _Count);
+    }
 } // namespace mjx
\ No newline at end of file
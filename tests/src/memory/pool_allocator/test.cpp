@@ -0,0 +1,181 @@
+// test.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+#include <mjxsdk/memory/exception.hpp>
+#include <mjxsdk/memory/object.hpp>
+#include <mjxsdk/memory/pool_allocator.hpp>
+#include <mjxsdk/memory/system_allocator.hpp>
+#include <vector>
+
+namespace mjx {
+    struct _Pool_node { // a typical linked list node
+        _Pool_node* _Next;
+        int _Value;
+
+        explicit _Pool_node(const int _Val) noexcept : _Next(nullptr), _Value(_Val) {}
+    };
+
+    TEST(pool_allocator, aligned_blocks) {
+        memory_resource _Res(4096);
+        pool_allocator _Al(24, _Res, 64);
+        EXPECT_EQ(_Al.block_size(), 24);
+        EXPECT_EQ(_Al.block_align(), 64);
+        for (size_t _Idx = 0; _Idx < 8; ++_Idx) {
+            void* const _Ptr = _Al.allocate(24, 64);
+            EXPECT_EQ(reinterpret_cast<uintptr_t>(_Ptr) % 64, 0); // address should be aligned
+            EXPECT_TRUE(_Res.contains(_Ptr, 24)); // block should come from the resource
+        }
+    }
+
+    TEST(pool_allocator, reuse_freed_blocks) {
+        memory_resource _Res(1024);
+        pool_allocator _Al(32, _Res);
+        void* const _Ptr0 = _Al.allocate(32);
+        void* const _Ptr1 = _Al.allocate(32);
+        EXPECT_NE(_Ptr0, _Ptr1);
+
+        // freed blocks are reused in LIFO order
+        _Al.deallocate(_Ptr0, 32);
+        _Al.deallocate(_Ptr1, 32);
+        EXPECT_EQ(_Al.allocate(32), _Ptr1);
+        EXPECT_EQ(_Al.allocate(32), _Ptr0);
+    }
+
+    TEST(pool_allocator, invalid_requests) {
+        memory_resource _Res(1024);
+        pool_allocator _Al(16, _Res);
+        EXPECT_THROW(static_cast<void>(_Al.allocate(17)), allocation_limit_exceeded);
+        EXPECT_THROW(static_cast<void>(_Al.allocate(16, 64)), allocation_failure);
+    }
+
+    TEST(pool_allocator, allocation_limit) {
+        // a resource that holds at least four aligned blocks
+        memory_resource _Res(4 * 64 + 64);
+        pool_allocator _Al(64, _Res, 64);
+        for (size_t _Idx = 0; _Idx < 4; ++_Idx) {
+            EXPECT_NE(_Al.allocate(64, 64), nullptr);
+        }
+
+        size_t _Count = 0;
+        try {
+            for (;;) {
+                static_cast<void>(_Al.allocate(64, 64));
+                ++_Count;
+            }
+        } catch (const allocation_limit_exceeded&) {
+            EXPECT_LE(_Count, 1); // depends on the alignment of the resource
+        }
+    }
+
+    TEST(pool_allocator, release) {
+        memory_resource _Res(256);
+        pool_allocator _Al(32, _Res);
+        void* const _Ptr = _Al.allocate(32);
+        _Al.allocate(32);
+        _Al.release();
+        EXPECT_EQ(_Al.allocate(32), _Ptr);
+    }
+
+    TEST(pool_allocator, upstream_chunks) {
+        system_allocator _Upstream;
+        pool_allocator _Al(sizeof(_Pool_node), _Upstream, alignof(_Pool_node));
+        EXPECT_EQ(_Al.upstream(), &_Upstream);
+
+        // create more nodes than a single chunk can hold
+        ::std::vector<_Pool_node*> _Nodes;
+        for (int _Idx = 0; _Idx < static_cast<int>(4 * pool_allocator::blocks_per_chunk); ++_Idx) {
+            _Nodes.push_back(::mjx::create_object_using_allocator<_Pool_node>(_Al, _Idx));
+        }
+
+        for (int _Idx = 0; _Idx < static_cast<int>(_Nodes.size()); ++_Idx) {
+            EXPECT_EQ(_Nodes[_Idx]->_Value, _Idx);
+            ::mjx::delete_object_using_allocator(_Nodes[_Idx], _Al);
+        }
+    }
+
+    TEST(pool_allocator, resource_then_upstream) {
+        memory_resource _Res(64);
+        system_allocator _Upstream;
+        pool_allocator _Al(16, _Res, _Upstream);
+        EXPECT_TRUE(_Res.contains(_Al.allocate(16), 16));
+
+        // continue allocating until the blocks come from upstream chunks
+        bool _Used_upstream = false;
+        for (size_t _Idx = 0; _Idx < 8; ++_Idx) {
+            if (!_Res.contains(_Al.allocate(16), 16)) {
+                _Used_upstream = true;
+            }
+        }
+
+        EXPECT_TRUE(_Used_upstream);
+    }
+
+    TEST(pool_allocator, bulk_allocation) {
+        memory_resource _Res(1024);
+        pool_allocator _Al(32, _Res);
+        void* _Ptrs[8];
+        _Al.allocate_bulk(32, 0, 8, _Ptrs);
+        for (size_t _Idx = 0; _Idx < 8; ++_Idx) {
+            EXPECT_TRUE(_Res.contains(_Ptrs[_Idx], 32)); // block should come from the resource
+            for (size_t _Prev = 0; _Prev < _Idx; ++_Prev) {
+                EXPECT_NE(_Ptrs[_Idx], _Ptrs[_Prev]);
+            }
+        }
+
+        // the returned blocks are reused in the order of the batch
+        _Al.deallocate_bulk(_Ptrs, 8, 32);
+        for (size_t _Idx = 0; _Idx < 8; ++_Idx) {
+            EXPECT_EQ(_Al.allocate(32), _Ptrs[_Idx]);
+        }
+    }
+
+    TEST(pool_allocator, bulk_allocation_limit) {
+        // a failed batch must not leak the blocks allocated before the failure
+        memory_resource _Res(256);
+        pool_allocator _Al(64, _Res);
+        void* _Ptrs[8];
+        EXPECT_THROW(_Al.allocate_bulk(64, 0, 8, _Ptrs), allocation_limit_exceeded);
+        _Al.allocate_bulk(64, 0, 4, _Ptrs);
+        _Al.deallocate_bulk(_Ptrs, 4, 64);
+    }
+
+    TEST(pool_allocator, try_expand_in_place) {
+        memory_resource _Res(256);
+        pool_allocator _Al(48, _Res);
+        void* const _Ptr = _Al.allocate(16);
+        EXPECT_TRUE(_Al.try_expand_in_place(_Ptr, 16, 48)); // still fits in the block
+        EXPECT_FALSE(_Al.try_expand_in_place(_Ptr, 48, 49));
+        EXPECT_EQ(_Al.reallocate(_Ptr, 48, 24), _Ptr);
+    }
+
+    TEST(pool_allocator, allocate_at_least) {
+        memory_resource _Res(256);
+        pool_allocator _Al(48, _Res);
+        EXPECT_EQ(_Al.good_size(1), 48);
+        EXPECT_EQ(_Al.good_size(49), 49); // too large for a block, no rounding
+        EXPECT_EQ(_Al.allocate_at_least(20).count, 48);
+    }
+
+    TEST(pool_allocator, tag) {
+        memory_resource _Res(64);
+        pool_allocator _Al(16, _Res);
+        EXPECT_EQ(_Al.tag(), allocator_tag::pool);
+    }
+
+    TEST(pool_allocator, max_size) {
+        memory_resource _Res(64);
+        pool_allocator _Al(48, _Res);
+        EXPECT_EQ(_Al.max_size(), 48);
+    }
+
+    TEST(pool_allocator, is_equal) {
+        memory_resource _Res(64);
+        pool_allocator _Al0(16, _Res);
+        pool_allocator _Al1(16, _Res);
+        EXPECT_EQ(_Al0, _Al0);
+        EXPECT_FALSE(_Al0 == _Al1);
+    }
+} // namespace mjx
\ No newline at end of file
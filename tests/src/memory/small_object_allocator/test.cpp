@@ -0,0 +1,142 @@
+// test.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+#include <mjxsdk/memory/small_object_allocator.hpp>
+#include <mjxsdk/memory/smart_pointer.hpp>
+#include <mjxsdk/memory/system_allocator.hpp>
+#include <thread>
+#include <vector>
+
+namespace mjx {
+    struct _Small_block { // allocated block with its size
+        void* _Ptr;
+        size_t _Size;
+    };
+
+    TEST(small_object_allocator, mixed_sizes) {
+        // fill each block with a pattern to detect overlapping blocks
+        small_object_allocator _Al;
+        ::std::vector<_Small_block> _Blocks;
+        for (size_t _Size = 1; _Size <= 2 * small_object_allocator::max_small_size; _Size += 7) {
+            void* const _Ptr = _Al.allocate(_Size);
+            EXPECT_EQ(reinterpret_cast<uintptr_t>(_Ptr) % __STDCPP_DEFAULT_NEW_ALIGNMENT__, 0);
+            ::memset(_Ptr, static_cast<int>(_Size & 0xFF), _Size);
+            _Blocks.push_back({_Ptr, _Size});
+        }
+
+        for (const _Small_block& _Block : _Blocks) {
+            const unsigned char* const _Bytes = static_cast<const unsigned char*>(_Block._Ptr);
+            for (size_t _Idx = 0; _Idx < _Block._Size; ++_Idx) {
+                ASSERT_EQ(_Bytes[_Idx], _Block._Size & 0xFF);
+            }
+
+            _Al.deallocate(_Block._Ptr, _Block._Size);
+        }
+    }
+
+    TEST(small_object_allocator, reuse_freed_blocks) {
+        // blocks from the same size class are reused
+        small_object_allocator _Al;
+        void* const _Ptr = _Al.allocate(40);
+        _Al.deallocate(_Ptr, 40);
+        EXPECT_EQ(_Al.allocate(48), _Ptr);
+    }
+
+    TEST(small_object_allocator, aligned_allocation) {
+        small_object_allocator _Al;
+        for (size_t _Align = 1; _Align <= 4096; _Align <<= 1) {
+            void* const _Ptr = _Al.allocate(100, _Align);
+            EXPECT_EQ(reinterpret_cast<uintptr_t>(_Ptr) % _Align, 0); // address should be aligned
+            _Al.deallocate(_Ptr, 100, _Align);
+        }
+    }
+
+    TEST(small_object_allocator, global_allocator) {
+        small_object_allocator _Al;
+        ::mjx::set_global_allocator(_Al);
+        {
+            auto _Ptr   = ::mjx::make_shared<int>(42);
+            auto _Array = ::mjx::make_unique_array<double>(200, 1.5);
+            EXPECT_EQ(*_Ptr, 42);
+            EXPECT_EQ(_Array[199], 1.5);
+        }
+
+        ::mjx::reset_global_allocator();
+    }
+
+    TEST(small_object_allocator, concurrent_allocation) {
+        constexpr size_t _Thread_count = 8;
+        constexpr size_t _Iterations   = 10'000;
+        small_object_allocator _Al;
+        ::std::vector<::std::thread> _Threads;
+        for (size_t _Thread = 0; _Thread < _Thread_count; ++_Thread) {
+            _Threads.emplace_back([&_Al, _Thread] {
+                ::std::vector<_Small_block> _Blocks;
+                for (size_t _Idx = 0; _Idx < _Iterations; ++_Idx) {
+                    const size_t _Size = 1 + (_Idx * 37 + _Thread) % 1500;
+                    _Blocks.push_back({_Al.allocate(_Size), _Size});
+                    if (_Idx % 3 == 0) { // free some of the blocks on the way
+                        _Al.deallocate(_Blocks.back()._Ptr, _Blocks.back()._Size);
+                        _Blocks.pop_back();
+                    }
+                }
+
+                for (const _Small_block& _Block : _Blocks) {
+                    _Al.deallocate(_Block._Ptr, _Block._Size);
+                }
+            });
+        }
+
+        for (::std::thread& _Thread : _Threads) {
+            _Thread.join();
+        }
+    }
+
+    TEST(small_object_allocator, bulk_allocation) {
+        small_object_allocator _Al;
+        for (const size_t _Size : {size_t{24}, 2 * small_object_allocator::max_small_size}) { // small and large blocks
+            void* _Ptrs[100];
+            _Al.allocate_bulk(_Size, 0, 100, _Ptrs);
+            for (void* const _Ptr : _Ptrs) {
+                ::memset(_Ptr, 0xFF, _Size);
+            }
+
+            _Al.deallocate_bulk(_Ptrs, 100, _Size);
+        }
+    }
+
+    TEST(small_object_allocator, allocate_at_least) {
+        // requests are rounded up to the size of their size class
+        small_object_allocator _Al;
+        EXPECT_EQ(_Al.good_size(40), 48);
+        EXPECT_EQ(_Al.good_size(0), 0);
+        const allocation_result _Result = _Al.allocate_at_least(40);
+        EXPECT_EQ(_Result.count, 48);
+        _Al.deallocate(_Result.ptr, _Result.count);
+        EXPECT_EQ(_Al.allocate(48), _Result.ptr); // the block returned to the same size class
+
+        const allocation_result _Large = _Al.allocate_at_least(4 * small_object_allocator::max_small_size);
+        EXPECT_GE(_Large.count, 4 * small_object_allocator::max_small_size);
+        _Al.deallocate(_Large.ptr, _Large.count);
+    }
+
+    TEST(small_object_allocator, tag) {
+        small_object_allocator _Al;
+        EXPECT_EQ(_Al.tag(), allocator_tag::small_object);
+    }
+
+    TEST(small_object_allocator, max_size) {
+        small_object_allocator _Al;
+        EXPECT_EQ(_Al.max_size(), system_allocator{}.max_size());
+    }
+
+    TEST(small_object_allocator, is_equal) {
+        small_object_allocator _Al0;
+        small_object_allocator _Al1;
+        EXPECT_EQ(_Al0, _Al0);
+        EXPECT_FALSE(_Al0 == _Al1);
+    }
+} // namespace mjx
\ No newline at end of file
@@ -0,0 +1,144 @@
+// test.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+#include <mjxsdk/memory/exception.hpp>
+#include <mjxsdk/memory/object.hpp>
+#include <mjxsdk/memory/stack_allocator.hpp>
+
+namespace mjx {
+    size_t _Evaluate_recursively(stack_allocator& _Al, const size_t _Depth) {
+        // each level allocates scratch memory and throws it away when it unwinds
+        if (_Depth == 0) {
+            return 0;
+        }
+
+        const stack_allocator::marker _Marker = _Al.mark();
+        int* const _Scratch = ::mjx::allocate_object_array_using_allocator<int>(_Depth, _Al);
+        for (size_t _Idx = 0; _Idx < _Depth; ++_Idx) {
+            _Scratch[_Idx] = static_cast<int>(_Idx);
+        }
+
+        const size_t _Result = _Evaluate_recursively(_Al, _Depth - 1) + static_cast<size_t>(_Scratch[_Depth - 1]);
+        _Al.rewind(_Marker);
+        return _Result;
+    }
+
+    TEST(stack_allocator, mark_and_rewind) {
+        memory_resource _Res(1024);
+        stack_allocator _Al(_Res);
+        EXPECT_EQ(_Al.used(), 0);
+        EXPECT_TRUE(_Res.contains(_Al.allocate(100), 100));
+
+        // everything allocated after the marker is freed at once
+        const stack_allocator::marker _Marker = _Al.mark();
+        const size_t _Used                    = _Al.used();
+        static_cast<void>(_Al.allocate(200));
+        static_cast<void>(_Al.allocate(300, 64));
+        EXPECT_GT(_Al.used(), _Used);
+        _Al.rewind(_Marker);
+        EXPECT_EQ(_Al.used(), _Used);
+    }
+
+    TEST(stack_allocator, nested_scopes) {
+        memory_resource _Res(64 * 1024);
+        stack_allocator _Al(_Res);
+        EXPECT_EQ(_Evaluate_recursively(_Al, 50), 49 * 50 / 2);
+        EXPECT_EQ(_Al.used(), 0);
+    }
+
+    TEST(stack_allocator, lifo_deallocation) {
+        memory_resource _Res(1024);
+        stack_allocator _Al(_Res);
+        void* const _Ptr0 = _Al.allocate(20);
+        void* const _Ptr1 = _Al.allocate(40);
+        void* const _Ptr2 = _Al.allocate(60);
+
+        // deallocating in reverse order pops every block
+        _Al.deallocate(_Ptr2, 60);
+        _Al.deallocate(_Ptr1, 40);
+        _Al.deallocate(_Ptr0, 20);
+        EXPECT_EQ(_Al.used(), 0);
+        EXPECT_EQ(_Al.allocate(20), _Ptr0);
+    }
+
+    TEST(stack_allocator, aligned_allocation) {
+        memory_resource _Res(4096);
+        stack_allocator _Al(_Res);
+        for (size_t _Align = 1; _Align <= 256; _Align <<= 1) {
+            void* const _Ptr = _Al.allocate(24, _Align);
+            EXPECT_EQ(reinterpret_cast<uintptr_t>(_Ptr) % _Align, 0); // address should be aligned
+            EXPECT_TRUE(_Res.contains(_Ptr, 24)); // block should come from the resource
+        }
+    }
+
+    TEST(stack_allocator, allocation_limit) {
+        memory_resource _Res(256);
+        stack_allocator _Al(_Res);
+        const stack_allocator::marker _Marker = _Al.mark();
+        void* const _Ptr                      = _Al.allocate(128);
+        EXPECT_THROW(static_cast<void>(_Al.allocate(256)), allocation_limit_exceeded);
+
+        // rewinding makes the space available again
+        _Al.rewind(_Marker);
+        EXPECT_EQ(_Al.allocate(128), _Ptr);
+    }
+
+    TEST(stack_allocator, release) {
+        memory_resource _Res(512);
+        stack_allocator _Al(_Res);
+        void* const _Ptr = _Al.allocate(64);
+        static_cast<void>(_Al.allocate(64));
+        _Al.release();
+        EXPECT_EQ(_Al.used(), 0);
+        EXPECT_EQ(_Al.allocate(64), _Ptr);
+    }
+
+#ifdef _DEBUG
+    TEST(stack_allocator, out_of_order_deallocation) {
+        memory_resource _Res(512);
+        stack_allocator _Al(_Res);
+        void* const _Ptr = _Al.allocate(64);
+        static_cast<void>(_Al.allocate(64));
+        EXPECT_DEATH(_Al.deallocate(_Ptr, 64), "LIFO");
+    }
+#endif // _DEBUG
+
+    TEST(stack_allocator, try_expand_in_place) {
+        memory_resource _Res(1024);
+        stack_allocator _Al(_Res);
+        void* const _Ptr0 = _Al.allocate(100);
+        void* const _Ptr1 = _Al.allocate(100);
+        EXPECT_FALSE(_Al.try_expand_in_place(_Ptr0, 100, 200)); // only the top block can grow
+        EXPECT_TRUE(_Al.try_expand_in_place(_Ptr1, 100, 500));
+        EXPECT_FALSE(_Al.try_expand_in_place(_Ptr1, 500, 2000)); // exceeds the resource
+        EXPECT_EQ(_Al.reallocate(_Ptr1, 500, 50), _Ptr1);
+
+        // the next block follows the shrunk top block
+        const size_t _Used = _Al.used();
+        _Al.deallocate(_Al.allocate(16), 16);
+        EXPECT_EQ(_Al.used(), _Used);
+    }
+
+    TEST(stack_allocator, tag) {
+        memory_resource _Res(64);
+        stack_allocator _Al(_Res);
+        EXPECT_EQ(_Al.tag(), allocator_tag::stack);
+    }
+
+    TEST(stack_allocator, max_size) {
+        memory_resource _Res(64);
+        stack_allocator _Al(_Res);
+        EXPECT_EQ(_Al.max_size(), 64);
+    }
+
+    TEST(stack_allocator, is_equal) {
+        memory_resource _Res(64);
+        stack_allocator _Al0(_Res);
+        stack_allocator _Al1(_Res);
+        EXPECT_EQ(_Al0, _Al0);
+        EXPECT_FALSE(_Al0 == _Al1);
+    }
+} // namespace mjx
\ No newline at end of file
@@ -0,0 +1,138 @@
+// test.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+#include <mjxsdk/memory/pool_allocator.hpp>
+#include <mjxsdk/memory/stats_allocator.hpp>
+#include <mjxsdk/memory/system_allocator.hpp>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace mjx {
+    TEST(stats_allocator, counters) {
+        stats_allocator<system_allocator> _Al;
+        void* const _Ptr0 = _Al.allocate(16);
+        void* const _Ptr1 = _Al.allocate(100);
+        _Al.deallocate(_Ptr0, 16);
+
+        allocation_stats _Stats = _Al.snapshot();
+        EXPECT_EQ(_Stats.allocations, 2);
+        EXPECT_EQ(_Stats.deallocations, 1);
+        EXPECT_EQ(_Stats.allocated_bytes, 116);
+        EXPECT_EQ(_Stats.deallocated_bytes, 16);
+        EXPECT_EQ(_Stats.live_bytes, 100);
+        EXPECT_EQ(_Stats.peak_bytes, 100);
+        EXPECT_EQ(_Stats.histogram[0], 1); // 16 bytes
+        EXPECT_EQ(_Stats.histogram[3], 1); // 65 to 128 bytes
+
+        _Al.deallocate(_Ptr1, 100);
+        _Stats = _Al.snapshot();
+        EXPECT_EQ(_Stats.deallocations, 2);
+        EXPECT_EQ(_Stats.live_bytes, 0);
+    }
+
+    TEST(stats_allocator, peak_bytes) {
+        // large blocks are published immediately, so the peak is exact
+        stats_allocator<system_allocator> _Al;
+        void* const _Ptr0 = _Al.allocate(1024 * 1024);
+        void* const _Ptr1 = _Al.allocate(1024 * 1024);
+        _Al.deallocate(_Ptr0, 1024 * 1024);
+        _Al.deallocate(_Ptr1, 1024 * 1024);
+
+        const allocation_stats _Stats = _Al.snapshot();
+        EXPECT_EQ(_Stats.live_bytes, 0);
+        EXPECT_EQ(_Stats.peak_bytes, 2 * 1024 * 1024);
+        EXPECT_EQ(_Stats.histogram[16], 2); // 512 KiB to 1 MiB
+    }
+
+    TEST(stats_allocator, reallocation) {
+        stats_allocator<system_allocator> _Al;
+        void* _Ptr = _Al.reallocate(nullptr, 0, 64); // acts like allocate()
+        _Ptr       = _Al.reallocate(_Ptr, 64, 256);
+        allocation_stats _Stats = _Al.snapshot();
+        EXPECT_EQ(_Stats.allocations, 1);
+        EXPECT_EQ(_Stats.reallocations, 1);
+        EXPECT_EQ(_Stats.live_bytes, 256);
+
+        EXPECT_EQ(_Al.reallocate(_Ptr, 256, 0), nullptr); // acts like deallocate()
+        _Stats = _Al.snapshot();
+        EXPECT_EQ(_Stats.deallocations, 1);
+        EXPECT_EQ(_Stats.live_bytes, 0);
+    }
+
+    TEST(stats_allocator, bulk_allocation) {
+        memory_resource _Res(1024);
+        stats_allocator<pool_allocator> _Al(32, _Res);
+        void* _Ptrs[8];
+        _Al.allocate_bulk(32, 0, 8, _Ptrs);
+        EXPECT_EQ(_Al.snapshot().allocations, 8);
+        EXPECT_EQ(_Al.snapshot().live_bytes, 8 * 32);
+
+        _Al.deallocate_bulk(_Ptrs, 8, 32);
+        EXPECT_EQ(_Al.snapshot().deallocations, 8);
+        EXPECT_EQ(_Al.upstream().allocate(32), _Ptrs[0]); // the blocks returned to the pool
+    }
+
+    TEST(stats_allocator, allocate_at_least) {
+        // the usable size is recorded, not the requested one
+        memory_resource _Res(256);
+        stats_allocator<pool_allocator> _Al(48, _Res);
+        EXPECT_EQ(_Al.good_size(20), 48);
+        static_cast<void>(_Al.allocate_at_least(20));
+        EXPECT_EQ(_Al.snapshot().allocated_bytes, 48);
+    }
+
+    TEST(stats_allocator, concurrent_allocation) {
+        constexpr size_t _Thread_count = 8;
+        constexpr size_t _Iterations   = 10'000;
+        stats_allocator<system_allocator> _Al;
+        ::std::vector<::std::thread> _Threads;
+        for (size_t _Thread = 0; _Thread < _Thread_count; ++_Thread) {
+            _Threads.emplace_back([&_Al] {
+                for (size_t _Idx = 0; _Idx < _Iterations; ++_Idx) {
+                    _Al.deallocate(_Al.allocate(64), 64);
+                }
+            });
+        }
+
+        for (::std::thread& _Thread : _Threads) {
+            _Thread.join();
+        }
+
+        const allocation_stats _Stats = _Al.snapshot();
+        EXPECT_EQ(_Stats.allocations, _Thread_count * _Iterations);
+        EXPECT_EQ(_Stats.deallocations, _Thread_count * _Iterations);
+        EXPECT_EQ(_Stats.live_bytes, 0);
+        EXPECT_EQ(_Stats.histogram[2], _Thread_count * _Iterations); // 33 to 64 bytes
+    }
+
+    TEST(stats_allocator, non_copyable) {
+        // the forwarding constructor must not take over copying, not even from a non-const lvalue
+        using _Stats_al = stats_allocator<system_allocator>;
+        static_assert(!::std::is_copy_constructible_v<_Stats_al>);
+        static_assert(!::std::is_constructible_v<_Stats_al, _Stats_al&>);
+        static_assert(!::std::is_constructible_v<_Stats_al, _Stats_al&&>);
+        stats_allocator<pool_allocator> _Al(64, get_global_allocator()); // arguments still reach the upstream
+        EXPECT_EQ(_Al.upstream().block_size(), 64);
+    }
+
+    TEST(stats_allocator, tag) {
+        stats_allocator<system_allocator> _Al;
+        EXPECT_EQ(_Al.tag(), allocator_tag::stats);
+    }
+
+    TEST(stats_allocator, max_size) {
+        stats_allocator<system_allocator> _Al;
+        EXPECT_EQ(_Al.max_size(), system_allocator{}.max_size());
+    }
+
+    TEST(stats_allocator, is_equal) {
+        stats_allocator<system_allocator> _Al0;
+        stats_allocator<system_allocator> _Al1;
+        EXPECT_EQ(_Al0, _Al0);
+        EXPECT_FALSE(_Al0 == _Al1);
+    }
+} // namespace mjx
\ No newline at end of file
@@ -17,6 +17,51 @@ namespace mjx {
         _Al.deallocate(_Ptr, _Count, _Align);
     }
 
+    TEST(system_allocator, reallocate) {
+        // the contents must survive each resize, whether the block is moved, copied or remapped
+        system_allocator _Al;
+        size_t _Size        = 64;
+        unsigned char* _Ptr = static_cast<unsigned char*>(_Al.allocate(_Size));
+        for (size_t _Idx = 0; _Idx < _Size; ++_Idx) {
+            _Ptr[_Idx] = static_cast<unsigned char>(_Idx);
+        }
+
+        for (const size_t _New_size : {size_t{4096}, size_t{1024 * 1024}, 2 * system_allocator::mapping_threshold,
+            system_allocator::mapping_threshold, size_t{1024 * 1024}, size_t{100}}) {
+            _Ptr = static_cast<unsigned char*>(_Al.reallocate(_Ptr, _Size, _New_size));
+            for (size_t _Idx = 0; _Idx < 64; ++_Idx) {
+                ASSERT_EQ(_Ptr[_Idx], static_cast<unsigned char>(_Idx));
+            }
+
+            ::memset(_Ptr + 64, 0xFF, _New_size - 64); // the whole block must be writable
+            _Size = _New_size;
+        }
+
+        EXPECT_EQ(_Al.reallocate(_Ptr, _Size, 0), nullptr);
+    }
+
+    TEST(system_allocator, try_expand_in_place) {
+        system_allocator _Al;
+        void* const _Ptr = _Al.allocate(100);
+        EXPECT_TRUE(_Al.try_expand_in_place(_Ptr, 100, 100));
+        _Al.deallocate(_Ptr, 100);
+        EXPECT_FALSE(_Al.try_expand_in_place(nullptr, 0, 100));
+    }
+
+    TEST(system_allocator, allocate_at_least) {
+        // the whole usable size must be writable and accepted on deallocation
+        system_allocator _Al;
+        for (const size_t _Size : {size_t{40}, size_t{1000}, system_allocator::mapping_threshold + 1}) {
+            const allocation_result _Result = _Al.allocate_at_least(_Size);
+            EXPECT_GE(_Result.count, _Size);
+            EXPECT_GE(_Result.count, _Al.good_size(_Size));
+            ::memset(_Result.ptr, 0xFF, _Result.count);
+            _Al.deallocate(_Result.ptr, _Result.count);
+        }
+
+        EXPECT_EQ(_Al.allocate_at_least(0).ptr, nullptr);
+    }
+
     TEST(system_allocator, tag) {
         system_allocator _Al;
         EXPECT_EQ(_Al.tag(), allocator_tag::system);
@@ -0,0 +1,183 @@
+// test.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <condition_variable>
+#include <gtest/gtest.h>
+#include <memory>
+#include <mjxsdk/memory/system_allocator.hpp>
+#include <mjxsdk/memory/thread_cache_allocator.hpp>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mjx {
+    struct _Cached_block { // allocated block with its size
+        void* _Ptr;
+        size_t _Size;
+    };
+
+    TEST(thread_cache_allocator, mixed_sizes) {
+        // fill each block with a pattern to detect overlapping blocks
+        thread_cache_allocator _Al;
+        ::std::vector<_Cached_block> _Blocks;
+        for (size_t _Size = 1; _Size <= 2 * thread_cache_allocator::max_small_size; _Size += 5) {
+            void* const _Ptr = _Al.allocate(_Size);
+            EXPECT_EQ(reinterpret_cast<uintptr_t>(_Ptr) % __STDCPP_DEFAULT_NEW_ALIGNMENT__, 0);
+            ::memset(_Ptr, static_cast<int>(_Size & 0xFF), _Size);
+            _Blocks.push_back({_Ptr, _Size});
+        }
+
+        for (const _Cached_block& _Block : _Blocks) {
+            const unsigned char* const _Bytes = static_cast<const unsigned char*>(_Block._Ptr);
+            for (size_t _Idx = 0; _Idx < _Block._Size; ++_Idx) {
+                ASSERT_EQ(_Bytes[_Idx], _Block._Size & 0xFF);
+            }
+
+            _Al.deallocate(_Block._Ptr, _Block._Size);
+        }
+    }
+
+    TEST(thread_cache_allocator, reuse_cached_blocks) {
+        // the most recently freed block is served first from the thread's cache
+        thread_cache_allocator _Al;
+        void* const _Ptr = _Al.allocate(64);
+        _Al.deallocate(_Ptr, 64);
+        EXPECT_EQ(_Al.allocate(64), _Ptr);
+        _Al.deallocate(_Ptr, 64);
+        _Al.flush_thread_cache();
+    }
+
+    TEST(thread_cache_allocator, cross_thread_deallocation) {
+        // blocks allocated by one thread are freed by another one
+        constexpr size_t _Count = 10'000;
+        thread_cache_allocator _Al;
+        ::std::vector<void*> _Blocks(_Count);
+        ::std::thread _Producer([&] {
+            for (void*& _Block : _Blocks) {
+                _Block = _Al.allocate(96);
+            }
+        });
+        _Producer.join();
+
+        ::std::thread _Consumer([&] {
+            for (void* const _Block : _Blocks) {
+                _Al.deallocate(_Block, 96);
+            }
+        });
+        _Consumer.join();
+    }
+
+    TEST(thread_cache_allocator, concurrent_allocation) {
+        constexpr size_t _Thread_count = 8;
+        constexpr size_t _Iterations   = 20'000;
+        thread_cache_allocator _Al;
+        ::std::vector<::std::thread> _Threads;
+        for (size_t _Thread = 0; _Thread < _Thread_count; ++_Thread) {
+            _Threads.emplace_back([&_Al, _Thread] {
+                ::std::vector<_Cached_block> _Blocks;
+                for (size_t _Idx = 0; _Idx < _Iterations; ++_Idx) {
+                    const size_t _Size = 1 + (_Idx * 31 + _Thread) % 1200;
+                    _Blocks.push_back({_Al.allocate(_Size), _Size});
+                    if (_Idx % 2 == 0) { // free some of the blocks on the way
+                        _Al.deallocate(_Blocks.back()._Ptr, _Blocks.back()._Size);
+                        _Blocks.pop_back();
+                    }
+                }
+
+                for (const _Cached_block& _Block : _Blocks) {
+                    _Al.deallocate(_Block._Ptr, _Block._Size);
+                }
+            });
+        }
+
+        for (::std::thread& _Thread : _Threads) {
+            _Thread.join();
+        }
+    }
+
+    TEST(thread_cache_allocator, thread_outlives_allocator) {
+        // the caches of other threads keep the shared state alive until they exit
+        bool _Ready    = false;
+        bool _Finished = false;
+        ::std::mutex _Mtx;
+        ::std::condition_variable _Cond;
+        auto _Al = ::std::make_unique<thread_cache_allocator>();
+        ::std::thread _Worker([&] {
+            _Al->deallocate(_Al->allocate(32), 32);
+            {
+                ::std::unique_lock<::std::mutex> _Lock(_Mtx);
+                _Ready = true;
+                _Cond.notify_one();
+                _Cond.wait(_Lock, [&] { return _Finished; });
+            }
+        });
+
+        {
+            ::std::unique_lock<::std::mutex> _Lock(_Mtx);
+            _Cond.wait(_Lock, [&] { return _Ready; });
+            _Al.reset(); // destroy the allocator while the worker still holds its cache
+            _Finished = true;
+            _Cond.notify_one();
+        }
+
+        _Worker.join();
+    }
+
+    TEST(thread_cache_allocator, many_allocators) {
+        // more allocators than a thread can cache at once
+        ::std::vector<::std::unique_ptr<thread_cache_allocator>> _Allocators;
+        for (size_t _Idx = 0; _Idx < 20; ++_Idx) {
+            _Allocators.push_back(::std::make_unique<thread_cache_allocator>());
+        }
+
+        for (size_t _Round = 0; _Round < 3; ++_Round) {
+            for (auto& _Al : _Allocators) {
+                _Al->deallocate(_Al->allocate(128), 128);
+            }
+        }
+    }
+
+    TEST(thread_cache_allocator, aligned_allocation) {
+        thread_cache_allocator _Al;
+        for (size_t _Align = 1; _Align <= 4096; _Align <<= 1) {
+            void* const _Ptr = _Al.allocate(100, _Align);
+            EXPECT_EQ(reinterpret_cast<uintptr_t>(_Ptr) % _Align, 0); // address should be aligned
+            _Al.deallocate(_Ptr, 100, _Align);
+        }
+    }
+
+    TEST(thread_cache_allocator, bulk_allocation) {
+        // batches larger than a magazine are split between the cache and the backend
+        thread_cache_allocator _Al;
+        ::std::vector<void*> _Ptrs(1000);
+        for (size_t _Round = 0; _Round < 3; ++_Round) {
+            _Al.allocate_bulk(48, 0, _Ptrs.size(), _Ptrs.data());
+            for (void* const _Ptr : _Ptrs) {
+                ::memset(_Ptr, static_cast<int>(_Round), 48);
+            }
+
+            _Al.deallocate_bulk(_Ptrs.data(), _Ptrs.size(), 48);
+        }
+
+        _Al.flush_thread_cache();
+    }
+
+    TEST(thread_cache_allocator, tag) {
+        thread_cache_allocator _Al;
+        EXPECT_EQ(_Al.tag(), allocator_tag::thread_cache);
+    }
+
+    TEST(thread_cache_allocator, max_size) {
+        thread_cache_allocator _Al;
+        EXPECT_EQ(_Al.max_size(), system_allocator{}.max_size());
+    }
+
+    TEST(thread_cache_allocator, is_equal) {
+        thread_cache_allocator _Al0;
+        thread_cache_allocator _Al1;
+        EXPECT_EQ(_Al0, _Al0);
+        EXPECT_FALSE(_Al0 == _Al1);
+    }
+} // namespace mjx
\ No newline at end of file
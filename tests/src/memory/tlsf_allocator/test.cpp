@@ -0,0 +1,187 @@
+// test.cpp
+
+// Copyright (c) Mateusz Jandura. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <mjxsdk/memory/exception.hpp>
+#include <mjxsdk/memory/smart_pointer.hpp>
+#include <mjxsdk/memory/tlsf_allocator.hpp>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace mjx {
+    struct _Tlsf_block { // allocated block with its size and fill pattern
+        unsigned char* _Ptr;
+        size_t _Size;
+        unsigned char _Pattern;
+    };
+
+    TEST(tlsf_allocator, mixed_sizes) {
+        // fill each block with a pattern to detect overlapping blocks
+        memory_resource _Res(1024 * 1024);
+        tlsf_allocator _Al(_Res);
+        ::std::vector<_Tlsf_block> _Blocks;
+        for (size_t _Size = 1; _Size <= 64 * 1024; _Size = _Size * 2 + 3) {
+            unsigned char* const _Ptr = static_cast<unsigned char*>(_Al.allocate(_Size));
+            EXPECT_EQ(reinterpret_cast<uintptr_t>(_Ptr) % __STDCPP_DEFAULT_NEW_ALIGNMENT__, 0);
+            EXPECT_TRUE(_Res.contains(_Ptr, _Size)); // block should come from the resource
+            ::memset(_Ptr, static_cast<int>(_Blocks.size()), _Size);
+            _Blocks.push_back({_Ptr, _Size, static_cast<unsigned char>(_Blocks.size())});
+        }
+
+        for (const _Tlsf_block& _Block : _Blocks) {
+            for (size_t _Idx = 0; _Idx < _Block._Size; ++_Idx) {
+                ASSERT_EQ(_Block._Ptr[_Idx], _Block._Pattern);
+            }
+
+            _Al.deallocate(_Block._Ptr, _Block._Size);
+        }
+    }
+
+    TEST(tlsf_allocator, merge_free_blocks) {
+        // after freeing everything in a random order, the largest block must be available again
+        memory_resource _Res(256 * 1024);
+        tlsf_allocator _Al(_Res);
+        const size_t _Max_size = _Al.max_size();
+        ::std::mt19937 _Gen(42);
+        ::std::uniform_int_distribution<size_t> _Dist(1, 2048);
+        ::std::vector<_Tlsf_block> _Blocks;
+        for (size_t _Round = 0; _Round < 10; ++_Round) {
+            try {
+                for (;;) {
+                    const size_t _Size = _Dist(_Gen);
+                    _Blocks.push_back({static_cast<unsigned char*>(_Al.allocate(_Size)), _Size, 0});
+                }
+            } catch (const allocation_limit_exceeded&) {
+            }
+
+            // free a random half of the blocks
+            ::std::shuffle(_Blocks.begin(), _Blocks.end(), _Gen);
+            for (size_t _Idx = _Blocks.size() / 2; _Idx < _Blocks.size(); ++_Idx) {
+                _Al.deallocate(_Blocks[_Idx]._Ptr, _Blocks[_Idx]._Size);
+            }
+
+            _Blocks.resize(_Blocks.size() / 2);
+        }
+
+        for (const _Tlsf_block& _Block : _Blocks) {
+            _Al.deallocate(_Block._Ptr, _Block._Size);
+        }
+
+        void* const _Ptr = _Al.allocate(_Max_size);
+        EXPECT_NE(_Ptr, nullptr);
+        _Al.deallocate(_Ptr, _Max_size);
+    }
+
+    TEST(tlsf_allocator, aligned_allocation) {
+        memory_resource _Res(64 * 1024);
+        tlsf_allocator _Al(_Res);
+        ::std::vector<_Tlsf_block> _Blocks;
+        for (size_t _Align = 1; _Align <= 4096; _Align <<= 1) {
+            unsigned char* const _Ptr = static_cast<unsigned char*>(_Al.allocate(100, _Align));
+            EXPECT_EQ(reinterpret_cast<uintptr_t>(_Ptr) % _Align, 0); // address should be aligned
+            ::memset(_Ptr, 0xFF, 100);
+            _Blocks.push_back({_Ptr, 100, 0xFF});
+        }
+
+        for (const _Tlsf_block& _Block : _Blocks) {
+            _Al.deallocate(_Block._Ptr, _Block._Size);
+        }
+
+        // the gaps in front of the aligned blocks must have been merged back as well
+        EXPECT_NE(_Al.allocate(_Al.max_size()), nullptr);
+    }
+
+    TEST(tlsf_allocator, allocation_limit) {
+        memory_resource _Res(16 * 1024);
+        tlsf_allocator _Al(_Res);
+        EXPECT_LT(_Al.max_size(), _Res.size());
+        EXPECT_THROW(static_cast<void>(_Al.allocate(_Res.size())), allocation_limit_exceeded);
+        void* const _Ptr = _Al.allocate(_Al.max_size());
+        EXPECT_THROW(static_cast<void>(_Al.allocate(1)), allocation_limit_exceeded);
+        _Al.deallocate(_Ptr, _Al.max_size());
+    }
+
+    TEST(tlsf_allocator, small_resource) {
+        // a resource that cannot hold the control structure cannot serve any request
+        memory_resource _Res(64);
+        tlsf_allocator _Al(_Res);
+        EXPECT_EQ(_Al.max_size(), 0);
+        EXPECT_THROW(static_cast<void>(_Al.allocate(1)), allocation_limit_exceeded);
+    }
+
+    TEST(tlsf_allocator, release) {
+        memory_resource _Res(16 * 1024);
+        tlsf_allocator _Al(_Res);
+        void* const _Ptr = _Al.allocate(128);
+        static_cast<void>(_Al.allocate(256));
+        _Al.release();
+        EXPECT_EQ(_Al.allocate(128), _Ptr);
+    }
+
+    TEST(tlsf_allocator, global_allocator) {
+        memory_resource _Res(1024 * 1024);
+        tlsf_allocator _Al(_Res);
+        ::mjx::set_global_allocator(_Al);
+        {
+            auto _Ptr   = ::mjx::make_shared<int>(42);
+            auto _Array = ::mjx::make_unique_array<double>(200, 1.5);
+            EXPECT_EQ(*_Ptr, 42);
+            EXPECT_EQ(_Array[199], 1.5);
+            EXPECT_TRUE(_Res.contains(_Array.get(), 200 * sizeof(double)));
+        }
+
+        ::mjx::reset_global_allocator();
+    }
+
+    TEST(tlsf_allocator, concurrent_allocation) {
+        constexpr size_t _Thread_count = 8;
+        constexpr size_t _Iterations   = 10'000;
+        memory_resource _Res(16 * 1024 * 1024);
+        tlsf_allocator _Al(_Res);
+        ::std::vector<::std::thread> _Threads;
+        for (size_t _Thread = 0; _Thread < _Thread_count; ++_Thread) {
+            _Threads.emplace_back([&_Al, _Thread] {
+                ::std::vector<_Tlsf_block> _Blocks;
+                for (size_t _Idx = 0; _Idx < _Iterations; ++_Idx) {
+                    const size_t _Size        = 1 + (_Idx * 37 + _Thread) % 500;
+                    unsigned char* const _Ptr = static_cast<unsigned char*>(_Al.allocate(_Size));
+                    ::memset(_Ptr, static_cast<int>(_Thread), _Size);
+                    _Blocks.push_back({_Ptr, _Size, static_cast<unsigned char>(_Thread)});
+                    if (_Idx % 3 != 0) { // free most of the blocks on the way
+                        _Al.deallocate(_Blocks.back()._Ptr, _Blocks.back()._Size);
+                        _Blocks.pop_back();
+                    }
+                }
+
+                for (const _Tlsf_block& _Block : _Blocks) {
+                    EXPECT_EQ(_Block._Ptr[_Block._Size - 1], _Block._Pattern);
+                    _Al.deallocate(_Block._Ptr, _Block._Size);
+                }
+            });
+        }
+
+        for (::std::thread& _Thread : _Threads) {
+            _Thread.join();
+        }
+    }
+
+    TEST(tlsf_allocator, tag) {
+        memory_resource _Res(4096);
+        tlsf_allocator _Al(_Res);
+        EXPECT_EQ(_Al.tag(), allocator_tag::tlsf);
+    }
+
+    TEST(tlsf_allocator, is_equal) {
+        // each allocator places its control structure in its own resource
+        memory_resource _Res0(4096);
+        memory_resource _Res1(4096);
+        tlsf_allocator _Al0(_Res0);
+        tlsf_allocator _Al1(_Res1);
+        EXPECT_EQ(_Al0, _Al0);
+        EXPECT_FALSE(_Al0 == _Al1);
+    }
+} // namespace mjx
\ No newline at end of file